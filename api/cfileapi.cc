@@ -278,12 +278,12 @@ void readFullTrace(ExSeisRead f, size_t offset, size_t sz, trace_t * trace, CPar
     f->file->readTrace(offset, sz, trace, prm->param);
 }
 
-void writeTrace(ExSeisWrite f, size_t offset, size_t sz, trace_t * trace)
+void writeTrace(ExSeisWrite f, size_t offset, size_t sz, const trace_t * trace)
 {
     f->file->writeTrace(offset, sz, trace);
 }
 
-void writeFullTrace(ExSeisWrite f, size_t offset, size_t sz, trace_t * trace, const CParam prm)
+void writeFullTrace(ExSeisWrite f, size_t offset, size_t sz, const trace_t * trace, const CParam prm)
 {
     f->file->writeTrace(offset, sz, trace, static_cast<const File::Param *>(prm->param));
 }
@@ -304,7 +304,7 @@ void readListTrace(ExSeisRead f, size_t sz, size_t * offset, trace_t * trace)
     f->file->readTrace(sz, offset, trace);
 }
 
-void writeListTrace(ExSeisWrite f, size_t sz, size_t * offset, trace_t * trace)
+void writeListTrace(ExSeisWrite f, size_t sz, size_t * offset, const trace_t * trace)
 {
     f->file->writeTrace(sz, offset, trace);
 }
@@ -314,7 +314,7 @@ void readFullListTrace(ExSeisRead f, size_t sz, size_t * offset, trace_t * trace
     f->file->readTrace(sz, offset, trace, prm->param);
 }
 
-void writeFullListTrace(ExSeisWrite f, size_t sz, size_t * offset, trace_t * trace, const CParam prm)
+void writeFullListTrace(ExSeisWrite f, size_t sz, size_t * offset, const trace_t * trace, const CParam prm)
 {
     f->file->writeTrace(sz, offset, trace, static_cast<const File::Param *>(prm->param));
 }
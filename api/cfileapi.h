@@ -345,7 +345,7 @@ extern void readFullTrace(ExSeisRead f, size_t offset, size_t sz, float * trace,
  *  \param[out] trace A contiguous array of each trace (size sz*ns*sizeof(float))
  *  \warning This function is not thread safe.
  */
-extern void writeTrace(ExSeisWrite f, size_t offset, size_t sz, float * trace);
+extern void writeTrace(ExSeisWrite f, size_t offset, size_t sz, const float * trace);
 
 /*! \brief Read the traces and trace parameters from offset to offset+sz.
  *  \param[in] f A handle for the file.
@@ -355,7 +355,7 @@ extern void writeTrace(ExSeisWrite f, size_t offset, size_t sz, float * trace);
  *  \param[in] prm An array of the parameter structures (size sizeof(CParam)*sz)
  *  \warning This function is not thread safe.
  */
-extern void writeFullTrace(ExSeisWrite f, size_t offset, size_t sz, float * trace, const CParam prm);
+extern void writeFullTrace(ExSeisWrite f, size_t offset, size_t sz, const float * trace, const CParam prm);
 
 //Lists
 
@@ -374,7 +374,7 @@ extern void readListTrace(ExSeisRead f, size_t sz, size_t * offset, float * trac
  *  \param[in] trace A contiguous array of each trace (size sz*ns*sizeof(float))
  *  \warning This function is not thread safe.
  */
-extern void writeListTrace(ExSeisWrite f, size_t sz, size_t * offset, float * trace);
+extern void writeListTrace(ExSeisWrite f, size_t sz, size_t * offset, const float * trace);
 
 /*! \brief Read the traces and trace parameters corresponding to the list of trace numbers.
  *  \param[in] f A handle for the file.
@@ -392,7 +392,7 @@ extern void readFullListTrace(ExSeisRead f, size_t sz, size_t * offset, float *
  *  \param[in] trace A contiguous array of each trace (size sz*ns*sizeof(float))
  *  \param[in] prm An array of the parameter structures (size sizeof(CParam)*sz)
  */
-extern void writeFullListTrace(ExSeisWrite f, size_t sz, size_t * offset, float * trace, const CParam prm);
+extern void writeFullListTrace(ExSeisWrite f, size_t sz, size_t * offset, const float * trace, const CParam prm);
 
 /*! \brief Write the trace parameters corresponding to the list of trace numbers.
  *  \param[in] f A handle for the file.
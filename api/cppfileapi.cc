@@ -11,6 +11,9 @@
 #include "file/filesegy.hh"
 #include "object/objsegy.hh"
 #include "data/datampiio.hh"
+#include "data/datamemory.hh"
+#include "data/datastripe.hh"
+#include "data/datacompress.hh"
 namespace PIOL {
 ExSeis::ExSeis(const Log::Verb maxLevel)
 {
@@ -40,8 +43,20 @@ ReadDirect::ReadDirect(const Piol piol, const std::string name)
 {
     const File::ReadSEGY::Opt f;
     const Obj::SEGY::Opt o;
-    const Data::MPIIO::Opt d;
-    auto data = std::make_shared<Data::MPIIO>(piol, name, d, FileMode::Read);
+    //Names starting with "mem:" are held in memory instead of on storage. Striped files are found by their manifest
+    //and compressed containers by their header.
+    std::shared_ptr<Data::Interface> data;
+    if (Data::Memory::isMemory(name))
+        data = std::make_shared<Data::Memory>(piol, name, FileMode::Read);
+    else if (Data::Stripe::isStriped(piol, name))
+        data = std::make_shared<Data::Stripe>(piol, name, FileMode::Read);
+    else if (Data::Compress::isCompressed(piol, name))
+        data = std::make_shared<Data::Compress>(piol, name, FileMode::Read);
+    else
+    {
+        const Data::MPIIO::Opt d;
+        data = std::make_shared<Data::MPIIO>(piol, name, d, FileMode::Read);
+    }
     auto obj = std::make_shared<Obj::SEGY>(piol, name, o, data, FileMode::Read);
     file = std::make_shared<File::ReadSEGY>(piol, name, f, obj);
 }
@@ -50,8 +65,15 @@ WriteDirect::WriteDirect(const Piol piol, const std::string name)
 {
     const File::WriteSEGY::Opt f;
     const Obj::SEGY::Opt o;
-    const Data::MPIIO::Opt d;
-    auto data = std::make_shared<Data::MPIIO>(piol, name, d, FileMode::Write);
+    //Names starting with "mem:" are held in memory instead of on storage.
+    std::shared_ptr<Data::Interface> data;
+    if (Data::Memory::isMemory(name))
+        data = std::make_shared<Data::Memory>(piol, name, FileMode::Write);
+    else
+    {
+        const Data::MPIIO::Opt d;
+        data = std::make_shared<Data::MPIIO>(piol, name, d, FileMode::Write);
+    }
     auto obj = std::make_shared<Obj::SEGY>(piol, name, o, data, FileMode::Write);
     file = std::make_shared<File::WriteSEGY>(piol, name, f, obj);
 }
@@ -91,7 +113,7 @@ void ReadDirect::readTrace(csize_t offset, csize_t sz, trace_t * trace, Param *
     file->readTrace(offset, sz, trace, prm);
 }
 
-void WriteDirect::writeTrace(csize_t offset, csize_t sz, trace_t * trace, const Param * prm)
+void WriteDirect::writeTrace(csize_t offset, csize_t sz, const trace_t * trace, const Param * prm)
 {
     file->writeTrace(offset, sz, trace, prm);
 }
@@ -106,7 +128,7 @@ void ReadDirect::readTraceNonMono(csize_t sz, csize_t * offset, trace_t * trace,
     file->readTraceNonMono(sz, offset, trace, prm);
 }
 
-void WriteDirect::writeTrace(csize_t sz, csize_t * offset, trace_t * trace, const Param * prm)
+void WriteDirect::writeTrace(csize_t sz, csize_t * offset, const trace_t * trace, const Param * prm)
 {
     file->writeTrace(sz, offset, trace, prm);
 }
@@ -140,4 +162,9 @@ void WriteDirect::writeInc(const geom_t inc_)
 {
     file->writeInc(inc_);
 }
+
+void WriteDirect::flush(void)
+{
+    file->flush();
+}
 }}
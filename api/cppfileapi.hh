@@ -11,6 +11,7 @@
 #include "global.hh"
 #include "file/file.hh"
 #include "file/dynsegymd.hh"
+#include "file/staticrule.hh"
 namespace PIOL {
 /*! This class provides access to the ExSeisPIOL class but with a simpler API
  */
@@ -122,7 +123,8 @@ class ReadDirect
 
     /*! Constructor without options.
      *  \param[in] piol This PIOL ptr is not modified but is used to instantiate another shared_ptr.
-     *  \param[in] name The name of the file associated with the instantiation.
+     *  \param[in] name The name of the file associated with the instantiation. Names starting with "mem:" are Data::Memory files,
+     *                  names with a stripe manifest are Data::Stripe files and compressed containers are Data::Compress files.
      */
     ReadDirect(const Piol piol, const std::string name);
 
@@ -204,6 +206,31 @@ class ReadDirect
      *  \param[out] prm The parameter structure
      */
     void readParam(csize_t sz, csize_t * offset, Param * prm) const;
+
+    /*! \brief Read the trace parameters of a compile-time rule set from offset to offset+sz.
+     *  \tparam R The StaticRule.
+     *  \param[in] offset The starting trace number.
+     *  \param[in] sz The number of traces to process.
+     *  \param[out] prm The parameter structure
+     */
+    template <class R>
+    void readParam(csize_t offset, csize_t sz, StaticParam<R> * prm) const
+    {
+        file->readParam(offset, sz, prm);
+    }
+
+    /*! \brief Read the trace parameters of a compile-time rule set for the traces specified
+     *  by the offsets in the passed offset array.
+     *  \tparam R The StaticRule.
+     *  \param[in] sz The number of traces to process
+     *  \param[in] offset An array of trace numbers to read.
+     *  \param[out] prm The parameter structure
+     */
+    template <class R>
+    void readParam(csize_t sz, csize_t * offset, StaticParam<R> * prm) const
+    {
+        file->readParam(sz, offset, prm);
+    }
 };
 
 /*! This class implements the C++14 File Layer API for the PIOL. It constructs the Data, Object and File layers.
@@ -237,7 +264,7 @@ class WriteDirect
 
     /*! Constructor without options.
      *  \param[in] piol This PIOL ptr is not modified but is used to instantiate another shared_ptr.
-     *  \param[in] name The name of the file associated with the instantiation.
+     *  \param[in] name The name of the file associated with the instantiation. Names starting with "mem:" are Data::Memory files.
      */
     WriteDirect(const Piol piol, const std::string name);
 
@@ -292,7 +319,7 @@ class WriteDirect
      *
      *  \details When prm==PRM_NULL only the trace DF is written.
      */
-    void writeTrace(csize_t offset, csize_t sz, trace_t * trace, const Param * prm = PARAM_NULL);
+    void writeTrace(csize_t offset, csize_t sz, const trace_t * trace, const Param * prm = PARAM_NULL);
 
     /*! \brief Write the trace parameters from offset to offset+sz to the respective
      *  trace headers.
@@ -315,7 +342,7 @@ class WriteDirect
      *  It is assumed that the parameter writing operation is not an update. Any previous
      *  contents of the trace header will be overwritten.
      */
-    void writeTrace(csize_t sz, csize_t * offset, trace_t * trace, const Param * prm = PARAM_NULL);
+    void writeTrace(csize_t sz, csize_t * offset, const trace_t * trace, const Param * prm = PARAM_NULL);
 
     /*! \brief write the traces specified by the offsets in the passed offset array.
      *  \param[in] sz The number of traces to process
@@ -326,6 +353,10 @@ class WriteDirect
      *  contents of the trace header will be overwritten.
      */
     void writeParam(csize_t sz, csize_t * offset, const Param * prm);
+
+    /*! \brief Write any writes the file has held back. This is collective.
+     */
+    void flush(void);
 };
 }}
 #endif
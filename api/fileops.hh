@@ -38,14 +38,16 @@ extern std::function<trace_t(trace_t, trace_t)> getTap(TaperType type);
 //extern void getMinMax(ExSeisPIOL * piol, size_t offset, size_t lnt, Meta m, const Param * prm, CoordElem * minmax);
 extern void getMinMax(ExSeisPIOL * piol, size_t offset, size_t sz, Meta m1, Meta m2, const Param * prm, CoordElem * minmax);
 
-/*! Perform a sort on the given parameter structure.
+/*! Perform a sort on the given parameter structure. The parameters of each trace are encoded
+ *  once into a fixed-width key which is radix sorted.
  *  \param[in] piol The PIOL object
  *  \param[in] type The sort type
  *  \param[in,out] prm The trace parameter structure.
+ *  \param[in] FileOrder Do we wish to have the sort in the sorted input order (true) or sorted order (false)
  *  \return Return a vector which is a list of the ordered trace numbers. i.e the 0th member
  *          is the position of the 0th trace post-sort.
  */
-extern std::vector<size_t> sort(ExSeisPIOL * piol, SortType type, Param * prm);
+extern std::vector<size_t> sort(ExSeisPIOL * piol, SortType type, Param * prm, bool FileOrder = true);
 
 /*! Check that the file obeys the expected ordering.
  *  \param[in] src The input file.
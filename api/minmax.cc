@@ -3,12 +3,9 @@
  *   \author Cathal O Broin - cathal@ichec.ie - first commit
  *   \copyright TBD. Do not distribute
  *   \date November 2016
- *   \brief The Sort Operation
- *   \details The algorithm used is a nearest neighbour approach where at each iteration
- *   the lowest valued metadata entries are moved to adjacent processes with a lower rank and a
- *   sort is performed. After the sort the highest entries are moved again to the process with a
- *   higher rank. If each process has the same traces it started off with, the sort
- *   is complete.
+ *   \brief The Min/Max Operation
+ *   \details The two parameters of interest are copied into flat records with column views
+ *   of the parameter structure.
 *//*******************************************************************************************/
 #include <algorithm>
 #include <iterator>
@@ -23,15 +20,13 @@
 namespace PIOL { namespace File {
 void getMinMax(ExSeisPIOL * piol, size_t offset, size_t lnt, Meta m1, Meta m2, const Param * prm, CoordElem * minmax)
 {
-    std::vector<Param> vprm;
-    //TODO: Just add the two meta options to the rules with defaults?
+    ParamCol<geom_t> x(m1, prm);
+    ParamCol<geom_t> y(m2, prm);
+    std::vector<CoordPair> coord(lnt);
     for (size_t i = 0; i < lnt; i++)
-    {
-        vprm.emplace_back(prm->r, 1U);
-        cpyPrm(i, prm, 0, &vprm.back());
-    }
+        coord[i] = {x[i], y[i]};
 
-    getMinMax<Param>(piol, offset, lnt, vprm.data(), [m1](const Param & a) -> geom_t { return getPrm<geom_t>(0U, m1, &a); },
-                                                     [m2](const Param & a) -> geom_t { return getPrm<geom_t>(0U, m2, &a); }, minmax);
+    getMinMax<CoordPair>(piol, offset, lnt, coord.data(), [] (const CoordPair & a) -> geom_t { return a.x; },
+                                                          [] (const CoordPair & a) -> geom_t { return a.y; }, minmax);
 }
 }}
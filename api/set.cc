@@ -22,13 +22,15 @@ std::shared_ptr<File::Rule> getMaxRules(void)
 
 void Set::sort(SortType type)
 {
-    InternalSet::sort(File::getComp(type));
+    InternalSet::sort(File::SortFunc([type] (ExSeisPIOL * piol, File::Param * prm) -> std::vector<size_t>
+        {
+            return File::sort(piol, type, prm);
+        }));
 }
 
 void Set::getMinMax(Meta m1, Meta m2, CoordElem * minmax)
 {
-    InternalSet::getMinMax([m1](const File::Param & a) -> geom_t { return File::getPrm<geom_t>(0U, m1, &a); },
-                           [m2](const File::Param & a) -> geom_t { return File::getPrm<geom_t>(0U, m2, &a); }, minmax);
+    InternalSet::getMinMax(m1, m2, minmax);
 
 }
 
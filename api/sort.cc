@@ -4,11 +4,9 @@
  *   \copyright TBD. Do not distribute
  *   \date November 2016
  *   \brief The Sort Operation
- *   \details The algorithm used is a nearest neighbour approach where at each iteration
- *   the lowest valued metadata entries are moved to adjacent processes with a lower rank and a
- *   sort is performed. After the sort the highest entries are moved again to the process with a
- *   higher rank. If each process has the same traces it started off with, the sort
- *   is complete.
+ *   \details The comparison functions for each sort type are kept for general use, but the
+ *   sort itself encodes the parameters of each trace once into a fixed-width key. The keys
+ *   are radix sorted locally and sample sorted across processes.
 *//*******************************************************************************************/
 #include <algorithm>
 #include <iterator>
@@ -261,9 +259,120 @@ Compare<Param> getComp(SortType type)
     }
 }
 
-std::vector<size_t> sort(ExSeisPIOL * piol, SortType type, Param * prm)
+/*! Encode the sort keys for every trace in a parameter structure. The parameters of each
+ *  trace are only accessed once.
+ *  \tparam N The number of key words.
+ *  \tparam E The type of the encoding function.
+ *  \param[in] prm The parameter structure.
+ *  \param[in] enc The function which encodes the key words for a given trace.
+ *  \return Return the keys.
+ */
+template <size_t N, class E>
+std::vector<SortKey<N>> getKeys(const Param * prm, E enc)
+{
+    ParamCol<size_t> gtn(Meta::gtn, prm);
+    std::vector<SortKey<N>> key(prm->size());
+    for (size_t i = 0; i < key.size(); i++)
+    {
+        enc(i, key[i].k);
+        key[i].gtn = gtn[i];
+    }
+    return key;
+}
+
+/*! The columns of a parameter structure which are used by the sort keys.
+ */
+struct SortCols
+{
+    ParamCol<geom_t> xSrc;      //!< The source x coordinate.
+    ParamCol<geom_t> ySrc;      //!< The source y coordinate.
+    ParamCol<geom_t> xRcv;      //!< The receiver x coordinate.
+    ParamCol<geom_t> yRcv;      //!< The receiver y coordinate.
+    ParamCol<llint> il;         //!< The inline number.
+    ParamCol<llint> xl;         //!< The crossline number.
+    ParamCol<size_t> offset;    //!< The offset read from the header.
+    ParamCol<llint> ltn;        //!< The local trace number.
+    bool calcOff;               //!< If true, calculate the offset, otherwise read the offset from the header
+
+    /*! Construct the columns.
+     *  \param[in] prm The parameter structure.
+     *  \param[in] calcOff_ If true, calculate the offset, otherwise read the offset from the header
+     */
+    SortCols(const Param * prm, bool calcOff_) : xSrc(Meta::xSrc, prm), ySrc(Meta::ySrc, prm),
+        xRcv(Meta::xRcv, prm), yRcv(Meta::yRcv, prm), il(Meta::il, prm), xl(Meta::xl, prm),
+        offset(Meta::Offset, prm), ltn(Meta::ltn, prm), calcOff(calcOff_) { }
+
+    /*! Get the offset of a trace, either calculated from the coordinates or read from the header.
+     *  \param[in] i The trace number.
+     *  \return Return the offset.
+     */
+    geom_t getOff(size_t i) const
+    {
+        return (calcOff ? off(xSrc[i], ySrc[i], xRcv[i], yRcv[i]) : geom_t(offset[i]));
+    }
+};
+
+std::vector<size_t> sort(ExSeisPIOL * piol, SortType type, Param * prm, bool FileOrder)
 {
-    return sort(piol, prm, getComp(type));
+    bool calcOff = (type == SortType::SrcOff || type == SortType::RcvOff
+                 || type == SortType::LineOff || type == SortType::OffLine);
+    SortCols c(prm, calcOff);
+    std::vector<size_t> list;
+    switch (type)
+    {
+        default :
+        case SortType::SrcRcv :
+            list = sort(piol, getKeys<5U>(prm, [&c] (size_t i, uint64_t * k)
+            {
+                k[0] = encodeKey(c.xSrc[i]);
+                k[1] = encodeKey(c.ySrc[i]);
+                k[2] = encodeKey(c.xRcv[i]);
+                k[3] = encodeKey(c.yRcv[i]);
+                k[4] = encodeKey(c.ltn[i]);
+            }));
+        break;
+        case SortType::SrcOff :
+        case SortType::SrcROff :
+            list = sort(piol, getKeys<4U>(prm, [&c] (size_t i, uint64_t * k)
+            {
+                k[0] = encodeKey(c.xSrc[i]);
+                k[1] = encodeKey(c.ySrc[i]);
+                k[2] = encodeKey(c.getOff(i));
+                k[3] = encodeKey(c.ltn[i]);
+            }));
+        break;
+        case SortType::RcvOff :
+        case SortType::RcvROff :
+            list = sort(piol, getKeys<4U>(prm, [&c] (size_t i, uint64_t * k)
+            {
+                k[0] = encodeKey(c.xRcv[i]);
+                k[1] = encodeKey(c.yRcv[i]);
+                k[2] = encodeKey(c.getOff(i));
+                k[3] = encodeKey(c.ltn[i]);
+            }));
+        break;
+        case SortType::LineOff :
+        case SortType::LineROff :
+            list = sort(piol, getKeys<4U>(prm, [&c] (size_t i, uint64_t * k)
+            {
+                k[0] = encodeKey(c.il[i]);
+                k[1] = encodeKey(c.xl[i]);
+                k[2] = encodeKey(c.getOff(i));
+                k[3] = encodeKey(c.ltn[i]);
+            }));
+        break;
+        case SortType::OffLine :
+        case SortType::ROffLine :
+            list = sort(piol, getKeys<4U>(prm, [&c] (size_t i, uint64_t * k)
+            {
+                k[0] = encodeKey(c.getOff(i));
+                k[1] = encodeKey(c.il[i]);
+                k[2] = encodeKey(c.xl[i]);
+                k[3] = encodeKey(c.ltn[i]);
+            }));
+        break;
+    }
+    return (FileOrder ? sort(piol, list) : list);
 }
 
 bool checkOrder(ReadInterface * src, std::pair<size_t , size_t> dec, SortType type)
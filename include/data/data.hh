@@ -9,9 +9,19 @@
 *//*******************************************************************************************/
 #ifndef PIOLDATA_INCLUDE_GUARD
 #define PIOLDATA_INCLUDE_GUARD
+#include <vector>
 #include "global.hh"
 
 namespace PIOL { namespace Data {
+/*! \brief A run of equally spaced blocks of the same size.
+ */
+struct Extent
+{
+    size_t offset;  //!< The offset in bytes of the first block
+    size_t nb;      //!< The number of blocks
+    size_t osz;     //!< The number of bytes between the \c start of blocks
+};
+
 /*! \brief The Data layer interface. Specific data I/O implementations
  *  work off this base class.
  */
@@ -92,6 +102,70 @@ class Interface
      *  \param[in] d      The array to read data output from
      */
     virtual void write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const = 0;
+
+    /*! read a file where the blocks are given as runs of equally spaced blocks. The default
+     *  implementation expands the runs into a list of offsets.
+     *  \param[in] bsz    The size of a block in bytes
+     *  \param[in] ext    The runs of blocks
+     *  \param[out] d     The array to store the output in
+     */
+    virtual void read(csize_t bsz, const std::vector<Extent> & ext, uchar * d) const;
+
+    /*! write a file where the blocks are given as runs of equally spaced blocks. The default
+     *  implementation expands the runs into a list of offsets.
+     *  \param[in] bsz    The size of a block in bytes
+     *  \param[in] ext    The runs of blocks
+     *  \param[in] d      The array to get the input from
+     */
+    virtual void write(csize_t bsz, const std::vector<Extent> & ext, const uchar * d) const;
+
+    /*! \brief Bound the number of bytes any process transfers in a single read or write call.
+     *  While a bound is set, implementations which must make the same number of calls on every
+     *  process can work out that number locally instead of communicating. A transfer larger than the
+     *  bound is a fatal error for such implementations.
+     *  \param[in] bound The bound in bytes, the same on every process. Zero clears the bound.
+     */
+    virtual void setBound(csize_t bound) const
+    {
+        (void)bound;
+    }
+
+    /*! \brief Hint that a range of the file will be read soon so it can be read in the background
+     *  while the caller does other work. By default nothing is done.
+     *  \param[in] offset The offset in bytes of the range
+     *  \param[in] sz     The size in bytes of the range
+     */
+    virtual void prefetch(csize_t offset, csize_t sz) const
+    {
+        (void)offset;
+        (void)sz;
+    }
+
+    /*! \brief Drop every range hinted with prefetch which has not been read yet. By default
+     *  nothing is done.
+     */
+    virtual void dropPrefetch(void) const { }
+
+    /*! \brief Declare that every process serves its next read from the ranges hinted with
+     *  prefetch, so the processes need not agree on it. A process whose read is not inside its
+     *  ranges reads alone. By default nothing is done.
+     */
+    virtual void usePrefetch(void) const { }
+
+    /*! \brief Get memory for a transfer of a range of the file, placed so the file can move the
+     *  range without a copy. By default the memory is not placed.
+     *  \param[in] offset The offset in bytes of the range
+     *  \param[in] sz     The size in bytes of the range
+     *  \param[in, out] buf The buffer which holds the memory. It grows if it is too small.
+     *  \return A pointer into buf to sz bytes for the range
+     */
+    virtual uchar * place(csize_t offset, csize_t sz, std::vector<uchar> & buf) const
+    {
+        (void)offset;
+        if (buf.size() < sz)
+            buf.resize(sz);
+        return buf.data();
+    }
 };
 }}
 #endif
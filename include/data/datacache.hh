@@ -0,0 +1,154 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief The block cache implementation of the Data layer interface
+ *   \details Reads go through a per-process cache of fixed size blocks of the file held in front
+ *   of another Data object. The least recently used blocks are evicted once the byte budget is
+ *   reached. Writes go straight through to the file and drop the blocks they touch.
+ *
+ *   The cache of a process only sees the writes of that process. Since a read which hits the
+ *   cache does not reach the file, processes do not match their calls and the file underneath
+ *   must not need collective calls.
+*//*******************************************************************************************/
+#ifndef PIOLDATACACHE_INCLUDE_GUARD
+#define PIOLDATACACHE_INCLUDE_GUARD
+#include <list>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "global.hh"
+#include "data/data.hh"
+
+namespace PIOL { namespace Data {
+/*! \brief The block cache Data class.
+ */
+class Cache : public Interface
+{
+    public :
+    /*! \brief The block cache options structure.
+     */
+    struct Opt
+    {
+        typedef Cache Type;     //!< The Type of the class this structure is nested in
+        size_t budget;          //!< The most bytes of the file held in the cache. Zero disables the cache.
+        size_t block;           //!< The size in bytes of a block of the cache
+        Opt(void);              //!< The constructor to set default options
+    };
+
+    /*! \brief The cache counters. Hits and misses are counted in blocks.
+     */
+    struct Stats
+    {
+        size_t hits;            //!< The blocks found in the cache
+        size_t misses;          //!< The blocks read from the file
+        size_t evictions;       //!< The blocks dropped to stay within the budget
+        size_t invalidations;   //!< The blocks dropped by writes or size changes
+    };
+
+    private :
+    /*! \brief A cached block of the file.
+     */
+    struct Block
+    {
+        std::vector<uchar> d;               //!< The bytes of the block. A block at the end of the file may be short.
+        std::list<size_t>::iterator lru;    //!< The position of the block in the recently used list
+    };
+
+    std::shared_ptr<Interface> data;                        //!< The file underneath the cache
+    size_t block;                                           //!< \copydoc Cache::Opt::block
+    size_t nblock;                                          //!< The most blocks held at a time
+    mutable size_t fsz;                                     //!< The file size as this process knows it
+    mutable std::list<size_t> lru;                          //!< The cached blocks, most recently used first
+    mutable std::unordered_map<size_t, Block> blocks;       //!< The cached blocks by block number
+    mutable Stats stats;                                    //!< The cache counters
+
+    /*! \brief Drop the cached blocks which hold any byte of a range.
+     *  \param[in] offset The offset in bytes of the range
+     *  \param[in] sz The size in bytes of the range
+     */
+    void invalidate(csize_t offset, csize_t sz) const;
+
+    /*! \brief Read blocks of the same size through the cache.
+     *  \param[in] bsz The block size in bytes
+     *  \param[in] nb The number of blocks
+     *  \param[in] off A function which returns the offset in bytes of the ith block
+     *  \param[out] d The blocks back to back
+     */
+    void blockRead(csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const;
+
+    /*! \brief Drop the blocks written to after a write.
+     *  \param[in] bsz The block size in bytes
+     *  \param[in] nb The number of blocks
+     *  \param[in] off A function which returns the offset in bytes of the ith block
+     */
+    void blockWritten(csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off) const;
+
+    /*! \brief The block cache Init function.
+     *  \param[in] opt  The block cache options
+     */
+    void Init(const Cache::Opt & opt);
+
+    public :
+    /*! \brief The block cache class constructor. The file is opened with independent MPI-IO.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] opt   The block cache options
+     *  \param[in] mode The filemode
+     */
+    Cache(const Piol piol_, const std::string name_, const Cache::Opt & opt, FileMode mode = FileMode::Read);
+
+    /*! \brief The block cache class constructor. The file is opened with independent MPI-IO.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] mode The filemode
+     */
+    Cache(const Piol piol_, const std::string name_, FileMode mode = FileMode::Read);
+
+    /*! \brief The block cache class constructor for a file which is already open.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] data_ The file to cache. It must not need collective calls.
+     *  \param[in] opt   The block cache options
+     */
+    Cache(const Piol piol_, const std::string name_, std::shared_ptr<Interface> data_, const Cache::Opt & opt);
+
+    /*! \brief Get the cache counters.
+     *  \return The counters since the file was opened or the counters were last reset
+     */
+    Stats getStats(void) const
+    {
+        return stats;
+    }
+
+    /*! \brief Reset the cache counters.
+     */
+    void resetStats(void) const
+    {
+        stats = Stats();
+    }
+
+    /*! \brief Drop every cached block, e.g. after another process writes to the file.
+     */
+    void clear(void) const;
+
+    size_t getFileSz() const;
+
+    void setFileSz(csize_t sz) const;
+
+    void read(csize_t offset, csize_t sz, uchar * d) const;
+
+    void read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const;
+
+    void read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const;
+
+    void write(csize_t offset, csize_t sz, const uchar * d) const;
+
+    void write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const;
+
+    void write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const;
+};
+}}
+#endif
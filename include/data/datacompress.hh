@@ -0,0 +1,231 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief The compressed implementation of the Data layer interface
+ *   \details The logical byte stream of the file is cut into chunks of a fixed size. Each chunk is
+ *   byte shuffled, so the bytes of the same significance of the samples sit together, and
+ *   compressed with zlib on its own. A chunk index gives random access to the chunks. The Object
+ *   and File layers see the logical byte stream, i.e an ordinary SEG-Y file.
+ *
+ *   The container starts with a header of 64 bytes:
+ *   \code
+ *   magic    16 bytes  "ExSeisDat chunks"
+ *   chunk     8 bytes  The logical size of a chunk
+ *   shuffle   8 bytes  The width of the byte shuffled elements
+ *   size      8 bytes  The logical size of the file
+ *   index     8 bytes  The offset of the chunk index
+ *   count     8 bytes  The number of chunks in the index
+ *   \endcode
+ *   The compressed chunks follow. The index holds the offset and compressed size of each chunk.
+ *   A compressed size equal to the chunk size means the chunk is stored as it is and zero means
+ *   the chunk holds only zeros. Numbers are in the byte order of the machine which wrote them.
+ *   Chunks are not rewritten in place. A chunk written again is appended, so a container which
+ *   is rewritten grows until it is copied.
+ *
+ *   Each process compresses the chunks it writes and decompresses the chunks it reads, with
+ *   OpenMP threads where there are several. Writes are held in memory with a bit mask of the
+ *   bytes written. Once the memory budget is reached the chunks written in full are compressed
+ *   and appended, and if that is not enough the chunks written in part are filled from what is
+ *   stored and spilled to the container, where only this process can see them, keeping their
+ *   masks. Chunks written in part by several processes are merged by the first of them in
+ *   setFileSz and the destructor, which every process calls together. As with MPI-IO, the writes
+ *   of other processes are only certain to be seen after such a call.
+*//*******************************************************************************************/
+#ifndef PIOLDATACOMPRESS_INCLUDE_GUARD
+#define PIOLDATACOMPRESS_INCLUDE_GUARD
+#include <mpi.h>
+#include <map>
+#include <memory>
+#include <vector>
+#include <functional>
+#include "global.hh"
+#include "data/data.hh"
+#include "data/datampiio.hh"
+
+namespace PIOL { namespace Data {
+/*! \brief The compressed Data class. The container is accessed with independent MPI-IO.
+ */
+class Compress : public Interface
+{
+    public :
+    /*! \brief The compressed options structure. The layout options are only used when a new
+     *  container is created, otherwise the layout is taken from the header.
+     */
+    struct Opt
+    {
+        typedef Compress Type;  //!< The Type of the class this structure is nested in
+        size_t chunk;           //!< The logical size in bytes of a chunk
+        size_t shuffle;         //!< The width in bytes of the byte shuffled elements. Zero or one disables shuffling.
+        int level;              //!< The zlib compression level
+        size_t budget;          //!< The most bytes of written chunks a process holds between collective calls
+        MPI_Comm fcomm;         //!< The MPI communicator to use for file access
+        Opt(void);              //!< The constructor to set default options
+    };
+
+    private :
+    /*! \brief The place of a compressed chunk in the container.
+     */
+    struct Entry
+    {
+        size_t offset;          //!< The offset in bytes of the compressed chunk
+        size_t csz;             //!< The compressed size in bytes. Zero if the chunk holds only zeros.
+    };
+
+    /*! \brief A chunk written by this process which is not in the container yet.
+     */
+    struct Dirty
+    {
+        std::vector<uchar> d;       //!< The chunk. Empty while the chunk is spilled.
+        std::vector<uchar> mask;    //!< A bit mask of the bytes which were written
+        size_t nset;                //!< The number of bytes which were written
+        Entry spill;                //!< Where the chunk is spilled if d is empty
+    };
+
+    std::shared_ptr<MPIIO> file;                //!< The container
+    size_t chunk;                               //!< \copydoc Compress::Opt::chunk
+    size_t shuffle;                             //!< \copydoc Compress::Opt::shuffle
+    int level;                                  //!< \copydoc Compress::Opt::level
+    size_t budget;                              //!< \copydoc Compress::Opt::budget
+    MPI_Comm fcomm;                             //!< \copydoc Compress::Opt::fcomm
+    MPI_Win win;                                //!< The end of the container, held by the first process
+    mutable size_t fsz;                         //!< The logical file size as this process knows it
+    mutable std::vector<Entry> index;           //!< The chunk index as this process knows it
+    mutable std::map<size_t, Dirty> dirty;      //!< The chunks written by this process which are not stored
+    mutable std::vector<size_t> stored;         //!< The chunks this process stored since the last collective call
+    mutable size_t held;                        //!< The bytes held by the dirty chunks
+
+    /*! \brief Reserve space at the end of the container.
+     *  \param[in] sz The number of bytes
+     *  \return The offset of the space
+     */
+    size_t append(csize_t sz) const;
+
+    /*! \brief Find where a chunk is stored.
+     *  \param[in] c The chunk number
+     *  \return The index entry of the chunk, an entry of zeros if it was never stored
+     */
+    Entry locate(csize_t c) const;
+
+    /*! \brief Read and decompress chunks.
+     *  \param[in] es The places of the chunks
+     *  \param[out] d The chunks back to back
+     */
+    void fetch(const std::vector<Entry> & es, uchar * d) const;
+
+    /*! \brief Compress chunks and append them to the container without adding them to the index.
+     *  \param[in] src The chunks
+     *  \return The places of the chunks
+     */
+    std::vector<Entry> pack(const std::vector<const uchar *> & src) const;
+
+    /*! \brief Compress chunks and append them to the container.
+     *  \param[in] cs The chunk numbers
+     *  \param[in] src The chunks
+     */
+    void store(const std::vector<size_t> & cs, const std::vector<const uchar *> & src) const;
+
+    /*! \brief Store the chunks this process has written in full.
+     */
+    void storeFull(void) const;
+
+    /*! \brief Fill the chunks this process has written in part from what is stored and spill them
+     *  to the container. Only the masks are held afterwards.
+     */
+    void spillPartial(void) const;
+
+    /*! \brief Read spilled chunks back into memory.
+     *  \param[in] cs The chunk numbers
+     */
+    void unspill(const std::vector<size_t> & cs) const;
+
+    /*! \brief Share the index entries of the chunks every process stored since the last call.
+     *  This is collective.
+     *  \return The number of chunks shared
+     */
+    size_t share(void) const;
+
+    /*! \brief Merge and store the chunks every process has written and share the index. This is
+     *  collective.
+     *  \param[in] resize Whether to set the logical file size
+     *  \param[in] sz The logical file size if resize is true
+     */
+    void sync(bool resize, csize_t sz) const;
+
+    /*! \brief Write the index and the header on the first process.
+     */
+    void writeIndex(void) const;
+
+    /*! \brief Read the header and index on the first process and share them with the others.
+     *  \return True if the container is valid
+     */
+    bool readIndex(void);
+
+    /*! \brief Transfer blocks of the same size through the chunks.
+     *  \param[in] write Whether to write
+     *  \param[in] bsz The block size in bytes
+     *  \param[in] nb The number of blocks
+     *  \param[in] off A function which returns the offset in bytes of the ith block
+     *  \param[in, out] d The blocks back to back
+     */
+    void blockIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const;
+
+    /*! \brief The compressed Init function.
+     *  \param[in] opt  The compressed options
+     *  \param[in] mode The filemode
+     */
+    void Init(const Compress::Opt & opt, FileMode mode);
+
+    public :
+    /*! \brief The compressed class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the container.
+     *  \param[in] opt   The compressed options
+     *  \param[in] mode The filemode. FileMode::Write and FileMode::Test create a new container.
+     */
+    Compress(const Piol piol_, const std::string name_, const Compress::Opt & opt, FileMode mode = FileMode::Read);
+
+    /*! \brief The compressed class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the container.
+     *  \param[in] mode The filemode. FileMode::Write and FileMode::Test create a new container.
+     */
+    Compress(const Piol piol_, const std::string name_, FileMode mode = FileMode::Read);
+
+    ~Compress(void);
+
+    /*! \brief Find if a file is a compressed container, i.e if it starts with the magic string.
+     *  The first process reads the file and shares the answer. This is collective.
+     *  \param[in] piol The PIOL object
+     *  \param[in] name The name of the file
+     *  \return True if the file is a compressed container
+     */
+    static bool isCompressed(const Piol piol, const std::string & name);
+
+    /*! \brief Get the size of the container.
+     *  \return The size in bytes of the container on storage
+     */
+    size_t getStoredSz(void) const
+    {
+        return file->getFileSz();
+    }
+
+    size_t getFileSz() const;
+
+    void setFileSz(csize_t sz) const;
+
+    void read(csize_t offset, csize_t sz, uchar * d) const;
+
+    void read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const;
+
+    void read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const;
+
+    void write(csize_t offset, csize_t sz, const uchar * d) const;
+
+    void write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const;
+
+    void write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const;
+};
+}}
+#endif
@@ -0,0 +1,112 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief The in-memory implementation of the Data layer interface
+ *   \details The file is held in the memory of the processes instead of on storage. The bytes of
+ *   the file are split into chunks which are dealt out to the processes in turn, and chunks owned
+ *   by other processes are reached through MPI one-sided communication. Files are found by name
+ *   so a file written by one stage of a workflow can be read by the next without touching disk.
+ *
+ *   As with MPI-IO, the writes of other processes are only certain to be seen after a call every
+ *   process makes together: setFileSz and the destructor.
+*//*******************************************************************************************/
+#ifndef PIOLDATAMEMORY_INCLUDE_GUARD
+#define PIOLDATAMEMORY_INCLUDE_GUARD
+#include <mpi.h>
+#include <memory>
+#include <vector>
+#include <functional>
+#include "global.hh"
+#include "data/data.hh"
+
+namespace PIOL { namespace Data {
+/*! \brief The in-memory Data class.
+ */
+class Memory : public Interface
+{
+    public :
+    /*! \brief The in-memory options structure.
+     */
+    struct Opt
+    {
+        typedef Memory Type;    //!< The Type of the class this structure is nested in
+        MPI_Comm comm;          //!< The MPI communicator which holds the file
+        size_t chunk;           //!< The size in bytes of the chunks dealt out to each process. It is fixed when the file is created.
+        Opt(void);              //!< The constructor to set default options
+    };
+
+    /*! \brief Find if a file name refers to an in-memory file, i.e if it starts with "mem:".
+     *  \param[in] name The name of the file
+     *  \return True if the name is that of an in-memory file
+     */
+    static bool isMemory(const std::string & name);
+
+    struct Store;                   //!< The in-memory file shared by every open instance of it
+
+    private :
+    std::shared_ptr<Store> store;   //!< The in-memory file. Null if the file could not be opened.
+    bool remove;                    //!< Whether the file is deleted on destruction
+
+    /*! \brief Transfer blocks of the same size to or from the processes which own them.
+     *  \param[in] write Whether to write
+     *  \param[in] bsz The block size in bytes
+     *  \param[in] nb The number of blocks
+     *  \param[in] off A function which returns the offset in bytes of the ith block
+     *  \param[in, out] d The blocks back to back
+     */
+    void blockIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const;
+
+    /*! \brief Make the writes of every process visible to every process. Collective.
+     */
+    void sync(void) const;
+
+    /*! \brief The in-memory Init function.
+     *  \param[in] opt  The in-memory options
+     *  \param[in] mode The filemode
+     */
+    void Init(const Memory::Opt & opt, FileMode mode);
+
+    public :
+    /*! \brief The in-memory class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] opt   The in-memory options
+     *  \param[in] mode The filemode. FileMode::Read requires the file to exist.
+     */
+    Memory(const Piol piol_, const std::string name_, const Memory::Opt & opt, FileMode mode = FileMode::Read);
+
+    /*! \brief The in-memory class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] mode The filemode. FileMode::Read requires the file to exist.
+     */
+    Memory(const Piol piol_, const std::string name_, FileMode mode = FileMode::Read);
+
+    ~Memory(void);
+
+    /*! \brief Delete an in-memory file. Every process of the communicator must call this.
+     *  The memory is freed once the last open instance of the file is destroyed.
+     *  \param[in] name The name of the file
+     */
+    static void erase(const std::string & name);
+
+    size_t getFileSz() const;
+
+    void setFileSz(csize_t sz) const;
+
+    void read(csize_t offset, csize_t sz, uchar * d) const;
+
+    void read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const;
+
+    void read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const;
+
+    void write(csize_t offset, csize_t sz, const uchar * d) const;
+
+    void write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const;
+
+    void write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const;
+};
+}}
+#endif
@@ -0,0 +1,114 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief The memory-mapped implementation of the Data layer interface
+ *   \details Each process maps the whole file read-only and reads are copies out of the mapping.
+ *   It suits many scattered reads of the same file since no request goes through the MPI-IO
+ *   layer. There are no collective calls so processes do not need to match their calls.
+*//*******************************************************************************************/
+#ifndef PIOLDATAMMAP_INCLUDE_GUARD
+#define PIOLDATAMMAP_INCLUDE_GUARD
+#include "global.hh"
+#include "data/data.hh"
+
+namespace PIOL { namespace Data {
+/*! The access pattern hint given to the kernel for the mapping.
+ */
+enum class Advice : size_t
+{
+    Auto,       //!< Hint each request from its layout
+    Normal,     //!< The default read-ahead of the kernel
+    Sequential, //!< Aggressive read-ahead, pages are dropped soon after use
+    Random      //!< No read-ahead
+};
+
+/*! \brief The memory-mapped Data class.
+ */
+class MMap : public Interface
+{
+    public :
+
+    /*! \brief The memory-mapped options structure.
+     */
+    struct Opt
+    {
+        typedef MMap Type;  //!< The Type of the class this structure is nested in
+        Advice advice;      //!< The access pattern hint. Anything but Auto is applied once to the whole mapping.
+        size_t willSz;      //!< With Advice::Auto, the size in bytes from which a contiguous read asks for its pages in advance
+        Opt(void);          //!< The constructor to set default options
+    };
+
+    private :
+    int fd;                 //!< The file descriptor
+    size_t fsz;             //!< The size of the file when it was mapped
+    uchar * map;            //!< The mapping of the file or nullptr if there is nothing mapped
+    Advice advice;          //!< \copydoc MMap::Opt::advice
+    size_t willSz;          //!< \copydoc MMap::Opt::willSz
+
+    /*! \brief Give the kernel a hint for a range of the file.
+     *  \param[in] offset The offset in bytes of the range
+     *  \param[in] sz The size in bytes of the range
+     *  \param[in] adv The madvise hint
+     */
+    void advise(csize_t offset, csize_t sz, int adv) const;
+
+    /*! \brief Copy a block out of the mapping. Bytes beyond the end of the file are not read.
+     *  \param[in] offset The offset in bytes of the block
+     *  \param[in] sz The size in bytes of the block
+     *  \param[out] d The array to store the block in
+     */
+    void copy(csize_t offset, csize_t sz, uchar * d) const;
+
+    /*! \brief Record the error of an attempt to change the file.
+     *  \param[in] msg The operation attempted
+     */
+    void readOnly(const std::string msg) const;
+
+    /*! \brief The memory-mapped Init function.
+     *  \param[in] opt  The memory-mapped options
+     *  \param[in] mode The filemode
+     */
+    void Init(const MMap::Opt & opt, FileMode mode);
+
+    public :
+    /*! \brief The memory-mapped class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] opt   The memory-mapped options
+     *  \param[in] mode The filemode. Only FileMode::Read is supported.
+     */
+    MMap(const Piol piol_, const std::string name_, const MMap::Opt & opt, FileMode mode = FileMode::Read);
+
+    /*! \brief The memory-mapped class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] mode The filemode. Only FileMode::Read is supported.
+     */
+    MMap(const Piol piol_, const std::string name_, FileMode mode = FileMode::Read);
+
+    ~MMap(void);
+
+    size_t getFileSz() const;
+
+    void setFileSz(csize_t sz) const;
+
+    void read(csize_t offset, csize_t sz, uchar * d) const;
+
+    void read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const;
+
+    void read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const;
+
+    void read(csize_t bsz, const std::vector<Extent> & ext, uchar * d) const;
+
+    void write(csize_t offset, csize_t sz, const uchar * d) const;
+
+    void write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const;
+
+    void write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const;
+
+    void write(csize_t bsz, const std::vector<Extent> & ext, const uchar * d) const;
+};
+}}
+#endif
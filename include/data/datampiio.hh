@@ -8,6 +8,10 @@
 *//*******************************************************************************************/
 #ifndef PIOLDATAMPIIO_INCLUDE_GUARD
 #define PIOLDATAMPIIO_INCLUDE_GUARD
+#include <list>
+#include <deque>
+#include <tuple>
+#include <limits>
 #include "global.hh"
 #include "data/data.hh"
 
@@ -17,6 +21,15 @@ namespace PIOL { namespace Data {
 template <typename U>
 using MFp = std::function<int(MPI_File, MPI_Offset, void *, int, MPI_Datatype, U *)>;
 
+/*! \brief How the processes perform a read or write.
+ */
+enum class IOMode : size_t
+{
+    Collective,     //!< Every process takes part in every read or write
+    Independent,    //!< Processes read and write alone. Processes with nothing to transfer need not call.
+    Auto            //!< Choose collective or independent I/O for each read or write. This is never the default.
+};
+
 /*! \brief The MPI-IO Data class.
  */
 class MPIIO : public Interface
@@ -28,38 +41,138 @@ class MPIIO : public Interface
     struct Opt
     {
         typedef MPIIO Type; //!< The Type of the class this structure is nested in
-        bool coll;          //!< Whether collective read/write operations will be used
+        IOMode mode;        //!< Whether collective or independent read/write operations will be used
+        size_t autoSz;      //!< In Auto mode, use independent I/O if all processes together transfer at most this many bytes
+        size_t autoRatio;   //!< In Auto mode, use independent I/O if at most one in this many processes transfer data
         MPI_Info info;      //!< The info structure to use
         size_t maxSize;     //!< The maximum size to allow to be written to disk per process in one operation
         MPI_Comm fcomm;     //!< The MPI communicator to use for file access
+        size_t typeCache;   //!< The number of committed datatypes kept for reuse by strided I/O
+        bool persistView;   //!< Whether the view of strided I/O is left in place for later accesses of the same shape
+        size_t sieveGap;    //!< List I/O reads blocks separated by at most this many bytes as one extent. Zero disables sieving.
+        bool sieveWrite;    //!< Whether list writes may sieve by read-modify-write when no other process writes between the blocks
+        size_t ahead;       //!< The most read-ahead requests kept in flight. Zero disables read-ahead.
         Opt(void);          //!< The constructor to set default options
         ~Opt(void);         //!< The destructor
     };
 
     private :
-    bool coll;          //!< Whether collective read/write operations will be used
+    IOMode mode;        //!< \copydoc MPIIO::Opt::mode
+    size_t autoSz;      //!< \copydoc MPIIO::Opt::autoSz
+    size_t autoRatio;   //!< \copydoc MPIIO::Opt::autoRatio
     MPI_File file;      //!< The MPI-IO file handle
+    int iflags;         //!< The MPI mode flags of the independent file handle
+    mutable MPI_File ifile; //!< The file handle for independent I/O. It is opened by this process alone on first use.
+    mutable bool cwrote;    //!< Whether there are writes through the collective handle which are not synced
+    mutable bool iwrote;    //!< Whether there are writes through the independent handle which are not synced
     MPI_Comm fcomm;     //!< The MPI-IO file communicator
     MPI_Info info;      //!< \copydoc MPIIO::Opt::info
     size_t maxSize;     //!< \copydoc MPIIO::Opt::maxSize
+    size_t typeCache;   //!< \copydoc MPIIO::Opt::typeCache
+    bool persistView;   //!< \copydoc MPIIO::Opt::persistView
+    size_t sieveGap;    //!< \copydoc MPIIO::Opt::sieveGap
+    bool sieveWrite;    //!< \copydoc MPIIO::Opt::sieveWrite
+    bool readable;      //!< Whether the file was opened for reading
+    mutable size_t bound;   //!< The bound in bytes on any single transfer by any process. Zero if unbounded.
+    size_t aheadMax;    //!< \copydoc MPIIO::Opt::ahead
+
+    /*! A range of the file being read ahead of use
+     */
+    struct Ahead
+    {
+        size_t offset;                  //!< The offset in bytes of the range
+        std::vector<uchar> d;           //!< The bytes of the range
+        std::vector<MPI_Request> req;   //!< The requests still in flight
+    };
+    mutable std::deque<Ahead> ahead;    //!< The ranges read ahead, oldest first
+    mutable bool aheadNext;             //!< Whether every process serves its next read from the ranges read ahead
+
+    typedef std::tuple<size_t, size_t, size_t> TypeKey;                 //!< The (block, stride, count) of a datatype
+    mutable std::list<std::pair<TypeKey, MPI_Datatype>> types;          //!< Committed datatypes, most recently used first
+
+    /*! The view left in place by strided I/O when views persist
+     */
+    mutable struct
+    {
+        bool active;    //!< Whether a strided view is set
+        size_t bsz;     //!< The block size in bytes
+        size_t osz;     //!< The stride in bytes
+        size_t disp;    //!< The displacement of the view in bytes
+    } view;
+
+    /*! Get a committed datatype of count blocks of bsz bytes separated by osz bytes. Datatypes are
+     *  cached so repeated accesses of the same shape do not create and commit a new datatype.
+     *  \param[in] bsz The block size in bytes
+     *  \param[in] osz The number of bytes between the start of blocks
+     *  \param[in] nb The number of blocks. If \c MPIIO::tile a single block is resized to the stride so the
+     *                datatype tiles the file.
+     *  \return The datatype or MPI_DATATYPE_NULL on error.
+     */
+    MPI_Datatype getType(csize_t bsz, csize_t osz, csize_t nb) const;
+
+    /*! Set a view so the blocks of a strided access appear contiguous.
+     *  \param[in] offset The offset in bytes of the first block
+     *  \param[in] bsz The block size in bytes
+     *  \param[in] osz The number of bytes between the start of blocks
+     *  \param[in] nb The number of blocks
+     *  \return The offset in bytes within the view of the first block.
+     */
+    size_t setView(csize_t offset, csize_t bsz, csize_t osz, csize_t nb) const;
+
+    /*! Reset a strided view which was left in place so the file appears as bytes again.
+     */
+    void resetView(void) const;
+
+    /*! Get the file handle for independent I/O, opening it if this is the first use. Views set on
+     *  this handle only involve the calling process.
+     *  \return The file handle.
+     */
+    MPI_File getIndep(void) const;
+
+    /*! Sync the other file handle if it was written through, so the writes are seen through the
+     *  handle which is about to be used. Syncing the collective handle is collective. Every process
+     *  writes through it together and in Auto mode every process makes the same choice of handle,
+     *  so they all sync it together.
+     *  \param[in] indep Whether the independent handle is about to be used
+     */
+    void syncFor(bool indep) const;
 
     /*! Read a file using MPI-IO views. This function does not handle the integer limit
+     *  \param[in] indep  Whether the read is independent
      *  \param[in] offset The offset in bytes from the current internal shared pointer
      *  \param[in] bsz    The size of a block in bytes
      *  \param[in] osz    The number of bytes between the \c start of blocks
      *  \param[in] sz     The number of blocks
      *  \param[out] d     The array to store the output in
      */
-    void readv(csize_t offset, csize_t bsz, csize_t osz, csize_t sz, uchar * d) const;
+    void readv(bool indep, csize_t offset, csize_t bsz, csize_t osz, csize_t sz, uchar * d) const;
 
     /*! Write a file using MPI-IO views. This function does not handle the integer limit
+     *  \param[in] indep  Whether the write is independent
      *  \param[in] offset The offset in bytes from the current internal shared pointer
      *  \param[in] bsz    The size of a block in bytes
      *  \param[in] osz    The number of bytes between the \c start of blocks
      *  \param[in] sz     The number of blocks
      *  \param[in] d      The array to read data output from
      */
-    void writev(csize_t offset, csize_t bsz, csize_t osz, csize_t sz, const uchar * d) const;
+    void writev(bool indep, csize_t offset, csize_t bsz, csize_t osz, csize_t sz, const uchar * d) const;
+
+    /*! Serve a read from a range read ahead if one holds every block of it and drop the range. With
+     *  collective or automatic I/O this is only done when usePrefetch was called, so every process
+     *  skips the collective read. A process whose read is not in a range then reads alone, and a
+     *  process with nothing to read drops its oldest range so every process keeps the same number.
+     *  \param[in] offset The offset in bytes of the first block
+     *  \param[in] bsz    The size of a block in bytes
+     *  \param[in] osz    The number of bytes between the \c start of blocks
+     *  \param[in] nb     The number of blocks
+     *  \param[out] d     The array to store the output in
+     *  \return True if the read was served.
+     */
+    bool fromAhead(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const;
+
+    /*! Wait for and drop every range read ahead, e.g. before the file changes.
+     */
+    void dropAhead(void) const;
 
     /*! \brief The MPI-IO Init function.
      *  \param[in] opt  The MPI-IO options
@@ -68,7 +181,8 @@ class MPIIO : public Interface
     void Init(const MPIIO::Opt & opt, FileMode mode);
 
     /*! \brief Perform I/O on contiguous or monotonically increasing blocked data
-     *  \param[in] fn The MPI-IO style function to perform the I/O with
+     *  \param[in] cfn The MPI-IO style function to perform collective I/O with
+     *  \param[in] ifn The MPI-IO style function to perform independent I/O with
      *  \param[in] offset The offset in bytes from the current internal shared pointer
      *  \param[in] sz The amount of data to read from disk. d must be an array with
      *             sz elements.
@@ -76,21 +190,64 @@ class MPIIO : public Interface
      *  \param[in] msg The message to be written if there is an error
      *  \param[in] bsz The block size in bytes (if not contiguous)
      *  \param[in] osz The stride size in bytes (block start to block start)
+     *  \param[in] write Whether the I/O is a write
      */
-    void contigIO(const MFp<MPI_Status> fn, csize_t offset, csize_t sz, uchar * d, std::string msg,
-                                                            csize_t bsz = 1U, csize_t osz = 1U) const;
+    void contigIO(const MFp<MPI_Status> cfn, const MFp<MPI_Status> ifn, csize_t offset, csize_t sz, uchar * d,
+                  std::string msg, csize_t bsz = 1U, csize_t osz = 1U, bool write = false) const;
 
-    /*! \brief Perform I/O on blocks of data where each block starts at the location specified by an array of offsets.
+    /*! \brief Perform I/O on contiguous data in calls of at most maxSize bytes, then make any zero-sized calls.
      *  \param[in] fn The MPI-IO style function to perform the I/O with
+     *  \param[in] f The file handle
+     *  \param[in] offset The offset in bytes from the current internal shared pointer
+     *  \param[in] sz The number of elements
+     *  \param[in, out] d The array to get the input from or store the output in.
+     *  \param[in] msg The message to be written if there is an error
+     *  \param[in] bsz The element size in bytes
+     *  \param[in] osz The stride size in bytes
+     *  \param[in] max The maximum number of elements per call
+     *  \param[in] remCall The number of zero-sized calls
+     */
+    void chunkIO(const MFp<MPI_Status> fn, MPI_File f, csize_t offset, csize_t sz, uchar * d, std::string msg,
+                 csize_t bsz, csize_t osz, csize_t max, csize_t remCall) const;
+
+    /*! \brief Perform I/O on blocks of data where each block starts at the location specified by an array of offsets.
+     *  \param[in] cfn The MPI-IO style function to perform collective I/O with
+     *  \param[in] ifn The MPI-IO style function to perform independent I/O with
      *  \param[in] bsz The block size in bytes.
      *  \param[in] sz The amount of blocks to read
      *  \param[in] offset An array of offsets in bytes from the current internal shared pointer
      *  \param[in, out] d The array to get the input from or store the output in.
      *  \param[in] msg The message to be written if there is an error
+     *  \param[in] write Whether the I/O is a write. Sieved writes read the gaps between blocks first.
+     *  \param[in] ext If not null, the runs of blocks to use instead of the offsets. sz is the total
+     *                 number of blocks of the runs.
      */
-    void listIO(const MFp<MPI_Status> fn, csize_t bsz, csize_t sz, csize_t * offset, uchar * d, std::string msg) const;
+    void listIO(const MFp<MPI_Status> cfn, const MFp<MPI_Status> ifn, csize_t bsz, csize_t sz, csize_t * offset, uchar * d,
+                std::string msg, bool write = false, const std::vector<Extent> * ext = nullptr) const;
+
+    /*! \brief Find if the span of the blocks of each process overlaps with no other process.
+     *  This is collective.
+     *  \param[in] span The offsets in bytes of the start and end of the blocks of this process. The end
+     *                  is zero if there are no blocks.
+     *  \return True if no two spans overlap.
+     */
+    bool disjoint(const std::pair<size_t, size_t> & span) const;
+
+    /*! \brief Choose collective or independent I/O for a request and, for collective I/O, find how many
+     *  zero-sized calls this process must make so every process makes the same number of calls.
+     *  If a bound is set this is found locally, otherwise the sizes are gathered from every process.
+     *  Every process which takes part makes the same choice. A collective transfer larger than the bound
+     *  can not be matched by the other processes, so the job is aborted.
+     *  \param[in] sz The number of elements this process transfers
+     *  \param[in] bsz The size of an element in bytes
+     *  \param[in] max The maximum number of elements transferred per call
+     *  \param[out] remCall The number of zero-sized calls.
+     *  \return True if the I/O is independent.
+     */
+    bool choose(csize_t sz, csize_t bsz, csize_t max, size_t * remCall) const;
 
     public :
+    static constexpr size_t tile = std::numeric_limits<size_t>::max();   //!< The block count of a datatype which tiles the file
 
     /*! \brief The MPI-IO class constructor.
      *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
@@ -121,9 +278,37 @@ class MPIIO : public Interface
 
     void write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const;
 
+    void read(csize_t bsz, const std::vector<Extent> & ext, uchar * d) const;
+
+    void write(csize_t bsz, const std::vector<Extent> & ext, const uchar * d) const;
+
     void write(csize_t offset, csize_t sz, const uchar * d) const;
 
     void write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const;
+
+    void setBound(csize_t bound_) const;
+
+    /*! \brief Start an independent nonblocking read of a range so a later read of any blocks inside it
+     *  is a copy. The last MPIIO::Opt::ahead ranges are kept, the oldest is dropped for a new one. A range
+     *  is dropped once it has served a read.
+     *  \details With collective or automatic I/O this is collective in the sense that every process must
+     *  make the same number of calls, with an empty range if it has nothing to read. Reads are only
+     *  served from the ranges after usePrefetch, so the processes need not agree.
+     *  \param[in] offset The offset in bytes of the range
+     *  \param[in] sz     The size in bytes of the range
+     */
+    void prefetch(csize_t offset, csize_t sz) const;
+
+    void dropPrefetch(void) const
+    {
+        dropAhead();
+    }
+
+    void usePrefetch(void) const
+    {
+        //Read-ahead is dropped in the same way on every process
+        aheadNext = (aheadMax && readable && !cwrote);
+    }
 };
 }}
 #endif
@@ -0,0 +1,122 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief The striped implementation of the Data layer interface
+ *   \details A logical file is stored as several physical part files. The logical file is cut into
+ *   stripe units which are dealt out to the parts in turn, so each part can sit on a different
+ *   storage target and no single file is shared by every process. A small manifest next to the
+ *   logical name lists the stripe unit and the parts so readers can put the file back together.
+ *
+ *   The manifest of the logical file "name" is "name.stripe". It is a text file of the form
+ *   \code
+ *   ExSeisDat stripe
+ *   unit 4194304
+ *   part name.part0
+ *   part name.part1
+ *   \endcode
+ *   Relative part names are relative to the directory of the manifest.
+*//*******************************************************************************************/
+#ifndef PIOLDATASTRIPE_INCLUDE_GUARD
+#define PIOLDATASTRIPE_INCLUDE_GUARD
+#include <mpi.h>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "global.hh"
+#include "data/data.hh"
+#include "data/datampiio.hh"
+
+namespace PIOL { namespace Data {
+/*! \brief The striped Data class. Each part is accessed with independent MPI-IO.
+ */
+class Stripe : public Interface
+{
+    public :
+    /*! \brief The striped options structure. The layout options are only used when a new
+     *  striped file is created, otherwise the layout is taken from the manifest.
+     */
+    struct Opt
+    {
+        typedef Stripe Type;                //!< The Type of the class this structure is nested in
+        size_t nparts;                      //!< The number of parts, named "name.part0" onwards, if parts is empty
+        size_t unit;                        //!< The stripe unit in bytes
+        std::vector<std::string> parts;     //!< The names of the parts, e.g. one for each storage target
+        MPI_Comm fcomm;                     //!< The MPI communicator to use for file access
+        Opt(void);                          //!< The constructor to set default options
+    };
+
+    private :
+    size_t unit;                                    //!< \copydoc Stripe::Opt::unit
+    std::vector<std::shared_ptr<MPIIO>> parts;      //!< The part files
+    MPI_Comm fcomm;                                 //!< \copydoc Stripe::Opt::fcomm
+    bool remove;                                    //!< Whether the manifest is deleted on destruction
+
+    /*! \brief Transfer blocks of the same size. The blocks are cut at the stripe units, pieces
+     *  which follow each other on a part and in memory are merged and the short runs of the same
+     *  size on the same part are transferred together.
+     *  \param[in] write Whether to write
+     *  \param[in] bsz The block size in bytes
+     *  \param[in] nb The number of blocks
+     *  \param[in] off A function which returns the offset in bytes of the ith block
+     *  \param[in, out] d The blocks back to back
+     */
+    void blockIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const;
+
+    /*! \brief Read the manifest on the first process and share it with the others.
+     *  \param[out] pnames The part names
+     *  \return True if the manifest was read
+     */
+    bool readManifest(std::vector<std::string> & pnames);
+
+    /*! \brief The striped Init function.
+     *  \param[in] opt  The striped options
+     *  \param[in] mode The filemode
+     */
+    void Init(const Stripe::Opt & opt, FileMode mode);
+
+    public :
+    /*! \brief The striped class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the logical file.
+     *  \param[in] opt   The striped options
+     *  \param[in] mode The filemode. FileMode::Write and FileMode::Test create a new manifest.
+     */
+    Stripe(const Piol piol_, const std::string name_, const Stripe::Opt & opt, FileMode mode = FileMode::Read);
+
+    /*! \brief The striped class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the logical file.
+     *  \param[in] mode The filemode. FileMode::Write and FileMode::Test create a new manifest.
+     */
+    Stripe(const Piol piol_, const std::string name_, FileMode mode = FileMode::Read);
+
+    ~Stripe(void);
+
+    /*! \brief Find if a logical file name refers to a striped file, i.e if it has a manifest.
+     *  The first process looks for the manifest and shares the answer. This is collective.
+     *  \param[in] piol The PIOL object
+     *  \param[in] name The name of the logical file
+     *  \return True if the manifest exists
+     */
+    static bool isStriped(const Piol piol, const std::string & name);
+
+    size_t getFileSz() const;
+
+    void setFileSz(csize_t sz) const;
+
+    void read(csize_t offset, csize_t sz, uchar * d) const;
+
+    void read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const;
+
+    void read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const;
+
+    void write(csize_t offset, csize_t sz, const uchar * d) const;
+
+    void write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const;
+
+    void write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const;
+};
+}}
+#endif
@@ -0,0 +1,128 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief The two-phase implementation of the Data layer interface
+ *   \details The library performs its own collective buffering instead of leaving it to MPI-IO.
+ *   Each process sends its blocks to an aggregator on the same node. The aggregators split the
+ *   span of the whole request into file domains aligned to the stripe size, exchange the blocks
+ *   so each aggregator holds those of its own domain and then issue large contiguous requests
+ *   with independent MPI-IO. Reads follow the same path in reverse.
+ *
+ *   Every read and write is collective: every process must make the same calls in the same order.
+*//*******************************************************************************************/
+#ifndef PIOLDATATWOPHASE_INCLUDE_GUARD
+#define PIOLDATATWOPHASE_INCLUDE_GUARD
+#include <mpi.h>
+#include <memory>
+#include <vector>
+#include <functional>
+#include "global.hh"
+#include "data/data.hh"
+#include "data/datampiio.hh"
+
+namespace PIOL { namespace Data {
+/*! \brief The two-phase Data class.
+ */
+class TwoPhase : public Interface
+{
+    public :
+    /*! \brief The two-phase options structure.
+     */
+    struct Opt
+    {
+        typedef TwoPhase Type;  //!< The Type of the class this structure is nested in
+        size_t aggPerNode;      //!< The number of aggregators on each node
+        size_t stripe;          //!< The alignment in bytes of file domains, e.g. the stripe size of the file system
+        size_t gap;             //!< Aggregators read blocks separated by at most this many bytes in one request
+        size_t round;           //!< The most bytes a process sends to its aggregator in one round
+        MPI_Comm fcomm;         //!< The MPI communicator to use for file access
+        Opt(void);              //!< The constructor to set default options
+    };
+
+    private :
+    std::unique_ptr<MPIIO> file;    //!< The file, only accessed by aggregators
+    MPI_Comm fcomm;                 //!< \copydoc TwoPhase::Opt::fcomm
+    MPI_Comm gcomm;                 //!< The processes which share an aggregator. The aggregator is rank 0.
+    MPI_Comm acomm;                 //!< The aggregators. MPI_COMM_NULL on other processes.
+    size_t stripe;                  //!< \copydoc TwoPhase::Opt::stripe
+    size_t gap;                     //!< \copydoc TwoPhase::Opt::gap
+    size_t round;                   //!< \copydoc TwoPhase::Opt::round
+
+    /*! \brief Transfer one round of pieces of the file. Collective.
+     *  \param[in] write Whether to write
+     *  \param[in] off The offset in bytes of each piece
+     *  \param[in] len The size in bytes of each piece
+     *  \param[in, out] d The pieces back to back
+     */
+    void exchange(bool write, const std::vector<size_t> & off, const std::vector<size_t> & len, uchar * d) const;
+
+    /*! \brief Transfer the pieces which fall in the file domain of this aggregator.
+     *  \param[in] write Whether to write
+     *  \param[in] off The offset in bytes of each piece
+     *  \param[in] len The size in bytes of each piece
+     *  \param[in, out] d The pieces back to back
+     */
+    void domainIO(bool write, const std::vector<size_t> & off, const std::vector<size_t> & len, uchar * d) const;
+
+    /*! \brief Transfer blocks of the same size in as many rounds as the process with the most
+     *  data needs. Collective.
+     *  \param[in] write Whether to write
+     *  \param[in] bsz The block size in bytes
+     *  \param[in] nb The number of blocks
+     *  \param[in] off A function which returns the offset in bytes of the ith block
+     *  \param[in, out] d The blocks back to back
+     */
+    void blockIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const;
+
+    /*! \brief The two-phase Init function.
+     *  \param[in] opt  The two-phase options
+     *  \param[in] mode The filemode
+     */
+    void Init(const TwoPhase::Opt & opt, FileMode mode);
+
+    public :
+    /*! \brief The two-phase class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] opt   The two-phase options
+     *  \param[in] mode The filemode
+     */
+    TwoPhase(const Piol piol_, const std::string name_, const TwoPhase::Opt & opt, FileMode mode = FileMode::Read);
+
+    /*! \brief The two-phase class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] mode The filemode
+     */
+    TwoPhase(const Piol piol_, const std::string name_, FileMode mode = FileMode::Read);
+
+    ~TwoPhase(void);
+
+    /*! \brief Find if this process is an aggregator.
+     *  \return True if this process accesses the file
+     */
+    bool isAggregator(void) const
+    {
+        return acomm != MPI_COMM_NULL;
+    }
+
+    size_t getFileSz() const;
+
+    void setFileSz(csize_t sz) const;
+
+    void read(csize_t offset, csize_t sz, uchar * d) const;
+
+    void read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const;
+
+    void read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const;
+
+    void write(csize_t offset, csize_t sz, const uchar * d) const;
+
+    void write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const;
+
+    void write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const;
+};
+}}
+#endif
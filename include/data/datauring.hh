@@ -0,0 +1,118 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief The io_uring implementation of the Data layer interface
+ *   \details Each process reads and writes the file through its own Linux io_uring instance with
+ *   many requests in flight. It is meant for node-local storage. There are no collective calls so
+ *   processes do not need to match their calls. If io_uring is not available the same requests are
+ *   made with pread and pwrite.
+*//*******************************************************************************************/
+#ifndef PIOLDATAURING_INCLUDE_GUARD
+#define PIOLDATAURING_INCLUDE_GUARD
+#include <memory>
+#include <vector>
+#include <functional>
+#include "global.hh"
+#include "data/data.hh"
+
+namespace PIOL { namespace Data {
+/*! \brief The io_uring Data class.
+ */
+class URing : public Interface
+{
+    public :
+
+    /*! \brief The io_uring options structure.
+     */
+    struct Opt
+    {
+        typedef URing Type; //!< The Type of the class this structure is nested in
+        size_t depth;       //!< The maximum number of requests in flight. Zero uses pread and pwrite.
+        size_t bufSz;       //!< The size in bytes of each registered buffer. There is one for each request in flight.
+        bool fixed;         //!< Whether requests smaller than bufSz go through registered buffers
+        bool direct;        //!< Whether to bypass the page cache with O_DIRECT. Memory from place() is used without a copy, the unaligned ends go through the registered buffers.
+        size_t align;       //!< The alignment in bytes of O_DIRECT requests
+        Opt(void);          //!< The constructor to set default options
+    };
+
+    private :
+    struct Ring;                //!< The io_uring queues and registered buffers
+
+    int fd;                     //!< The file descriptor
+    int dfd;                    //!< The O_DIRECT file descriptor or -1 if not in use
+    bool remove;                //!< Whether the file is deleted on destruction
+    size_t depth;               //!< \copydoc URing::Opt::depth
+    size_t bufSz;               //!< \copydoc URing::Opt::bufSz
+    bool fixed;                 //!< \copydoc URing::Opt::fixed
+    size_t align;               //!< \copydoc URing::Opt::align
+    std::unique_ptr<Ring> ring; //!< The io_uring instance. Null if io_uring is not available.
+
+    /*! \brief Transfer blocks of the same size. Blocks are split into requests of at most bufSz
+     *  bytes and up to depth requests are kept in flight.
+     *  \param[in] write Whether to write
+     *  \param[in] bsz The block size in bytes
+     *  \param[in] nb The number of blocks
+     *  \param[in] off A function which returns the offset in bytes of the ith block
+     *  \param[in, out] d The blocks back to back
+     */
+    void blockIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const;
+
+    /*! \brief Transfer blocks with pread and pwrite
+     *  \copydetails URing::blockIO
+     */
+    void syncIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const;
+
+    /*! \brief The io_uring Init function.
+     *  \param[in] opt  The io_uring options
+     *  \param[in] mode The filemode
+     */
+    void Init(const URing::Opt & opt, FileMode mode);
+
+    public :
+    /*! \brief The io_uring class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] opt   The io_uring options
+     *  \param[in] mode The filemode
+     */
+    URing(const Piol piol_, const std::string name_, const URing::Opt & opt, FileMode mode = FileMode::Read);
+
+    /*! \brief The io_uring class constructor.
+     *  \param[in] piol_ This PIOL ptr is not modified but is used to instantiate another shared_ptr.
+     *  \param[in] name_ The name of the file associated with the instantiation.
+     *  \param[in] mode The filemode
+     */
+    URing(const Piol piol_, const std::string name_, FileMode mode = FileMode::Read);
+
+    ~URing(void);
+
+    /*! \brief Find if requests go through io_uring rather than pread and pwrite.
+     *  \return True if io_uring is in use.
+     */
+    bool isRing(void) const
+    {
+        return ring != nullptr;
+    }
+
+    size_t getFileSz() const;
+
+    void setFileSz(csize_t sz) const;
+
+    void read(csize_t offset, csize_t sz, uchar * d) const;
+
+    void read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const;
+
+    void read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const;
+
+    void write(csize_t offset, csize_t sz, const uchar * d) const;
+
+    void write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const;
+
+    void write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const;
+
+    uchar * place(csize_t offset, csize_t sz, std::vector<uchar> & buf) const;
+};
+}}
+#endif
@@ -322,6 +322,26 @@ typedef std::unordered_map<Meta, RuleEntry *, EnumHash> RuleMap;    //!< Typedef
 typedef std::unordered_map<Meta, RuleEntry *> RuleMap;              //!< Typedef for the map holding the rules
 #endif
 
+/*! A compiled rule. It describes how to move a single field between the SEG-Y trace header
+ *  and the parameter arrays without a lookup in the rule map.
+ */
+struct RuleOp
+{
+    size_t loc;     //!< The offset of the primary data in the header buffer (relative to Rule::start).
+    size_t num;     //!< The index of the field within a set of parameters of its type.
+    size_t scal;    //!< For floats, the index of the scaler location in RuleProgram::scal.
+};
+
+/*! The rules compiled into flat arrays of operations grouped by type and sorted by location.
+ */
+struct RuleProgram
+{
+    std::vector<RuleOp> lng;    //!< The operations for Long rules.
+    std::vector<RuleOp> shrt;   //!< The operations for Short rules.
+    std::vector<RuleOp> flt;    //!< The operations for Float rules.
+    std::vector<size_t> scal;   //!< The distinct scaler locations of the Float rules (relative to Rule::start).
+};
+
 /*! The structure which holds the rules associated with the trace parameters in a file.
  *  These rules describe how to interpret the metadata and also how to index the parameter structure of arrays.
  */
@@ -338,7 +358,9 @@ struct Rule
     {
         uint32_t badextent; //!< Flag marking if the extent calculation is stale.
         uint32_t fullextent;//!< Flag marking if the full header buffer is processed.
+        uint32_t badprog;   //!< Flag marking if the compiled program is stale.
     } flag;                 //!< State flags
+    RuleProgram prog;       //!< The compiled form of the rules.
 
     /*! The unordered map which stores all current rules.
      *  A map ensures there are no duplicates. */
@@ -420,6 +442,12 @@ struct Rule
      *  \return The associated rule entry.
      */
     RuleEntry * getEntry(Meta entry);
+
+    /*! Get the rules compiled into arrays of operations. The rules are only recompiled
+     *  if they have changed since the last call.
+     *  \return The compiled rules.
+     */
+    const RuleProgram & program(void);
 };
 
 //Access
@@ -456,6 +484,67 @@ T getPrm(size_t i, Meta entry, const Param * prm)
     }
 }
 
+/*! A column view of a single parameter across every set of trace parameters in a parameter
+ *  structure. The rule entry is found once on construction so access does not need a
+ *  lookup in the rule map. If there is no rule for the entry every value is zero.
+ *  \tparam T The type the values are returned as.
+ */
+template <typename T>
+class ParamCol
+{
+    const Param * prm;  //!< The parameter structure.
+    MdType type;        //!< The type of the parameter.
+    size_t num;         //!< The index of the parameter within a set of trace parameters.
+    size_t stride;      //!< The number of parameters of this type per set of trace parameters.
+
+    public :
+    /*! Construct the view.
+     *  \param[in] entry The meta entry to view.
+     *  \param[in] prm_ The parameter structure.
+     */
+    ParamCol(Meta entry, const Param * prm_) : prm(prm_), type(MdType::Copy), num(0U), stride(0U)
+    {
+        Rule * r = prm->r.get();
+        auto it = r->translate.find(entry);
+        if (it != r->translate.end())   //Without a rule every value is zero
+        {
+            type = it->second->type();
+            num = it->second->num;
+            stride = (type == MdType::Float ? r->numFloat : type == MdType::Long ? r->numLong
+                   : type == MdType::Short ? r->numShort : r->numIndex);
+        }
+    }
+
+    /*! Get the value for a trace.
+     *  \param[in] i The trace number.
+     *  \return Return the value.
+     */
+    T operator[](size_t i) const
+    {
+        switch (type)
+        {
+            case MdType::Float :
+                return T(prm->f[stride*i + num]);
+            case MdType::Long :
+                return T(prm->i[stride*i + num]);
+            case MdType::Short :
+                return T(prm->s[stride*i + num]);
+            case MdType::Index :
+                return T(prm->t[stride*i + num]);
+            default :
+                return T(0);
+        }
+    }
+
+    /*! Return the number of traces in the view.
+     *  \return The number of sets of trace parameters.
+     */
+    size_t size(void) const
+    {
+        return prm->size();
+    }
+};
+
 /*! Set the value associated with the particular entry.
  *  \tparam T The type of the value
  *  \param[in] i The trace number
@@ -14,6 +14,8 @@
 
 namespace PIOL { namespace File {
 extern const Param * PARAM_NULL;    //!< The NULL parameter so that the correct internal read pattern is selected
+template <class R> struct StaticParam;
+struct RawParamView;
 /*! \brief The File layer interface. Specific File implementations
  *  work off this base class.
  */
@@ -74,6 +76,32 @@ class ReadInterface
      */
     virtual geom_t readInc(void) const;
 
+    /*! \brief Bound the number of bytes any process transfers in a single call to the underlying storage.
+     *  \param[in] bound The bound in bytes, the same on every process. Zero clears the bound.
+     *  \details Used by IOPlan so the lower layers do not communicate to match their collective calls.
+     */
+    void setBound(csize_t bound) const;
+
+    /*! \brief Hint that the traces from offset to offset+sz will be read soon with readTrace so they
+     *  can be read in the background while the caller does other work.
+     *  \param[in] offset The starting trace number.
+     *  \param[in] sz The number of traces.
+     *  \details With collective I/O every process makes the same number of calls, with sz zero if
+     *  it has nothing to read.
+     */
+    void prefetchTrace(csize_t offset, csize_t sz) const;
+
+    /*! \brief Drop every range hinted with prefetchTrace which has not been read yet.
+     */
+    void dropPrefetch(void) const;
+
+    /*! \brief Declare that every process reads next the traces it hinted with prefetchTrace, so
+     *  the read needs no agreement between the processes.
+     *  \details Every process must make the call together. A process which reads other traces
+     *  still gets them, it reads them alone.
+     */
+    void usePrefetch(void) const;
+
     /*! \brief Read the trace parameters from offset to offset+sz of the respective
      *  trace headers.
      *  \param[in] offset The starting trace number.
@@ -121,6 +149,48 @@ class ReadInterface
      *  \param[in] skip When reading, skip the first "skip" entries of prm
      */
     virtual void readParam(csize_t sz, csize_t * offset, Param * prm, csize_t skip = 0) const = 0;
+
+    /*! \brief Read the raw trace headers from offset to offset+sz. No entries are decoded.
+     *  \param[in] offset The starting trace number.
+     *  \param[in] sz The number of traces to process
+     *  \param[out] prm The view of the raw headers
+     *  \param[in] skip When reading, skip the first "skip" entries of prm
+     *  \details The default implementation reads a parameter structure and encodes it into the headers.
+     */
+    virtual void readParam(csize_t offset, csize_t sz, RawParamView * prm, csize_t skip = 0) const;
+
+    /*! \brief Read the raw trace headers of the traces specified by the offsets in the passed offset array.
+     *  No entries are decoded.
+     *  \param[in] sz The number of traces to process
+     *  \param[in] offset An array of trace numbers to read.
+     *  \param[out] prm The view of the raw headers
+     *  \param[in] skip When reading, skip the first "skip" entries of prm
+     *  \details The default implementation reads a parameter structure and encodes it into the headers.
+     */
+    virtual void readParam(csize_t sz, csize_t * offset, RawParamView * prm, csize_t skip = 0) const;
+
+    /*! \brief Read the trace parameters of a compile-time rule set from offset to offset+sz.
+     *  \tparam R The StaticRule.
+     *  \param[in] offset The starting trace number.
+     *  \param[in] sz The number of traces to process
+     *  \param[out] prm The parameter structure
+     *  \param[in] skip When reading, skip the first "skip" entries of prm
+     *  \details Defined in file/staticrule.hh.
+     */
+    template <class R>
+    void readParam(csize_t offset, csize_t sz, StaticParam<R> * prm, csize_t skip = 0) const;
+
+    /*! \brief Read the trace parameters of a compile-time rule set for the traces specified
+     *  by the offsets in the passed offset array.
+     *  \tparam R The StaticRule.
+     *  \param[in] sz The number of traces to process
+     *  \param[in] offset An array of trace numbers to read.
+     *  \param[out] prm The parameter structure
+     *  \param[in] skip When reading, skip the first "skip" entries of prm
+     *  \details Defined in file/staticrule.hh.
+     */
+    template <class R>
+    void readParam(csize_t sz, csize_t * offset, StaticParam<R> * prm, csize_t skip = 0) const;
 };
 
 /*! \brief The File layer interface. Specific File implementations
@@ -175,6 +245,12 @@ class WriteInterface
      */
     virtual void writeInc(const geom_t inc_) = 0;
 
+    /*! \brief Bound the number of bytes any process transfers in a single call to the underlying storage.
+     *  \param[in] bound The bound in bytes, the same on every process. Zero clears the bound.
+     *  \details Used by IOPlan so the lower layers do not communicate to match their collective calls.
+     */
+    void setBound(csize_t bound) const;
+
     /*! \brief Write the trace parameters from offset to offset+sz to the respective
      *  trace headers.
      *  \param[in] offset The starting trace number.
@@ -194,7 +270,7 @@ class WriteInterface
      *  \param[in] prm A contiguous array of the parameter structures (size sizeof(Param)*sz)
      *  \param[in] skip When writing, skip the first "skip" entries of prm
      */
-    virtual void writeTrace(csize_t offset, csize_t sz, trace_t * trace, const Param * prm = PARAM_NULL, csize_t skip = 0) = 0;
+    virtual void writeTrace(csize_t offset, csize_t sz, const trace_t * trace, const Param * prm = PARAM_NULL, csize_t skip = 0) = 0;
 
     /*! \brief Write the traces specified by the offsets in the passed offset array.
      *  \param[in] sz The number of traces to process
@@ -207,7 +283,7 @@ class WriteInterface
      *  It is assumed that the parameter writing operation is not an update. Any previous
      *  contents of the trace header will be overwritten.
      */
-    virtual void writeTrace(csize_t sz, csize_t * offset, trace_t * trace, const Param * prm = PARAM_NULL, csize_t skip = 0) = 0;
+    virtual void writeTrace(csize_t sz, csize_t * offset, const trace_t * trace, const Param * prm = PARAM_NULL, csize_t skip = 0) = 0;
 
     /*! \brief Write the traces specified by the offsets in the passed offset array.
      *  \param[in] sz The number of traces to process
@@ -219,6 +295,12 @@ class WriteInterface
      *  contents of the trace header will be overwritten.
      */
     virtual void writeParam(csize_t sz, csize_t * offset, const Param * prm, csize_t skip = 0) = 0;
+
+    /*! \brief Write any writes the file has held back.
+     *  \details This is collective. Reads of the file through other objects do not see held back
+     *  writes until they are flushed.
+     */
+    virtual void flush(void) { }
 };
 }}
 #endif
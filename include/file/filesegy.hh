@@ -74,9 +74,15 @@ class ReadSEGY : public ReadInterface
 
     void readTraceNonMono(csize_t sz, csize_t * offset, trace_t * trace, Param * prm, csize_t skip) const;
 
+    using ReadInterface::readParam;
+
     void readParam(csize_t offset, csize_t sz, Param * prm, csize_t skip) const;
 
     void readParam(csize_t sz, csize_t * offset, Param * prm, csize_t skip) const;
+
+    void readParam(csize_t offset, csize_t sz, RawParamView * prm, csize_t skip) const;
+
+    void readParam(csize_t sz, csize_t * offset, RawParamView * prm, csize_t skip) const;
 };
 /*! The SEG-Y implementation of the file layer
  */
@@ -89,6 +95,14 @@ class WriteSEGY : public WriteInterface
     {
         typedef WriteSEGY Type; //!< The Type of the class this structure is nested in
         unit_t incFactor;       //!< The increment factor to multiply inc by (default to SEG-Y rev 1 standard definition)
+        size_t scratchMax;      //!< The largest scratch buffer (in bytes) which is kept between writes
+        /*! The most bytes of held back writes per process. Zero disables write-behind. With
+         *  write-behind every process must make the same write calls. The held back writes are
+         *  written with blocking calls, so this merges small writes rather than overlapping them
+         *  with other work. A multiple of the file system stripe gives stripe sized writes.
+         */
+        size_t behindMax;
+        size_t behindCalls;     //!< The most write calls held back, zero for no limit. This needs no communication.
 
         /*! Constructor which provides the default Rules
          */
@@ -96,7 +110,61 @@ class WriteSEGY : public WriteInterface
     };
 
     private :
+    /*! The part of the data-objects a held back write covers
+     */
+    enum class Part : size_t
+    {
+        DO,                     //!< Whole data-objects
+        DF,                     //!< The trace samples only
+        MD                      //!< The trace headers only
+    };
+
+    /*! The writes of this process which are not yet passed to the object layer
+     */
+    struct Behind
+    {
+        Part part;                                      //!< The part of the data-objects held
+        size_t ns;                                      //!< The number of samples per trace when the writes were held
+        size_t calls;                                   //!< The number of write calls held, the same on every process
+        std::vector<std::pair<size_t, size_t>> runs;    //!< The first trace and number of traces of each contiguous run
+        std::vector<uchar> d;                           //!< The held back bytes of the runs back to back, as they are to be written
+    };
+
     Format format;              //<! Type formats
+    std::vector<uchar> scratch; //!< Scratch buffer the traces are converted into before being written
+    size_t scratchMax;          //!< The largest scratch buffer (in bytes) which is kept between writes
+    Behind behind;              //!< The held back writes
+    size_t behindMax;           //!< \copydoc WriteSEGY::Opt::behindMax
+    size_t behindCalls;         //!< \copydoc WriteSEGY::Opt::behindCalls
+
+    /*! Get the scratch buffer with at least the given size.
+     *  \param[in] sz The number of bytes required
+     *  \return A pointer to the scratch buffer
+     */
+    uchar * getScratch(csize_t sz);
+
+    /*! Release the scratch buffer if it is larger than the bound given in the options.
+     */
+    void trimScratch(void);
+
+    /*! Find room in the write-behind buffer for a contiguous run of traces. The held back writes
+     *  are written first once the buffer holds behindCalls calls, the run covers another part of
+     *  the data-objects, or the run would take the buffer of any process past behindMax. The
+     *  processes agree on the last with a single reduction. A run which on its own would pass
+     *  behindMax on any process is not held back.
+     *  \param[in] part The part of the data-objects to be written
+     *  \param[in] offset The first trace of the run
+     *  \param[in] sz The number of traces in the run
+     *  \param[in] tsz The number of bytes per trace
+     *  \param[out] d A pointer to the room in the buffer for the run
+     *  \return Return true if the run is held back, false if it is to be written directly
+     */
+    bool holdBack(const Part part, csize_t offset, csize_t sz, csize_t tsz, uchar ** d);
+
+    /*! Pass the held back writes of every process to the object layer, one write per run. This
+     *  is collective.
+     */
+    void writeBehind(void);
 
     /*! State flags structure for SEGY
      */
@@ -152,13 +220,15 @@ class WriteSEGY : public WriteInterface
 
     void writeInc(const geom_t inc_);
 
-    void writeTrace(csize_t offset, csize_t sz, trace_t * trace, const Param * prm, csize_t skip);
+    void writeTrace(csize_t offset, csize_t sz, const trace_t * trace, const Param * prm, csize_t skip);
 
-    void writeTrace(csize_t sz, csize_t * offset, trace_t * trace, const Param * prm, csize_t skip);
+    void writeTrace(csize_t sz, csize_t * offset, const trace_t * trace, const Param * prm, csize_t skip);
 
     void writeParam(csize_t offset, csize_t sz, const Param * prm, csize_t skip);
 
     void writeParam(csize_t sz, csize_t * offset, const Param * prm, csize_t skip);
+
+    void flush(void);
 };
 }}
 #endif
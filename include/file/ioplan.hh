@@ -0,0 +1,80 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date October 2016
+ *   \brief Plans for batched collective I/O.
+ *   \details Collective I/O requires every process to make the same number of calls in the same
+ *   sequence. An IOPlan agrees on the number of rounds of a batched operation once, when it is
+ *   built, and bounds the size of each transfer of the files it covers so the lower layers do not
+ *   need to communicate to match their calls.
+ *//*******************************************************************************************/
+#ifndef PIOLFILEIOPLAN_INCLUDE_GUARD
+#define PIOLFILEIOPLAN_INCLUDE_GUARD
+#include <functional>
+#include <vector>
+#include "global.hh"
+#include "file/file.hh"
+
+namespace PIOL { namespace File {
+/*! A plan for a batched collective operation over the local items of each process.
+ */
+class IOPlan
+{
+    ExSeisPIOL * piol;                              //!< The PIOL object.
+    size_t lnt;                                     //!< The number of local items.
+    size_t max;                                     //!< The maximum number of items per round on this process.
+    size_t gmax;                                    //!< The maximum number of items per round on any process.
+    size_t nround;                                  //!< The number of rounds every process runs.
+    std::vector<std::function<void(csize_t)>> fbound;    //!< Functions to set the bound of each file in the plan.
+    std::vector<size_t> isz;                        //!< The bytes per item of each file in the plan.
+    std::vector<std::function<void(size_t, size_t)>> fahead;  //!< Functions to read the items of a round ahead.
+    std::vector<std::function<void(void)>> fdrop;   //!< Functions to drop what is left read ahead once the plan has run.
+    std::vector<std::function<void(void)>> fuse;    //!< Functions to serve the next read of a round from what was read ahead.
+
+    public :
+    /*! Build the plan. This is collective and is the only communication the plan does.
+     *  \param[in] piol_ The PIOL object.
+     *  \param[in] lnt_ The number of local items.
+     *  \param[in] max_ The maximum number of items to process per round.
+     */
+    IOPlan(ExSeisPIOL * piol_, csize_t lnt_, csize_t max_);
+
+    /*! Add an input file to the plan.
+     *  \param[in] f The file.
+     *  \param[in] isz_ The maximum number of bytes a single call transfers per item.
+     */
+    void add(const ReadInterface * f, csize_t isz_);
+
+    /*! Add an output file to the plan.
+     *  \param[in] f The file.
+     *  \param[in] isz_ The maximum number of bytes a single call transfers per item.
+     */
+    void add(const WriteInterface * f, csize_t isz_);
+
+    /*! Read the traces of each round of an input file ahead, while the previous round is processed.
+     *  The traces of a round are those from offset plus the local offset of the round. The Data layer
+     *  bounds the number of rounds in flight, see Data::MPIIO::Opt::ahead. The first read of the file
+     *  in each round is served from what was read ahead without the processes agreeing on it.
+     *  Whatever is left read ahead is dropped once the plan has run.
+     *  \param[in] f The file.
+     *  \param[in] offset The trace number of the first local item.
+     */
+    void readAhead(const ReadInterface * f, csize_t offset);
+
+    /*! Return the number of rounds every process runs.
+     *  \return The number of rounds.
+     */
+    size_t rounds(void) const
+    {
+        return nround;
+    }
+
+    /*! Run every round of the plan. Rounds after the local items are exhausted have zero items so
+     *  the same code makes the matching collective calls.
+     *  \param[in] fn The function run each round with the local offset of the first item and the number of items.
+     */
+    void run(std::function<void(size_t, size_t)> fn) const;
+};
+}}
+#endif
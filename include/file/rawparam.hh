@@ -0,0 +1,179 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date October 2016
+ *   \brief A lazy view of trace parameters over the raw SEG-Y trace headers.
+ *   \details The trace headers are kept exactly as they were read from the file and an entry is
+ *   only decoded when it is accessed. Work which only touches one or two entries of a large
+ *   number of traces does not pay for decoding or storing every entry of the rules.
+ *//*******************************************************************************************/
+#ifndef PIOLFILERAWPARAM_INCLUDE_GUARD
+#define PIOLFILERAWPARAM_INCLUDE_GUARD
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "global.hh"
+#include "file/dynsegymd.hh"
+#include "file/segymd.hh"
+#include "share/datatype.hh"
+#include "share/segy.hh"
+
+namespace PIOL { namespace File {
+/*! The trace parameters of a set of traces as raw SEG-Y trace headers. The rules describe which
+ *  entries are present and where they are in each header.
+ */
+struct RawParamView
+{
+    std::vector<uchar> md;    //!< The full trace headers, SEGSz::getMDSz() bytes for each set.
+    std::shared_ptr<Rule> r;  //!< The rules which describe the entries of the headers.
+    size_t sz;                //!< The number of sets of trace parameters.
+
+    /*! Allocate the space for the trace headers and store the rules.
+     *  \param[in] r_ The rules which describe the entries of the headers.
+     *  \param[in] sz_ The number of sets of trace parameters.
+     */
+    RawParamView(std::shared_ptr<Rule> r_, csize_t sz_) : md(SEGSz::getMDSz() * sz_), r(r_), sz(sz_) { }
+
+    /*! Return the number of sets of trace parameters.
+     *  \return Number of sets
+     */
+    size_t size(void) const
+    {
+        return sz;
+    }
+
+    /*! Get the raw trace header of a set of trace parameters.
+     *  \param[in] i The set of trace parameters.
+     *  \return A pointer to the start of the header.
+     */
+    uchar * data(csize_t i = 0U)
+    {
+        return md.data() + i * SEGSz::getMDSz();
+    }
+
+    /*! \overload
+     *  \brief Get the raw trace header of a set of trace parameters.
+     *  \param[in] i The set of trace parameters.
+     *  \return A pointer to the start of the header.
+     */
+    const uchar * data(csize_t i = 0U) const
+    {
+        return md.data() + i * SEGSz::getMDSz();
+    }
+
+    /*! Decode every entry of the rules into a parameter structure.
+     *  \param[in] skip The first set of trace parameters of the view to decode.
+     *  \param[in] n The number of sets to decode.
+     *  \param[out] prm The parameter structure. It must use the same rules as the view.
+     *  \param[in] pskip Skip the first "pskip" entries when filling prm.
+     */
+    void toParam(csize_t skip, csize_t n, Param * prm, csize_t pskip = 0U) const
+    {
+        extractParam(n, data(skip), prm, SEGSz::getMDSz() - r->extent(), pskip);
+    }
+};
+
+/*! A column view of a single entry across every set of trace parameters of a RawParamView.
+ *  The rule entry is found once on construction and values are decoded from the raw headers
+ *  on access. If there is no rule for the entry every value is zero.
+ *  \tparam T The type the values are returned as.
+ */
+template <typename T>
+class RawParamCol
+{
+    const RawParamView * prm;   //!< The view of the raw headers.
+    MdType type;                //!< The type of the entry.
+    size_t loc;                 //!< The byte offset of the entry in a header.
+    size_t scalLoc;             //!< The byte offset of the scaler of a float entry in a header.
+
+    public :
+    /*! Construct the column view.
+     *  \param[in] entry The meta entry to view.
+     *  \param[in] prm_ The view of the raw headers.
+     */
+    RawParamCol(Meta entry, const RawParamView * prm_) : prm(prm_), type(MdType::Copy), loc(0U), scalLoc(0U)
+    {
+        Rule * r = prm->r.get();
+        auto it = r->translate.find(entry);
+        if (it != r->translate.end() && it->second != nullptr)
+        {
+            type = it->second->type();
+            loc = it->second->loc - 1U;
+            if (type == MdType::Float)
+                scalLoc = static_cast<SEGYFloatRuleEntry *>(it->second)->scalLoc - 1U;
+        }
+    }
+
+    /*! Decode the value for a trace.
+     *  \param[in] i The trace number.
+     *  \return Return the value.
+     */
+    T operator[](size_t i) const
+    {
+        const uchar * md = prm->data(i);
+        switch (type)
+        {
+            case MdType::Float :
+                return T(scaleConv(getHost<int16_t>(&md[scalLoc])) * geom_t(getHost<int32_t>(&md[loc])));
+            case MdType::Long :
+                return T(getHost<int32_t>(&md[loc]));
+            case MdType::Short :
+                return T(getHost<int16_t>(&md[loc]));
+            default :
+                return T(0);
+        }
+    }
+
+    /*! Decode the values of a range of traces into an array.
+     *  \param[in] skip The first trace to decode.
+     *  \param[in] n The number of traces to decode.
+     *  \param[out] col The array to fill with n values.
+     */
+    void decode(csize_t skip, csize_t n, T * col) const
+    {
+        const uchar * md = prm->data(skip);
+        csize_t step = SEGSz::getMDSz();
+        switch (type)
+        {
+            case MdType::Float :
+                for (size_t i = 0; i < n; i++)
+                    col[i] = T(scaleConv(getHost<int16_t>(&md[i*step + scalLoc])) * geom_t(getHost<int32_t>(&md[i*step + loc])));
+            break;
+            case MdType::Long :
+                for (size_t i = 0; i < n; i++)
+                    col[i] = T(getHost<int32_t>(&md[i*step + loc]));
+            break;
+            case MdType::Short :
+                for (size_t i = 0; i < n; i++)
+                    col[i] = T(getHost<int16_t>(&md[i*step + loc]));
+            break;
+            default :
+                std::fill(col, col + n, T(0));
+            break;
+        }
+    }
+
+    /*! Return the number of traces in the view.
+     *  \return The number of sets of trace parameters.
+     */
+    size_t size(void) const
+    {
+        return prm->size();
+    }
+};
+
+/*! Decode the value of a single entry from the raw headers.
+ *  \tparam T The type of the value
+ *  \param[in] i The trace number
+ *  \param[in] entry The meta entry to retrieve.
+ *  \param[in] prm The view of the raw headers
+ *  \return Return the value associated with the entry
+ */
+template <typename T>
+T getPrm(size_t i, Meta entry, const RawParamView * prm)
+{
+    return RawParamCol<T>(entry, prm)[i];
+}
+}}
+#endif
@@ -0,0 +1,310 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date October 2016
+ *   \brief Compile-time rule sets for fixed SEG-Y trace header layouts.
+ *   \details A StaticRule is the compile-time counterpart of Rule for a fixed list of Meta
+ *   entries at their default SEG-Y locations. The locations, types and scaler locations are
+ *   known at compile time so the header decoders are specialised for the list of entries and
+ *   need no rule lookups. The parameters are stored in a StaticParam with one contiguous
+ *   column per entry.
+ *//*******************************************************************************************/
+#ifndef PIOLFILESTATICRULE_INCLUDE_GUARD
+#define PIOLFILESTATICRULE_INCLUDE_GUARD
+#include <vector>
+#include <initializer_list>
+#include <type_traits>
+#include "global.hh"
+#include "file/file.hh"
+#include "file/dynsegymd.hh"
+#include "object/object.hh"
+#include "share/datatype.hh"
+#include "share/segy.hh"
+
+namespace PIOL { namespace File {
+/*! The default SEG-Y layout of a Meta entry. Only entries with a default location are defined.
+ *  \tparam M The Meta entry.
+ */
+template <Meta M>
+struct SEGYField;
+
+/*! The definition of a SEG-Y layout.
+ *  \tparam T The type of the entry.
+ *  \tparam L The location of the primary data.
+ *  \tparam S The location of the scaler. Only used for floats.
+ */
+template <MdType T, Tr L, Tr S = L>
+struct SEGYFieldDef
+{
+    static constexpr MdType type = T;               //!< The type of the entry.
+    static constexpr size_t loc = size_t(L);        //!< The location of the primary data.
+    static constexpr size_t scalLoc = size_t(S);    //!< The location of the scaler.
+};
+
+//The same defaults as Rule(std::initializer_list<Meta>)
+template <> struct SEGYField<Meta::WtrDepSrc> : SEGYFieldDef<MdType::Float, Tr::WtrDepSrc, Tr::ScaleElev> { };
+template <> struct SEGYField<Meta::WtrDepRcv> : SEGYFieldDef<MdType::Float, Tr::WtrDepRcv, Tr::ScaleElev> { };
+template <> struct SEGYField<Meta::xSrc> : SEGYFieldDef<MdType::Float, Tr::xSrc, Tr::ScaleCoord> { };
+template <> struct SEGYField<Meta::ySrc> : SEGYFieldDef<MdType::Float, Tr::ySrc, Tr::ScaleCoord> { };
+template <> struct SEGYField<Meta::xRcv> : SEGYFieldDef<MdType::Float, Tr::xRcv, Tr::ScaleCoord> { };
+template <> struct SEGYField<Meta::yRcv> : SEGYFieldDef<MdType::Float, Tr::yRcv, Tr::ScaleCoord> { };
+template <> struct SEGYField<Meta::xCmp> : SEGYFieldDef<MdType::Float, Tr::xCmp, Tr::ScaleCoord> { };
+template <> struct SEGYField<Meta::yCmp> : SEGYFieldDef<MdType::Float, Tr::yCmp, Tr::ScaleCoord> { };
+template <> struct SEGYField<Meta::il> : SEGYFieldDef<MdType::Long, Tr::il> { };
+template <> struct SEGYField<Meta::xl> : SEGYFieldDef<MdType::Long, Tr::xl> { };
+template <> struct SEGYField<Meta::Offset> : SEGYFieldDef<MdType::Long, Tr::CDist> { };
+template <> struct SEGYField<Meta::tn> : SEGYFieldDef<MdType::Long, Tr::SeqFNum> { };
+
+/*! The host type used to store each type of entry.
+ *  \tparam T The type of the entry.
+ */
+template <MdType T> struct MdStore;
+template <> struct MdStore<MdType::Float> { typedef geom_t Type; };   //!< Floats are stored as geom_t
+template <> struct MdStore<MdType::Long> { typedef llint Type; };     //!< Longs are stored as llint
+template <> struct MdStore<MdType::Short> { typedef int16_t Type; };  //!< Shorts are stored as int16_t
+
+/*! A set of rules fixed at compile time.
+ *  \tparam M The Meta entries. Each must have a SEGYField definition.
+ */
+template <Meta... M>
+struct StaticRule
+{
+    static_assert(sizeof...(M) > 0U, "A StaticRule requires at least one entry");
+
+    /*! Count the entries of a given type.
+     *  \tparam T The type
+     *  \return The number of entries of type T.
+     */
+    template <MdType T>
+    static constexpr size_t count(void)
+    {
+        const MdType type[] = {SEGYField<M>::type...};
+        size_t n = 0U;
+        for (size_t j = 0U; j < sizeof...(M); j++)
+            n += (type[j] == T);
+        return n;
+    }
+
+    /*! Check if an entry is in the rule set.
+     *  \tparam E The Meta entry
+     *  \return True if the entry is in the rule set.
+     */
+    template <Meta E>
+    static constexpr bool contains(void)
+    {
+        const Meta meta[] = {M...};
+        for (size_t j = 0U; j < sizeof...(M); j++)
+            if (meta[j] == E)
+                return true;
+        return false;
+    }
+
+    /*! The index of an entry among the entries of the same type.
+     *  \tparam E The Meta entry
+     *  \return The index.
+     */
+    template <Meta E>
+    static constexpr size_t index(void)
+    {
+        const Meta meta[] = {M...};
+        const MdType type[] = {SEGYField<M>::type...};
+        size_t n = 0U;
+        for (size_t j = 0U; j < sizeof...(M) && meta[j] != E; j++)
+            n += (type[j] == SEGYField<E>::type);
+        return n;
+    }
+
+    static constexpr size_t numFloat = count<MdType::Float>();   //!< Number of float rules.
+    static constexpr size_t numLong = count<MdType::Long>();     //!< Number of long rules.
+    static constexpr size_t numShort = count<MdType::Short>();   //!< Number of short rules.
+
+    /*! How much memory will each set of parameters require?
+     *  \return Amount of memory in bytes.
+     */
+    static constexpr size_t paramMem(void)
+    {
+        return numFloat * sizeof(geom_t) + numLong * sizeof(llint) + numShort * sizeof(int16_t);
+    }
+};
+
+/*! The parameter structure of a StaticRule. Each entry is stored in its own contiguous column.
+ *  \tparam R The StaticRule.
+ */
+template <class R>
+struct StaticParam
+{
+    std::vector<geom_t> f;    //!< Floating point columns.
+    std::vector<llint> i;     //!< Integer columns.
+    std::vector<int16_t> s;   //!< Short columns.
+    size_t sz;                //!< The number of sets of trace parameters.
+
+    /*! Allocate the space for the columns.
+     *  \param[in] sz_ The number of sets of trace parameters.
+     */
+    StaticParam(csize_t sz_) : f(R::numFloat * sz_), i(R::numLong * sz_), s(R::numShort * sz_), sz(sz_) { }
+
+    /*! Return the number of sets of trace parameters.
+     *  \return Number of sets
+     */
+    size_t size(void) const
+    {
+        return sz;
+    }
+
+    /*! Get the column of an entry.
+     *  \tparam E The Meta entry
+     *  \return A pointer to the first value of the column.
+     */
+    template <Meta E>
+    typename MdStore<SEGYField<E>::type>::Type * get(void)
+    {
+        static_assert(R::template contains<E>(), "The entry is not in the StaticRule");
+        return column(std::integral_constant<MdType, SEGYField<E>::type>()) + R::template index<E>() * sz;
+    }
+
+    /*! Get a value of an entry.
+     *  \tparam E The Meta entry
+     *  \param[in] j The set of trace parameters.
+     *  \return The value
+     */
+    template <Meta E>
+    typename MdStore<SEGYField<E>::type>::Type get(csize_t j)
+    {
+        return get<E>()[j];
+    }
+
+    private :
+    /*! Get the float columns
+     *  \return A pointer to the float columns
+     */
+    geom_t * column(std::integral_constant<MdType, MdType::Float>)
+    {
+        return f.data();
+    }
+
+    /*! Get the long columns
+     *  \return A pointer to the long columns
+     */
+    llint * column(std::integral_constant<MdType, MdType::Long>)
+    {
+        return i.data();
+    }
+
+    /*! Get the short columns
+     *  \return A pointer to the short columns
+     */
+    int16_t * column(std::integral_constant<MdType, MdType::Short>)
+    {
+        return s.data();
+    }
+};
+
+/*! Decode an entry from a series of trace headers into its column.
+ *  \tparam R The StaticRule.
+ *  \tparam E The Meta entry.
+ *  \param[in] sz The number of trace headers.
+ *  \param[in] buf The buffer holding the trace headers.
+ *  \param[in] step The distance in bytes between each trace header.
+ *  \param[out] prm The parameter structure.
+ *  \param[in] skip Skip the first "skip" entries of prm.
+ *  \details The final parameter is a tag for a float entry.
+ */
+template <class R, Meta E>
+void extractField(csize_t sz, const uchar * buf, csize_t step, StaticParam<R> * prm, csize_t skip,
+                  std::integral_constant<MdType, MdType::Float>)
+{
+    geom_t * col = prm->template get<E>() + skip;
+    for (size_t i = 0; i < sz; i++)
+    {
+        int16_t scal = getHost<int16_t>(&buf[step * i + SEGYField<E>::scalLoc - 1U]);
+        scal = (!scal ? 1 : scal);
+        col[i] = (scal > 0 ? geom_t(scal) : geom_t(1) / geom_t(-scal)) * geom_t(getHost<int32_t>(&buf[step * i + SEGYField<E>::loc - 1U]));
+    }
+}
+
+/*! \overload
+ *  \brief Decode a long entry from a series of trace headers into its column.
+ *  \tparam R The StaticRule.
+ *  \tparam E The Meta entry.
+ *  \param[in] sz The number of trace headers.
+ *  \param[in] buf The buffer holding the trace headers.
+ *  \param[in] step The distance in bytes between each trace header.
+ *  \param[out] prm The parameter structure.
+ *  \param[in] skip Skip the first "skip" entries of prm.
+ *  \details The final parameter is a tag for a long entry.
+ */
+template <class R, Meta E>
+void extractField(csize_t sz, const uchar * buf, csize_t step, StaticParam<R> * prm, csize_t skip,
+                  std::integral_constant<MdType, MdType::Long>)
+{
+    llint * col = prm->template get<E>() + skip;
+    for (size_t i = 0; i < sz; i++)
+        col[i] = getHost<int32_t>(&buf[step * i + SEGYField<E>::loc - 1U]);
+}
+
+/*! \overload
+ *  \brief Decode a short entry from a series of trace headers into its column.
+ *  \tparam R The StaticRule.
+ *  \tparam E The Meta entry.
+ *  \param[in] sz The number of trace headers.
+ *  \param[in] buf The buffer holding the trace headers.
+ *  \param[in] step The distance in bytes between each trace header.
+ *  \param[out] prm The parameter structure.
+ *  \param[in] skip Skip the first "skip" entries of prm.
+ *  \details The final parameter is a tag for a short entry.
+ */
+template <class R, Meta E>
+void extractField(csize_t sz, const uchar * buf, csize_t step, StaticParam<R> * prm, csize_t skip,
+                  std::integral_constant<MdType, MdType::Short>)
+{
+    int16_t * col = prm->template get<E>() + skip;
+    for (size_t i = 0; i < sz; i++)
+        col[i] = getHost<int16_t>(&buf[step * i + SEGYField<E>::loc - 1U]);
+}
+
+/*! Extract the parameters of a StaticRule from a buffer of SEG-Y trace headers.
+ *  \tparam M The Meta entries of the StaticRule.
+ *  \param[in] sz The number of sets of parameters
+ *  \param[in] buf The buffer of trace headers (full extent)
+ *  \param[out] prm The parameter structure
+ *  \param[in] stride The stride to use between adjacent blocks in the input buffer.
+ *  \param[in] skip Skip the first "skip" entries when filling Param
+ */
+template <Meta... M>
+void extractParam(size_t sz, const uchar * buf, StaticParam<StaticRule<M...>> * prm, size_t stride = 0U, size_t skip = 0U)
+{
+    if (prm == nullptr)
+        return;
+    csize_t step = SEGSz::getMDSz() + stride;
+    (void)std::initializer_list<int>{(extractField<StaticRule<M...>, M>(sz, buf, step, prm, skip,
+                                         std::integral_constant<MdType, SEGYField<M>::type>()), 0)...};
+}
+
+template <class R>
+void ReadInterface::readParam(csize_t offset, csize_t sz, StaticParam<R> * prm, csize_t skip) const
+{
+    //Don't process beyond end of file if we can
+    size_t ntz = (!sz || offset >= nt ? 0U : (offset + sz > nt ? nt - offset : sz));
+
+    std::vector<uchar> buf(SEGSz::getMDSz() * ntz);
+    obj->readDOMD(offset, ns, ntz, buf.data());
+
+    if (ntz)
+        extractParam(ntz, buf.data(), prm, 0U, skip);
+}
+
+template <class R>
+void ReadInterface::readParam(csize_t sz, csize_t * offset, StaticParam<R> * prm, csize_t skip) const
+{
+    if (!sz)
+        obj->readDOMD(0, 0, nullptr, nullptr);
+    else
+    {
+        std::vector<uchar> buf(SEGSz::getMDSz() * sz);
+        obj->readDOMD(ns, sz, offset, buf.data());
+        extractParam(sz, buf.data(), prm, 0U, skip);
+    }
+}
+}}
+#endif
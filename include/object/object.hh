@@ -46,6 +46,37 @@ class Interface
      */
     virtual void setFileSz(csize_t sz) const;
 
+    /*! \brief Bound the number of bytes any process transfers in a single Data layer call.
+     *  \param[in] bound The bound in bytes, the same on every process. Zero clears the bound.
+     */
+    virtual void setBound(csize_t bound) const;
+
+    /*! \brief Hint that a sequence of data-objects will be read soon so the Data layer can read
+     *  them in the background. By default nothing is done.
+     *  \param[in] offset The starting data-object we are interested in.
+     *  \param[in] ns The number of elements per data field.
+     *  \param[in] sz The number of data-objects to be read in a row.
+     */
+    virtual void prefetchDO(csize_t offset, csize_t ns, csize_t sz) const;
+
+    /*! \brief Drop every range hinted with prefetchDO which has not been read yet.
+     */
+    virtual void dropPrefetch(void) const;
+
+    /*! \brief Declare that every process serves its next read from the ranges hinted with
+     *  prefetchDO. See Data::Interface::usePrefetch.
+     */
+    virtual void usePrefetch(void) const;
+
+    /*! \brief Get memory for a transfer of a range of the file, placed so the Data layer can move
+     *  the range without a copy.
+     *  \param[in] offset The offset in bytes of the range
+     *  \param[in] sz     The size in bytes of the range
+     *  \param[in, out] buf The buffer which holds the memory. It grows if it is too small.
+     *  \return A pointer into buf to sz bytes for the range
+     */
+    virtual uchar * place(csize_t offset, csize_t sz, std::vector<uchar> & buf) const;
+
     /*! \brief Read the header object.
      *  \param[out] ho An array which the caller guarantees is long enough
      *  to hold the header object.
@@ -60,6 +60,8 @@ class SEGY : public Interface
 
     void readDO(csize_t offset, csize_t ns, csize_t sz, uchar * d) const;
 
+    void prefetchDO(csize_t offset, csize_t ns, csize_t sz) const;
+
     void writeDO(csize_t offset, csize_t ns, csize_t sz, const uchar * d) const;
 
     void readDO(csize_t ns, csize_t sz, csize_t * offset, uchar * d) const;
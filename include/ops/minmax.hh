@@ -18,6 +18,14 @@ namespace PIOL { namespace File {
 template <typename T>
 using Func = std::function<geom_t(const T &)>;  //!< Return the value associated with a particular parameter
 
+/*! A flat record of the pair of values for a trace used by the min/max operation.
+ */
+struct CoordPair
+{
+    geom_t x;   //!< The first value.
+    geom_t y;   //!< The second value.
+};
+
 /*! Get the min and max for a parameter. Use a second parameter to decide between equal cases.
  * \tparam T The type of the input array
  * \param[in] piol The PIOL object
@@ -3,12 +3,19 @@
  *   \author Cathal O Broin - cathal@ichec.ie - first commit
  *   \copyright TBD. Do not distribute
  *   \date November 2016
- *   \brief
+ *   \brief The Sort Operation
+ *   \details The distributed sort is a sample sort. The templates here are shared by the
+ *   parameter sort and the key sorts built on the fixed-width \c SortKey records.
 *//*******************************************************************************************/
 #ifndef PIOLOPSSORT_INCLUDE_GUARD
 #define PIOLOPSSORT_INCLUDE_GUARD
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <functional>
 #include "global.hh"
 #include "share/param.hh"
+#include "share/mpi.hh"
 
 namespace PIOL { namespace File {
 /*! A template for the Compare less-than function
@@ -16,9 +23,356 @@ namespace PIOL { namespace File {
 template <class T>
 using Compare = std::function<bool(const T &, const T &)>;
 
+/*! A function which sorts the parameters of the local traces and returns the list described by
+ *  the parameter sort below (with FileOrder set to true).
+ */
+typedef std::function<std::vector<size_t>(ExSeisPIOL *, Param *)> SortFunc;
+
+/*! A fixed-width sort key. The key words are compared in order so the first word is the
+ *  most significant. Values are mapped to the key words so that unsigned integer order
+ *  matches the order of the original values.
+ *  \tparam N The number of key words.
+ */
+template <size_t N>
+struct SortKey
+{
+    uint64_t k[N];  //!< The key words, most significant first.
+    size_t gtn;     //!< The global trace number associated with the key.
+};
+
+/*! Less-than operator for sort keys.
+ *  \tparam N The number of key words.
+ *  \param[in] a The left operand.
+ *  \param[in] b The right operand.
+ *  \return Return true if \c a is less than \c b.
+ */
+template <size_t N>
+bool operator<(const SortKey<N> & a, const SortKey<N> & b)
+{
+    for (size_t i = 0; i < N; i++)
+        if (a.k[i] != b.k[i])
+            return a.k[i] < b.k[i];
+    return false;
+}
+
+/*! Map a floating point value to an unsigned integer with the same ordering.
+ *  \param[in] v The value.
+ *  \return The key word.
+ */
+inline uint64_t encodeKey(geom_t v)
+{
+    static_assert(sizeof(geom_t) == sizeof(uint64_t), "The key encoding assumes a 64-bit geom_t.");
+    v += geom_t(0);     //Negative zero compares equal to zero
+    uint64_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    return (u >> 63U ? ~u : u | (uint64_t(1) << 63U));
+}
+
+/*! Map a signed integer to an unsigned integer with the same ordering.
+ *  \param[in] v The value.
+ *  \return The key word.
+ */
+inline uint64_t encodeKey(llint v)
+{
+    return uint64_t(v) ^ (uint64_t(1) << 63U);
+}
+
+/*! A stable least significant digit radix sort of fixed-width sort keys. A histogram of every
+ *  8-bit digit is built in a single pass and digits which are the same for every key are skipped.
+ *  \tparam N The number of key words.
+ *  \param[in,out] dat The keys to sort.
+ */
+template <size_t N>
+void radixSort(std::vector<SortKey<N>> & dat)
+{
+    const size_t sz = dat.size();
+    const size_t nd = N * sizeof(uint64_t);
+    if (sz < 256U)
+    {
+        std::stable_sort(dat.begin(), dat.end());
+        return;
+    }
+
+    auto digit = [] (const SortKey<N> & key, size_t d) -> size_t
+    {
+        return (key.k[N - 1U - d / sizeof(uint64_t)] >> (8U * (d % sizeof(uint64_t)))) & 0xFFU;
+    };
+
+    std::vector<size_t> hist(nd * 256U, 0U);
+    for (const auto & key : dat)
+        for (size_t d = 0; d < nd; d++)
+            hist[d * 256U + digit(key, d)]++;
+
+    std::vector<SortKey<N>> temp(sz);
+    for (size_t d = 0; d < nd; d++)
+    {
+        size_t * h = &hist[d * 256U];
+        if (h[digit(dat[0], d)] == sz)
+            continue;
+
+        for (size_t i = 0, tot = 0; i < 256U; i++)
+        {
+            size_t c = h[i];
+            h[i] = tot;
+            tot += c;
+        }
+        for (const auto & key : dat)
+            temp[h[digit(key, d)]++] = key;
+        std::swap(dat, temp);
+    }
+}
+
+/*! Calculate an offset based on local size and implied ordering of left to right.
+ *  \param[in] piol The piol handle
+ *  \param[in] sz The local size
+ *  \return The associated offset
+ */
+extern size_t offcalc(ExSeisPIOL * piol, size_t sz);
+
+/*! Inform every process of how many entries it will receive from each process.
+ *  \param[in] piol The PIOL object.
+ *  \param[in] scnt The number of entries to send to each process.
+ *  \return The number of entries to receive from each process.
+ */
+extern std::vector<size_t> exchangeCount(ExSeisPIOL * piol, const std::vector<size_t> & scnt);
+
+/*! Exchange blocks of a vector between all processes. The vector is treated as a series
+ *  of entries which are each made up of w objects. MPI counts and displacements are ints, so if a
+ *  process sends or receives too many objects the exchange is split into rounds which each move
+ *  at most lim / numRank objects between any two processes.
+ *  \tparam T The type of the objects.
+ *  \param[in] piol The PIOL object.
+ *  \param[in] scnt The number of entries to send to each process, in order.
+ *  \param[in] rcnt The number of entries to receive from each process.
+ *  \param[in] w The number of objects per entry.
+ *  \param[in] dat The objects to send.
+ *  \param[in] lim The most objects a process sends or receives in a round.
+ *  \return The objects received, ordered by the rank of the sender.
+ */
+template <class T>
+std::vector<T> exchange(ExSeisPIOL * piol, const std::vector<size_t> & scnt, const std::vector<size_t> & rcnt,
+                        csize_t w, const std::vector<T> & dat, csize_t lim = size_t(std::numeric_limits<int>::max()))
+{
+    csize_t numRank = piol->comm->getNumRank();
+    csize_t plim = std::max(lim / numRank, size_t(1U));
+    std::vector<size_t> sd(numRank), rd(numRank);
+    size_t stot = 0U, rtot = 0U, most = 0U;
+    for (size_t i = 0; i < numRank; i++)
+    {
+        sd[i] = stot;
+        rd[i] = rtot;
+        stot += scnt[i] * w;
+        rtot += rcnt[i] * w;
+        most = std::max(most, std::max(scnt[i], rcnt[i]) * w);
+    }
+    csize_t nround = piol->comm->max(most / plim + (most % plim > 0U));
+
+    std::vector<T> rdat(rtot);
+    MPI_Datatype type;
+    MPI_Type_contiguous(sizeof(T), MPI_CHAR, &type);
+    MPI_Type_commit(&type);
+    std::vector<int> sc(numRank), sdi(numRank), rc(numRank), rdi(numRank);
+    std::vector<T> sbuf, rbuf;
+    for (size_t r = 0; r < nround; r++)
+    {
+        //The objects from lo to lo + plim of each block
+        csize_t lo = r * plim;
+        size_t so = 0U, ro = 0U;
+        for (size_t i = 0; i < numRank; i++)
+        {
+            sc[i] = int(scnt[i] * w > lo ? std::min(scnt[i] * w - lo, plim) : 0U);
+            sdi[i] = int(so);
+            so += size_t(sc[i]);
+            rc[i] = int(rcnt[i] * w > lo ? std::min(rcnt[i] * w - lo, plim) : 0U);
+            rdi[i] = int(ro);
+            ro += size_t(rc[i]);
+        }
+
+        //A single round moves the blocks where they are
+        const T * sp = dat.data();
+        T * rp = rdat.data();
+        if (nround > 1U)
+        {
+            sbuf.resize(so);
+            rbuf.resize(ro);
+            for (size_t i = 0; i < numRank; i++)
+                std::copy(dat.begin() + sd[i] + lo, dat.begin() + sd[i] + lo + sc[i], sbuf.begin() + sdi[i]);
+            sp = sbuf.data();
+            rp = rbuf.data();
+        }
+        int err = MPI_Alltoallv(sp, sc.data(), sdi.data(), type, rp, rc.data(), rdi.data(), type, MPI_COMM_WORLD);
+        printErr(piol->log.get(), "", Log::Layer::Ops, err, NULL, "Sort MPI_Alltoallv error");
+        if (nround > 1U)
+            for (size_t i = 0; i < numRank; i++)
+                std::copy(rbuf.begin() + rdi[i], rbuf.begin() + rdi[i] + rc[i], rdat.begin() + rd[i] + lo);
+    }
+    MPI_Type_free(&type);
+    return rdat;
+}
+
+/*! Merge consecutive sorted runs of a vector into a single sorted vector.
+ *  \tparam T Type of vector
+ *  \param[in] cnt The length of each run.
+ *  \param[in,out] dat The vector to merge.
+ *  \param[in] comp The function to use for less-than comparisons between objects in the vector.
+ */
+template <class T>
+void merge(std::vector<size_t> cnt, std::vector<T> & dat, Compare<T> comp)
+{
+    std::vector<size_t> bound(1U, 0U);
+    for (size_t c : cnt)
+        bound.push_back(bound.back() + c);
+
+    while (bound.size() > 2U)
+    {
+        std::vector<size_t> next(1U, 0U);
+        for (size_t i = 2U; i < bound.size(); i += 2U)
+        {
+            std::inplace_merge(dat.begin() + bound[i-2U], dat.begin() + bound[i-1U], dat.begin() + bound[i], comp);
+            next.push_back(bound[i]);
+        }
+        if (bound.size() % 2U == 0U)
+            next.push_back(bound.back());
+        bound = next;
+    }
+}
+
+/*! Function to sort a given vector by a sample sort. On return each process holds a sorted
+ *  run of entries, and the runs are in rank order. The number of entries on each process
+ *  is not preserved.
+ *  \tparam T Type of vector
+ *  \tparam X The type of the function used to exchange blocks of the vector.
+ *  \param[in] piol The PIOL object.
+ *  \param[in,out] dat The vector to sort
+ *  \param[in] comp The function to use for less-than comparisons between objects in the
+ *                  vector.
+ *  \param[in] xchg The function to exchange blocks of the vector between processes. It takes
+ *                  the send counts, the receive counts and the vector to send.
+ *  \param[in] lsort The function used for the initial local sort. If it is \c nullptr
+ *                   \c std::sort is used with \c comp.
+ */
+template <class T, class X>
+void sort(ExSeisPIOL * piol, std::vector<T> & dat, Compare<T> comp, X xchg,
+          std::function<void(std::vector<T> &)> lsort = nullptr)
+{
+    csize_t numRank = piol->comm->getNumRank();
+    csize_t rank = piol->comm->getRank();
+    csize_t lnt = dat.size();
+
+    if (lsort != nullptr)
+        lsort(dat);
+    else
+        std::sort(dat.begin(), dat.end(), comp);
+    if (numRank == 1U)
+        return;
+
+    //Regular sampling of the local entries. The samples are sent to the first process.
+    std::vector<T> samp;
+    if (lnt)
+        for (size_t i = 1U; i < numRank; i++)
+            samp.push_back(dat[i * lnt / numRank]);
+
+    std::vector<size_t> scnt(numRank, 0U);
+    scnt[0] = samp.size();
+    samp = xchg(scnt, exchangeCount(piol, scnt), samp);
+
+    //The first process picks the splitters and sends them to all processes
+    std::vector<T> split;
+    if (!rank && samp.size())
+    {
+        std::sort(samp.begin(), samp.end(), comp);
+        for (size_t i = 1U; i < numRank; i++)
+            split.push_back(samp[i * samp.size() / numRank]);
+    }
+    std::vector<T> bsplit;
+    for (size_t i = 0; i < numRank; i++)
+        bsplit.insert(bsplit.end(), split.begin(), split.end());
+
+    std::fill(scnt.begin(), scnt.end(), split.size());
+    split = xchg(scnt, exchangeCount(piol, scnt), bsplit);
+
+    //Partition the local entries with the splitters
+    std::fill(scnt.begin(), scnt.end(), 0U);
+    size_t prev = 0U;
+    for (size_t i = 0U; i < split.size(); i++)
+    {
+        size_t bound = std::upper_bound(dat.begin() + prev, dat.end(), split[i], comp) - dat.begin();
+        scnt[i] = bound - prev;
+        prev = bound;
+    }
+    scnt[numRank-1U] = lnt - prev;
+
+    auto rcnt = exchangeCount(piol, scnt);
+    dat = xchg(scnt, rcnt, dat);
+    merge(rcnt, dat, comp);
+}
+
+/*! Redistribute a vector which is ordered across processes so that each process holds the given
+ *  number of entries while the global order is preserved.
+ *  \tparam T Type of vector
+ *  \param[in] piol The PIOL object.
+ *  \param[in] lnt The number of entries the local process should hold.
+ *  \param[in] dat The vector to redistribute.
+ *  \return The local entries after redistribution.
+ */
+template <class T>
+std::vector<T> balance(ExSeisPIOL * piol, csize_t lnt, const std::vector<T> & dat)
+{
+    csize_t numRank = piol->comm->getNumRank();
+    if (numRank == 1U)
+        return dat;
+
+    auto szall = piol->comm->gather(std::vector<size_t>{lnt});
+    csize_t offset = offcalc(piol, dat.size());
+
+    std::vector<size_t> scnt(numRank, 0U);
+    size_t start = 0U;
+    for (size_t i = 0U; i < numRank; i++)
+    {
+        csize_t lo = std::max(start, offset);
+        csize_t hi = std::min(start + szall[i], offset + dat.size());
+        scnt[i] = (hi > lo ? hi - lo : 0U);
+        start += szall[i];
+    }
+    return exchange(piol, scnt, exchangeCount(piol, scnt), 1U, dat);
+}
+
+/*! Sort fixed-width keys across all processes. The keys are radix sorted locally.
+ *  \tparam N The number of key words.
+ *  \param[in] piol The PIOL object.
+ *  \param[in] key The local keys. The number of keys is the local number of traces.
+ *  \return Return the global trace numbers of the local share of the sorted keys.
+ */
+template <size_t N>
+std::vector<size_t> sort(ExSeisPIOL * piol, std::vector<SortKey<N>> key)
+{
+    csize_t lnt = key.size();
+    Compare<SortKey<N>> comp = [] (const SortKey<N> & a, const SortKey<N> & b) -> bool { return a < b; };
+    sort(piol, key, comp, [piol] (const std::vector<size_t> & scnt, const std::vector<size_t> & rcnt,
+                                  const std::vector<SortKey<N>> & dat)
+        {
+            return exchange(piol, scnt, rcnt, 1U, dat);
+        }, radixSort<N>);
+
+    std::vector<size_t> list(key.size());
+    for (size_t i = 0; i < key.size(); i++)
+        list[i] = key[i].gtn;
+    return balance(piol, lnt, list);
+}
+
+/*! Parallel sort a list. Local vector is part of the entire list. This is used to convert
+ *  the sorted order of traces into the location of each trace in the sorted order.
+ *  \param[in] piol The PIOL object.
+ *  \param[in] list The local vector
+ *  \return Return a new sorted vector
+ */
+std::vector<size_t> sort(ExSeisPIOL * piol, std::vector<size_t> list);
+
 /*! Function to sort the metadata in a Param struct. The returned vector is the location where the nth parameter
- *  is located in the sorted list. Implementation note: the Param vector is used internally
- *  to allow random-access iterator support.
+ *  is located in the sorted list. Implementation note: flat handles to each set of trace
+ *  parameters are sorted, so a Param structure per trace is not required. The sets are only
+ *  packed into a parameter structure to move between processes, and the comparison copies the
+ *  sets it compares into two reused single entry structures.
  *  \param[in] piol The PIOL object.
  *  \param[in,out] prm The parameter structure to sort
  *  \param[in] comp The Param function to use for less-than comparisons between objects in the
@@ -9,6 +9,7 @@
 #define PIOLSET_INCLUDE_GUARD
 #include "global.hh"
 #include "file/file.hh"
+#include "file/rawparam.hh"
 #include "ops/minmax.hh"
 #include "ops/sort.hh"
 #include <functional>
@@ -30,6 +31,14 @@ struct FileDesc
 
 typedef std::function<void(size_t, File::Param *, trace_t *)> Mod;  //!< Typedef for functions that modify traces and associated parameters
 
+/*! The approach used to write the traces of a set to an output file
+ */
+enum class OutMode : size_t
+{
+    List,       //!< Each process writes the traces it read to their output locations with list I/O
+    Shuffle     //!< Traces are exchanged between processes so each process writes contiguous blocks of the output
+};
+
 /*! Apply a taper to a set of traces --> used for acutal operation during output
  * \param[in] nt The number of traces
  * \parma[in] ns The number of samples in a trace
@@ -54,6 +63,7 @@ class InternalSet
     std::map<std::pair<size_t, geom_t>, size_t> offmap;                 //!< A map of (ns, inc) key to the current offset
     std::shared_ptr<File::Rule> rule;                                   //!< Contains a pointer to the Rules for parameters
     Mod modify = [] (size_t, File::Param *, trace_t *) { };                     //!< Function to modify traces and parameters
+    OutMode omode = OutMode::Shuffle;                                   //!< The approach used to write the output
 
     /*! Fill the file descriptors using the given pattern
      *  \param[in] piol The PIOL object.
@@ -61,6 +71,12 @@ class InternalSet
      */
     void fillDesc(std::shared_ptr<ExSeisPIOL> piol, std::string pattern);
 
+    /*! Find the min and max of two values of each trace in the set.
+     *  \param[in] fill The function which fills the pairs of values from the raw trace headers of a file
+     *  \param[out] minmax The array of structures to hold the ouput
+     */
+    void getMinMax(std::function<void(const File::RawParamView &, File::CoordPair *)> fill, CoordElem * minmax);
+
     public :
 
     /*! Constructor
@@ -86,6 +102,11 @@ class InternalSet
      */
     void sort(File::Compare<File::Param> func);
 
+    /*! Sort the set using the given sort function
+     *  \param[in] func The function which sorts the parameters and returns the new order
+     */
+    void sort(File::SortFunc func);
+
     /*! The number of traces in the input files
      *  \return The number of traces in the input files
      */
@@ -110,6 +131,14 @@ class InternalSet
      */
     void getMinMax(File::Func<File::Param> xlam, File::Func<File::Param> ylam, CoordElem * minmax);
 
+    /*! Find the min and max of two given parameters (e.g x and y source coordinates) and return
+     *  the associated values and trace numbers in the given structure
+     *  \param[in] m1 The first parameter type
+     *  \param[in] m2 The second parameter type
+     *  \param[out] minmax The array of structures to hold the ouput
+     */
+    void getMinMax(Meta m1, Meta m2, CoordElem * minmax);
+
     /*! Function to add to modify function that applies a 2 tailed taper to a set of traces
      * \param[in] trc Vector of all traces
      * \param[in] func Weight function for the taper ramp
@@ -126,6 +155,14 @@ class InternalSet
         outmsg = outmsg_;
     }
 
+    /*! Set the approach used to write the output
+     *  \param[in] omode_ The output mode
+     */
+    void outMode(OutMode omode_)
+    {
+        omode = omode_;
+    }
+
     /*! Summarise the current status by whatever means the PIOL intrinsically supports
      */
     void summary(void) const;
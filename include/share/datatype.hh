@@ -103,5 +103,76 @@ extern uint32_t toint(const float f);
  *  \details This function assumes that the system uses IEEE754.
  */
 extern float convertIBMtoIEEE(const float f, bool bigEndian);
+
+/*! The instruction sets which the batch conversion kernels are available for.
+ */
+enum class Isa : size_t
+{
+    Scalar,     //!< Portable scalar code
+    SSE4,       //!< SSE4.1 (and SSSE3 for byte shuffles)
+    AVX2,       //!< AVX2
+    AVX512      //!< AVX-512 Foundation and Byte/Word instructions
+};
+
+/*! Find the best instruction set the batch conversion kernels support on this CPU.
+ *  \return The instruction set. The CPU is only queried on the first call.
+ */
+extern Isa getIsa(void);
+
+/*! Convert an array of IBM floats to IEEE754 floats in place.
+ *  \param[in] isa The instruction set to use. It must not be better than getIsa().
+ *  \param[in] sz The number of floats
+ *  \param[in,out] f The array of floats
+ *  \param[in] bigEndian True if the data is in big endian format
+ *  \details The result is bit-exact with the single float version for every instruction set.
+ */
+extern void convertIBMtoIEEE(Isa isa, csize_t sz, float * f, bool bigEndian);
+
+/*! \overload
+ *  \brief Convert an array of IBM floats to an array of IEEE754 floats.
+ *  \param[in] isa The instruction set to use. It must not be better than getIsa().
+ *  \param[in] sz The number of floats
+ *  \param[in] src The array of IBM floats
+ *  \param[out] dst The array of IEEE754 floats. It must be src or not overlap with it.
+ *  \param[in] bigEndian True if the data is in big endian format
+ */
+extern void convertIBMtoIEEE(Isa isa, csize_t sz, const float * src, float * dst, bool bigEndian);
+
+/*! \overload
+ *  \brief Convert an array of IBM floats to an array of IEEE754 floats with the instruction
+ *  set from getIsa().
+ *  \param[in] sz The number of floats
+ *  \param[in] src The array of IBM floats
+ *  \param[out] dst The array of IEEE754 floats. It must be src or not overlap with it.
+ *  \param[in] bigEndian True if the data is in big endian format
+ */
+extern void convertIBMtoIEEE(csize_t sz, const float * src, float * dst, bool bigEndian);
+
+/*! \overload
+ *  \brief Convert an array of IBM floats to IEEE754 floats in place with the instruction set
+ *  from getIsa().
+ *  \param[in] sz The number of floats
+ *  \param[in,out] f The array of floats
+ *  \param[in] bigEndian True if the data is in big endian format
+ */
+extern void convertIBMtoIEEE(csize_t sz, float * f, bool bigEndian);
+
+/*! Reverse the byte sequence of each word in an array of 4 byte words while copying it.
+ *  \param[in] isa The instruction set to use. It must not be better than getIsa().
+ *  \param[in] sz The number of words
+ *  \param[in] src The input array
+ *  \param[out] dst The output array. It must be src or not overlap with it.
+ *  \details This switches the endianness of a block of floats or 4 byte integers in a single pass.
+ */
+extern void swap4Bytes(Isa isa, csize_t sz, const uchar * src, uchar * dst);
+
+/*! \overload
+ *  \brief Reverse the byte sequence of each word in an array of 4 byte words while copying it,
+ *  with the instruction set from getIsa().
+ *  \param[in] sz The number of words
+ *  \param[in] src The input array
+ *  \param[out] dst The output array. It must be src or not overlap with it.
+ */
+extern void swap4Bytes(csize_t sz, const uchar * src, uchar * dst);
 }
 #endif
@@ -9,6 +9,7 @@
 #ifndef PIOLSHAREDMPI_INCLUDE_GUARD
 #define PIOLSHAREDMPI_INCLUDE_GUARD
 #include <limits>
+#include <vector>
 #include <mpi.h>
 #include <typeinfo>
 #include "global.hh"
@@ -78,5 +79,17 @@ inline size_t getLimSz(size_t sz)
     //Probably something to do with pages.
     return (std::numeric_limits<int>::max() - (4096U - sz)) / sz;
 }
+
+/*! \brief Get the displacements of back to back items from their counts, e.g for MPI_Alltoallv.
+ *  \param[in] cnt The count of each item
+ *  \return The displacement of each item
+ */
+inline std::vector<int> getDispls(const std::vector<int> & cnt)
+{
+    std::vector<int> disp(cnt.size(), 0);
+    for (size_t i = 1; i < cnt.size(); i++)
+        disp[i] = disp[i-1U] + cnt[i-1U];
+    return disp;
+}
 }
 #endif
@@ -0,0 +1,35 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief
+ *   \details
+ *//*******************************************************************************************/
+#include "data/data.hh"
+namespace PIOL { namespace Data {
+/*! Expand runs of blocks into a list of offsets
+ *  \param[in] ext The runs of blocks
+ *  \return The offset of each block
+ */
+std::vector<size_t> getOffsets(const std::vector<Extent> & ext)
+{
+    std::vector<size_t> offset;
+    for (const auto & e : ext)
+        for (size_t i = 0; i < e.nb; i++)
+            offset.push_back(e.offset + i * e.osz);
+    return offset;
+}
+
+void Interface::read(csize_t bsz, const std::vector<Extent> & ext, uchar * d) const
+{
+    auto offset = getOffsets(ext);
+    read(bsz, offset.size(), offset.data(), d);
+}
+
+void Interface::write(csize_t bsz, const std::vector<Extent> & ext, const uchar * d) const
+{
+    auto offset = getOffsets(ext);
+    write(bsz, offset.size(), offset.data(), d);
+}
+}}
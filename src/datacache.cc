@@ -0,0 +1,253 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief
+ *   \details
+ *//*******************************************************************************************/
+#include <algorithm>
+#include "data/datacache.hh"
+#include "data/datampiio.hh"
+
+namespace PIOL { namespace Data {
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////    Class functions    ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////      Constructor & Destructor      ///////////////////////////////
+Cache::Opt::Opt(void)
+{
+    budget = 64U*1024U*1024U;
+    block = 64U*1024U;
+}
+
+Cache::Cache(const Piol piol_, const std::string name_, const Cache::Opt & opt, FileMode mode) : Interface(piol_, name_)
+{
+    //A read which hits the cache skips the file so the file cannot need collective calls.
+    MPIIO::Opt dopt;
+    dopt.mode = IOMode::Independent;
+    data = std::make_shared<MPIIO>(piol, name, dopt, mode);
+    Init(opt);
+}
+
+Cache::Cache(const Piol piol_, const std::string name_, FileMode mode) : Interface(piol_, name_)
+{
+    MPIIO::Opt dopt;
+    dopt.mode = IOMode::Independent;
+    data = std::make_shared<MPIIO>(piol, name, dopt, mode);
+    const Cache::Opt opt;
+    Init(opt);
+}
+
+Cache::Cache(const Piol piol_, const std::string name_, std::shared_ptr<Interface> data_, const Cache::Opt & opt)
+    : Interface(piol_, name_), data(data_)
+{
+    Init(opt);
+}
+
+void Cache::Init(const Cache::Opt & opt)
+{
+    stats = Stats();
+    block = opt.block;
+    nblock = (block ? opt.budget / block : 0U);
+    fsz = data->getFileSz();
+    if (!block)
+        log->record(name, Log::Layer::Data, Log::Status::Warning, "The block size of the cache is zero, the cache is disabled", Log::Verb::None);
+}
+
+///////////////////////////////////       Member functions      ///////////////////////////////////
+void Cache::clear(void) const
+{
+    stats.invalidations += blocks.size();
+    blocks.clear();
+    lru.clear();
+    fsz = data->getFileSz();
+}
+
+void Cache::invalidate(csize_t offset, csize_t sz) const
+{
+    if (!sz || blocks.empty())
+        return;
+    csize_t lo = offset / block;
+    csize_t hi = (offset + sz - 1U) / block;
+
+    //Walk whichever is shorter, the range or the cache.
+    if (hi - lo >= blocks.size())
+    {
+        for (auto it = blocks.begin(); it != blocks.end();)
+            if (it->first >= lo && it->first <= hi)
+            {
+                lru.erase(it->second.lru);
+                it = blocks.erase(it);
+                stats.invalidations++;
+            }
+            else
+                ++it;
+    }
+    else
+        for (size_t b = lo; b <= hi; b++)
+        {
+            auto it = blocks.find(b);
+            if (it != blocks.end())
+            {
+                lru.erase(it->second.lru);
+                blocks.erase(it);
+                stats.invalidations++;
+            }
+        }
+}
+
+size_t Cache::getFileSz() const
+{
+    return data->getFileSz();
+}
+
+void Cache::setFileSz(csize_t sz) const
+{
+    data->setFileSz(sz);
+    invalidate(std::min(sz, fsz), std::max(sz, fsz) - std::min(sz, fsz));
+    fsz = sz;
+}
+
+void Cache::blockRead(csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const
+{
+    //The blocks of the cache which the request needs. Bytes past the file size known to this
+    //process are not cached.
+    std::vector<size_t> need;
+    for (size_t i = 0; i < nb; i++)
+    {
+        csize_t o = off(i);
+        csize_t end = std::min(o + bsz, fsz);
+        for (size_t b = o / block; b * block < end; b++)
+            need.push_back(b);
+    }
+    std::sort(need.begin(), need.end());
+    need.erase(std::unique(need.begin(), need.end()), need.end());
+
+    std::vector<size_t> miss;
+    for (size_t b : need)
+        if (!blocks.count(b))
+            miss.push_back(b);
+    stats.hits += need.size() - miss.size();
+    stats.misses += miss.size();
+
+    //Read the missing blocks in one list request. Only the last block of the file is short.
+    std::vector<uchar> stage(miss.size() * block);
+    if (miss.size())
+    {
+        csize_t last = miss.back() * block;
+        csize_t nfull = miss.size() - (fsz - last < block ? 1U : 0U);
+        std::vector<size_t> moff(nfull);
+        for (size_t j = 0; j < nfull; j++)
+            moff[j] = miss[j] * block;
+        if (nfull)
+            data->read(block, nfull, moff.data(), stage.data());
+        if (nfull < miss.size())
+            data->read(last, fsz - last, &stage[nfull * block]);
+    }
+
+    //Copy the request out of the cache and the staging buffer
+    std::unordered_map<size_t, const uchar *> src;
+    for (size_t j = 0; j < miss.size(); j++)
+        src[miss[j]] = &stage[j * block];
+    for (size_t b : need)
+        if (!src.count(b))
+            src[b] = blocks[b].d.data();
+
+    for (size_t i = 0; i < nb; i++)
+    {
+        csize_t o = off(i);
+        csize_t end = std::min(o + bsz, fsz);
+        for (size_t pos = o; pos < end;)
+        {
+            csize_t b = pos / block;
+            csize_t len = std::min((b + 1U) * block, end) - pos;
+            std::copy(src[b] + pos % block, src[b] + pos % block + len, &d[i * bsz + pos - o]);
+            pos += len;
+        }
+        if (o + bsz > std::max(o, fsz))
+        {
+            csize_t start = std::max(o, fsz);
+            data->read(start, o + bsz - start, &d[i * bsz + start - o]);
+        }
+    }
+
+    //Mark the hits as recently used, then keep the new blocks and evict the oldest.
+    for (size_t b : need)
+        if (blocks.count(b))
+            lru.splice(lru.begin(), lru, blocks[b].lru);
+    for (size_t j = (miss.size() > nblock ? miss.size() - nblock : 0U); j < miss.size(); j++)
+    {
+        csize_t len = std::min(block, fsz - miss[j] * block);
+        auto & blk = blocks[miss[j]];
+        blk.d.assign(&stage[j * block], &stage[j * block] + len);
+        lru.push_front(miss[j]);
+        blk.lru = lru.begin();
+    }
+    while (blocks.size() > nblock)
+    {
+        blocks.erase(lru.back());
+        lru.pop_back();
+        stats.evictions++;
+    }
+}
+
+void Cache::blockWritten(csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off) const
+{
+    size_t end = fsz;
+    for (size_t i = 0; i < nb; i++)
+    {
+        invalidate(off(i), bsz);
+        end = std::max(end, off(i) + bsz);
+    }
+    //The short block at the old end of the file is now stale.
+    if (end > fsz)
+    {
+        invalidate(fsz, 1U);
+        fsz = end;
+    }
+}
+
+void Cache::read(csize_t offset, csize_t sz, uchar * d) const
+{
+    if (nblock)
+        blockRead(sz, 1U, [offset] (size_t) { return offset; }, d);
+    else
+        data->read(offset, sz, d);
+}
+
+void Cache::read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
+{
+    if (nblock)
+        blockRead(bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, d);
+    else
+        data->read(offset, bsz, osz, nb, d);
+}
+
+void Cache::read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const
+{
+    if (nblock)
+        blockRead(bsz, sz, [offset] (size_t i) { return offset[i]; }, d);
+    else
+        data->read(bsz, sz, offset, d);
+}
+
+void Cache::write(csize_t offset, csize_t sz, const uchar * d) const
+{
+    data->write(offset, sz, d);
+    blockWritten(sz, 1U, [offset] (size_t) { return offset; });
+}
+
+void Cache::write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const
+{
+    data->write(offset, bsz, osz, nb, d);
+    blockWritten(bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; });
+}
+
+void Cache::write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const
+{
+    data->write(bsz, sz, offset, d);
+    blockWritten(bsz, sz, [offset] (size_t i) { return offset[i]; });
+}
+}}
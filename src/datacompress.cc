@@ -0,0 +1,784 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief
+ *   \details
+ *//*******************************************************************************************/
+#include <zlib.h>
+#include <limits>
+#include <fstream>
+#include <numeric>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include "data/datacompress.hh"
+#include "share/mpi.hh"
+
+namespace PIOL { namespace Data {
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////       Non-Class       ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+const char chunkMagic[] = "ExSeisDat chunks";   //!< The start of every compressed container
+csize_t magicSz = 16U;                          //!< The length of the magic string
+csize_t headSz = 64U;                           //!< The size of the container header
+
+/*! Gather a vector of a different length from each process on every process
+ *  \param[in] log The logger
+ *  \param[in] name The file name for errors
+ *  \param[in] comm The MPI communicator
+ *  \param[in] in The local vector
+ *  \param[out] cnt The length of the vector of each process
+ *  \return The vectors of every process back to back in order of rank
+ */
+std::vector<size_t> gatherAll(Log::Logger * log, const std::string & name, MPI_Comm comm,
+                              const std::vector<size_t> & in, std::vector<int> & cnt)
+{
+    int nrank;
+    MPI_Comm_size(comm, &nrank);
+    cnt.resize(nrank);
+    int n = int(in.size());
+    int err = MPI_Allgather(&n, 1, MPI_INT, cnt.data(), 1, MPI_INT, comm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Gather of the chunk counts failed");
+
+    auto disp = getDispls(cnt);
+    std::vector<size_t> all(std::accumulate(cnt.begin(), cnt.end(), size_t(0U)));
+    err = MPI_Allgatherv(in.data(), n, MPIType<size_t>(), all.data(), cnt.data(), disp.data(), MPIType<size_t>(), comm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Gather of the chunks failed");
+    return all;
+}
+
+/*! Gather the bytes of the same significance of each element together
+ *  \param[in] width The width in bytes of an element
+ *  \param[in] sz The number of bytes
+ *  \param[in] src The elements
+ *  \param[out] dst The shuffled bytes. The bytes past the last whole element are copied as they are.
+ */
+void byteShuffle(csize_t width, csize_t sz, const uchar * src, uchar * dst)
+{
+    csize_t n = sz / width;
+    for (size_t b = 0; b < width; b++)
+        for (size_t i = 0; i < n; i++)
+            dst[b*n + i] = src[i*width + b];
+    std::copy(src + n*width, src + sz, dst + n*width);
+}
+
+/*! Undo byteShuffle
+ *  \param[in] width The width in bytes of an element
+ *  \param[in] sz The number of bytes
+ *  \param[in] src The shuffled bytes
+ *  \param[out] dst The elements
+ */
+void byteUnshuffle(csize_t width, csize_t sz, const uchar * src, uchar * dst)
+{
+    csize_t n = sz / width;
+    for (size_t b = 0; b < width; b++)
+        for (size_t i = 0; i < n; i++)
+            dst[i*width + b] = src[b*n + i];
+    std::copy(src + n*width, src + sz, dst + n*width);
+}
+
+/*! Compress a chunk. Chunks of zeros are left empty and chunks which do not get smaller are
+ *  copied as they are.
+ *  \param[in] width The width in bytes of the elements to shuffle. Zero or one does not shuffle.
+ *  \param[in] level The zlib compression level
+ *  \param[in] sz The size in bytes of the chunk
+ *  \param[in] src The chunk
+ *  \param[out] out The compressed chunk
+ */
+void packChunk(csize_t width, const int level, csize_t sz, const uchar * src, std::vector<uchar> & out)
+{
+    if (std::all_of(src, src + sz, [] (uchar c) { return !c; }))
+    {
+        out.clear();
+        return;
+    }
+    std::vector<uchar> shuf(width > 1U ? sz : 0U);
+    if (width > 1U)
+        byteShuffle(width, sz, src, shuf.data());
+
+    uLongf len = compressBound(uLong(sz));
+    out.resize(len);
+    if (compress2(out.data(), &len, (width > 1U ? shuf.data() : src), uLong(sz), level) != Z_OK || len >= sz)
+        out.assign(src, src + sz);
+    else
+        out.resize(len);
+}
+
+/*! Decompress a chunk
+ *  \param[in] width The width in bytes of the shuffled elements
+ *  \param[in] sz The size in bytes of the chunk
+ *  \param[in] src The compressed chunk
+ *  \param[in] csz The size in bytes of the compressed chunk
+ *  \param[out] dst The chunk
+ *  \return True on success, false if the chunk is corrupt
+ */
+bool unpackChunk(csize_t width, csize_t sz, const uchar * src, csize_t csz, uchar * dst)
+{
+    if (!csz)
+        std::fill(dst, dst + sz, 0U);
+    else if (csz == sz)
+        std::copy(src, src + sz, dst);
+    else
+    {
+        std::vector<uchar> shuf(width > 1U ? sz : 0U);
+        uLongf len = uLongf(sz);
+        if (uncompress((width > 1U ? shuf.data() : dst), &len, src, uLong(csz)) != Z_OK || len != sz)
+            return false;
+        if (width > 1U)
+            byteUnshuffle(width, sz, shuf.data(), dst);
+    }
+    return true;
+}
+
+/*! Find if a byte was written
+ *  \param[in] mask The bit mask of the bytes which were written
+ *  \param[in] j The byte
+ *  \return True if the byte was written
+ */
+bool isSet(const uchar * mask, csize_t j)
+{
+    return (mask[j / 8U] >> (j % 8U)) & 1U;
+}
+
+/*! Copy the bytes which were written
+ *  \param[in] sz The size in bytes of the chunk
+ *  \param[in] mask The bit mask of the bytes which were written
+ *  \param[in] src The written chunk
+ *  \param[in, out] dst The chunk to copy into
+ */
+void overlay(csize_t sz, const uchar * mask, const uchar * src, uchar * dst)
+{
+    for (size_t j = 0; j < sz;)
+        if (j % 8U == 0U && j + 8U <= sz && mask[j / 8U] == 0xFFU)
+        {
+            std::copy(src + j, src + j + 8U, dst + j);
+            j += 8U;
+        }
+        else if (j % 8U == 0U && !mask[j / 8U])
+            j += 8U;
+        else
+        {
+            if (isSet(mask, j))
+                dst[j] = src[j];
+            j++;
+        }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////    Class functions    ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////      Constructor & Destructor      ///////////////////////////////
+Compress::Opt::Opt(void)
+{
+    chunk = 1024U*1024U;
+    shuffle = 4U;
+    level = 1;
+    budget = 256U*1024U*1024U;
+    fcomm = MPI_COMM_WORLD;
+}
+
+Compress::Compress(const Piol piol_, const std::string name_, const Compress::Opt & opt, FileMode mode) : Interface(piol_, name_)
+{
+    Init(opt, mode);
+}
+
+Compress::Compress(const Piol piol_, const std::string name_, FileMode mode) : Interface(piol_, name_)
+{
+    const Compress::Opt opt;
+    Init(opt, mode);
+}
+
+Compress::~Compress(void)
+{
+    //A test container deletes itself on close.
+    if (win != MPI_WIN_NULL)
+    {
+        sync(false, 0U);
+        MPI_Win_free(&win);
+    }
+}
+
+bool Compress::isCompressed(const Piol piol, const std::string & name)
+{
+    //Only the first process touches the file
+    size_t found = 0U;
+    if (!piol->comm->getRank())
+    {
+        std::ifstream in(name, std::ios::binary);
+        char magic[magicSz];
+        found = (in.read(magic, magicSz) && !std::memcmp(magic, chunkMagic, magicSz));
+    }
+    return piol->comm->max(found);
+}
+
+void Compress::Init(const Compress::Opt & opt, FileMode mode)
+{
+    //Chunks are sent whole with their masks in merges.
+    chunk = std::min(std::max(opt.chunk, size_t(1U)), size_t(std::numeric_limits<int>::max()) / 2U);
+    shuffle = opt.shuffle;
+    level = opt.level;
+    budget = opt.budget;
+    fcomm = opt.fcomm;
+    fsz = 0U;
+    held = 0U;
+    win = MPI_WIN_NULL;
+
+    //Chunks are read back to merge them, so a container is never opened write only.
+    MPIIO::Opt dopt;
+    dopt.mode = IOMode::Independent;
+    dopt.fcomm = fcomm;
+    file = std::make_shared<MPIIO>(piol, name, dopt, (mode == FileMode::Write ? FileMode::ReadWrite : mode));
+
+    bool fresh = (mode == FileMode::Write || mode == FileMode::Test || (mode == FileMode::ReadWrite && !file->getFileSz()));
+    if (fresh)
+        file->setFileSz(0U);
+    else if (!readIndex())
+        log->record(name, Log::Layer::Data, Log::Status::Error, "The compressed container header is missing or invalid", Log::Verb::None);
+
+    int rank;
+    MPI_Comm_rank(fcomm, &rank);
+    size_t * tail = nullptr;
+    int err = MPI_Win_allocate(MPI_Aint(rank ? 0U : sizeof(size_t)), int(sizeof(size_t)), MPI_INFO_NULL, fcomm, &tail, &win);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "MPI_Win_allocate of the container end failed");
+    if (err != MPI_SUCCESS)
+    {
+        win = MPI_WIN_NULL;
+        return;
+    }
+    if (!rank)
+    {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, win);
+        *tail = std::max(file->getFileSz(), headSz);
+        MPI_Win_unlock(0, win);
+    }
+    MPI_Barrier(fcomm);
+
+    if (fresh)
+    {
+        writeIndex();
+        MPI_Barrier(fcomm);
+    }
+}
+
+///////////////////////////////////       Member functions      ///////////////////////////////////
+size_t Compress::append(csize_t sz) const
+{
+    size_t at = 0U;
+    MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, win);
+    int err = MPI_Fetch_and_op(&sz, &at, MPIType<size_t>(), 0, 0, MPI_SUM, win);
+    MPI_Win_unlock(0, win);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Reserving space in the container failed");
+    return at;
+}
+
+bool Compress::readIndex(void)
+{
+    int rank;
+    MPI_Comm_rank(fcomm, &rank);
+    //Whether the header is valid, then the fields after the magic string
+    std::vector<size_t> head(6U, 0U);
+    if (!rank)
+    {
+        std::vector<uchar> buf(headSz);
+        file->read(0U, headSz, buf.data());
+        if (!std::memcmp(buf.data(), chunkMagic, magicSz))
+        {
+            head[0] = 1U;
+            std::memcpy(&head[1], &buf[magicSz], 5U * sizeof(size_t));
+        }
+    }
+    int err = MPI_Bcast(head.data(), int(head.size()), MPIType<size_t>(), 0, fcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Sharing the container header failed");
+    if (!head[0] || !head[1])
+        return false;
+
+    chunk = head[1];
+    shuffle = head[2];
+    fsz = head[3];
+    std::vector<size_t> ent(2U * head[5]);
+    if (!rank && ent.size())
+        file->read(head[4], ent.size() * sizeof(size_t), reinterpret_cast<uchar *>(ent.data()));
+    err = MPI_Bcast(ent.data(), int(ent.size()), MPIType<size_t>(), 0, fcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Sharing the chunk index failed");
+
+    index.resize(head[5]);
+    for (size_t i = 0; i < index.size(); i++)
+        index[i] = {ent[2U*i], ent[2U*i + 1U]};
+    return true;
+}
+
+void Compress::writeIndex(void) const
+{
+    int rank;
+    MPI_Comm_rank(fcomm, &rank);
+    if (rank)
+        return;
+
+    std::vector<size_t> ent(2U * index.size());
+    for (size_t i = 0; i < index.size(); i++)
+    {
+        ent[2U*i] = index[i].offset;
+        ent[2U*i + 1U] = index[i].csz;
+    }
+    csize_t isz = ent.size() * sizeof(size_t);
+    csize_t at = (isz ? append(isz) : headSz);
+    if (isz)
+        file->write(at, isz, reinterpret_cast<const uchar *>(ent.data()));
+
+    std::vector<uchar> head(headSz, 0U);
+    std::copy(chunkMagic, chunkMagic + magicSz, head.begin());
+    const size_t val[5] = {chunk, shuffle, fsz, at, index.size()};
+    std::memcpy(&head[magicSz], val, sizeof(val));
+    file->write(0U, headSz, head.data());
+}
+
+Compress::Entry Compress::locate(csize_t c) const
+{
+    return (c < index.size() ? index[c] : Entry{0U, 0U});
+}
+
+void Compress::fetch(const std::vector<Entry> & es, uchar * d) const
+{
+    csize_t n = es.size();
+    //The stored chunks are read in container order with as few requests as possible.
+    std::vector<size_t> ord;
+    for (size_t i = 0; i < n; i++)
+        if (es[i].csz)
+            ord.push_back(i);
+    std::sort(ord.begin(), ord.end(), [&es] (size_t a, size_t b) { return es[a].offset < es[b].offset; });
+
+    std::vector<size_t> pos(n, 0U);
+    size_t total = 0U;
+    for (size_t i : ord)
+    {
+        pos[i] = total;
+        total += es[i].csz;
+    }
+    std::vector<uchar> stage(total);
+    for (size_t j = 0; j < ord.size();)
+    {
+        const Entry & e = es[ord[j]];
+        size_t len = e.csz;
+        size_t k = j + 1U;
+        for (; k < ord.size() && es[ord[k]].offset == e.offset + len; k++)
+            len += es[ord[k]].csz;
+        file->read(e.offset, len, &stage[pos[ord[j]]]);
+        j = k;
+    }
+
+    size_t bad = 0U;
+    #pragma omp parallel for schedule(dynamic) reduction(+:bad)
+    for (size_t i = 0; i < n; i++)
+        if (!unpackChunk(shuffle, chunk, stage.data() + pos[i], es[i].csz, &d[i * chunk]))
+            bad++;
+    if (bad)
+        log->record(name, Log::Layer::Data, Log::Status::Error, std::to_string(bad) + " compressed chunks are corrupt", Log::Verb::None);
+}
+
+std::vector<Compress::Entry> Compress::pack(const std::vector<const uchar *> & src) const
+{
+    csize_t n = src.size();
+    std::vector<std::vector<uchar>> out(n);
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < n; i++)
+        packChunk(shuffle, level, chunk, src[i], out[i]);
+
+    //The chunks of a process are appended together with one write.
+    size_t total = 0U;
+    for (auto & o : out)
+        total += o.size();
+    csize_t at = (total ? append(total) : 0U);
+    std::vector<uchar> buf(total);
+    std::vector<Entry> es(n);
+    size_t pos = 0U;
+    for (size_t i = 0; i < n; i++)
+    {
+        std::copy(out[i].begin(), out[i].end(), buf.begin() + pos);
+        es[i] = {at + pos, out[i].size()};
+        pos += out[i].size();
+    }
+    if (total)
+        file->write(at, total, buf.data());
+    return es;
+}
+
+void Compress::store(const std::vector<size_t> & cs, const std::vector<const uchar *> & src) const
+{
+    auto es = pack(src);
+    for (size_t i = 0; i < cs.size(); i++)
+    {
+        if (cs[i] >= index.size())
+            index.resize(cs[i] + 1U, Entry{0U, 0U});
+        index[cs[i]] = es[i];
+        stored.push_back(cs[i]);
+    }
+}
+
+void Compress::storeFull(void) const
+{
+    std::vector<size_t> cs;
+    std::vector<const uchar *> src;
+    for (auto & c : dirty)
+        if (c.second.nset == chunk)
+        {
+            cs.push_back(c.first);
+            src.push_back(c.second.d.data());
+        }
+    store(cs, src);
+    for (size_t c : cs)
+    {
+        held -= dirty[c].d.size() + dirty[c].mask.size();
+        dirty.erase(c);
+    }
+}
+
+void Compress::spillPartial(void) const
+{
+    //The stored chunks are read a few at a time so the spill does not double what is held
+    csize_t batch = std::max(budget / (4U * chunk), size_t(1U));
+    std::vector<size_t> cs;
+    for (auto & c : dirty)
+        if (!c.second.d.empty())
+            cs.push_back(c.first);
+
+    std::vector<uchar> base;
+    for (size_t i = 0; i < cs.size(); i += batch)
+    {
+        csize_t n = std::min(batch, cs.size() - i);
+        std::vector<Entry> es(n);
+        for (size_t j = 0; j < n; j++)
+            es[j] = locate(cs[i + j]);
+        base.resize(n * chunk);
+        fetch(es, base.data());
+
+        std::vector<const uchar *> src(n);
+        for (size_t j = 0; j < n; j++)
+        {
+            Dirty & dc = dirty[cs[i + j]];
+            overlay(chunk, dc.mask.data(), dc.d.data(), &base[j * chunk]);
+            src[j] = &base[j * chunk];
+        }
+        es = pack(src);
+        for (size_t j = 0; j < n; j++)
+        {
+            Dirty & dc = dirty[cs[i + j]];
+            dc.spill = es[j];
+            held -= dc.d.size();
+            std::vector<uchar>().swap(dc.d);
+        }
+    }
+}
+
+void Compress::unspill(const std::vector<size_t> & cs) const
+{
+    std::vector<Entry> es(cs.size());
+    for (size_t i = 0; i < cs.size(); i++)
+        es[i] = dirty[cs[i]].spill;
+    std::vector<uchar> buf(cs.size() * chunk);
+    fetch(es, buf.data());
+    for (size_t i = 0; i < cs.size(); i++)
+    {
+        Dirty & dc = dirty[cs[i]];
+        dc.d.assign(&buf[i * chunk], &buf[(i + 1U) * chunk]);
+        held += chunk;
+    }
+}
+
+size_t Compress::share(void) const
+{
+    std::vector<size_t> ent;
+    for (size_t c : stored)
+    {
+        ent.push_back(c);
+        ent.push_back(index[c].offset);
+        ent.push_back(index[c].csz);
+    }
+    stored.clear();
+
+    //Every process applies the chunks in the same order so the indices agree.
+    std::vector<int> cnt;
+    auto all = gatherAll(log, name, fcomm, ent, cnt);
+    for (size_t j = 0; j < all.size(); j += 3U)
+    {
+        if (all[j] >= index.size())
+            index.resize(all[j] + 1U, Entry{0U, 0U});
+        index[all[j]] = {all[j + 1U], all[j + 2U]};
+    }
+    return all.size() / 3U;
+}
+
+void Compress::sync(bool resize, csize_t sz) const
+{
+    int rank, nrank;
+    MPI_Comm_rank(fcomm, &rank);
+    MPI_Comm_size(fcomm, &nrank);
+
+    //Merges start from the latest stored chunks
+    size_t changed = share();
+
+    std::vector<size_t> spilt;
+    for (auto & c : dirty)
+        if (c.second.d.empty())
+            spilt.push_back(c.first);
+    unspill(spilt);
+
+    //The first process to have written to a chunk merges it.
+    std::vector<size_t> mine;
+    for (auto & c : dirty)
+        mine.push_back(c.first);
+    std::vector<int> cnt;
+    auto all = gatherAll(log, name, fcomm, mine, cnt);
+    auto disp = getDispls(cnt);
+    std::map<size_t, int> owner;
+    for (int r = 0; r < nrank; r++)
+        for (int j = 0; j < cnt[r]; j++)
+            owner.emplace(all[disp[r] + j], r);
+
+    //Send the chunks with their masks to the processes which merge them, in chunk order
+    csize_t msz = (chunk + 7U) / 8U;
+    csize_t dsz = chunk + msz;
+    std::vector<int> scnt(nrank, 0), rcnt(nrank, 0);
+    for (auto & c : dirty)
+        if (owner[c.first] != rank)
+            scnt[owner[c.first]]++;
+    for (int r = 0; r < nrank; r++)
+        for (int j = 0; r != rank && j < cnt[r]; j++)
+            if (owner[all[disp[r] + j]] == rank)
+                rcnt[r]++;
+    auto sdisp = getDispls(scnt);
+    auto rdisp = getDispls(rcnt);
+    std::vector<uchar> sbuf(std::accumulate(scnt.begin(), scnt.end(), size_t(0U)) * dsz);
+    std::vector<uchar> rbuf(std::accumulate(rcnt.begin(), rcnt.end(), size_t(0U)) * dsz);
+    std::vector<int> next = sdisp;
+    for (auto & c : dirty)
+    {
+        int o = owner[c.first];
+        if (o != rank)
+        {
+            uchar * b = &sbuf[size_t(next[o]++) * dsz];
+            std::copy(c.second.d.begin(), c.second.d.end(), b);
+            std::copy(c.second.mask.begin(), c.second.mask.end(), b + chunk);
+        }
+    }
+
+    MPI_Datatype ctype;
+    MPI_Type_contiguous(int(dsz), MPI_BYTE, &ctype);
+    MPI_Type_commit(&ctype);
+    int err = MPI_Alltoallv(sbuf.data(), scnt.data(), sdisp.data(), ctype, rbuf.data(), rcnt.data(), rdisp.data(), ctype, fcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Sending chunks to be merged failed");
+    MPI_Type_free(&ctype);
+
+    //The chunks this process merges. Chunks not written in full start from what is stored.
+    std::vector<size_t> cs, need;
+    for (auto & c : dirty)
+        if (owner[c.first] == rank)
+        {
+            cs.push_back(c.first);
+            if (c.second.nset < chunk)
+                need.push_back(c.first);
+        }
+    std::vector<Entry> es(need.size());
+    for (size_t i = 0; i < need.size(); i++)
+        es[i] = locate(need[i]);
+    std::vector<uchar> base(need.size() * chunk);
+    fetch(es, base.data());
+
+    //Later processes win where processes wrote the same bytes
+    std::vector<uchar> merged(cs.size() * chunk, 0U);
+    std::vector<const uchar *> src(cs.size());
+    std::unordered_map<size_t, uchar *> at;
+    for (size_t i = 0, j = 0; i < cs.size(); i++)
+    {
+        uchar * m = &merged[i * chunk];
+        if (j < need.size() && need[j] == cs[i])
+        {
+            std::copy(&base[j * chunk], &base[(j + 1U) * chunk], m);
+            j++;
+        }
+        const Dirty & dc = dirty[cs[i]];
+        overlay(chunk, dc.mask.data(), dc.d.data(), m);
+        src[i] = m;
+        at[cs[i]] = m;
+    }
+    for (int r = 0; r < nrank; r++)
+        for (int j = 0, k = rdisp[r]; r != rank && j < cnt[r]; j++)
+        {
+            csize_t c = all[disp[r] + j];
+            if (owner[c] == rank)
+            {
+                const uchar * b = &rbuf[size_t(k++) * dsz];
+                overlay(chunk, b + chunk, b, at[c]);
+            }
+        }
+    store(cs, src);
+    dirty.clear();
+    held = 0U;
+    changed += share();
+
+    if (resize)
+    {
+        fsz = sz;
+        index.resize(std::min(index.size(), (sz + chunk - 1U) / chunk));
+    }
+    else
+    {
+        size_t gsz = fsz;
+        err = MPI_Allreduce(&fsz, &gsz, 1, MPIType<size_t>(), MPI_MAX, fcomm);
+        printErr(log, name, Log::Layer::Data, err, nullptr, "Sharing the file size failed");
+        fsz = gsz;
+    }
+    if (changed || resize)
+        writeIndex();
+}
+
+size_t Compress::getFileSz() const
+{
+    return fsz;
+}
+
+void Compress::setFileSz(csize_t sz) const
+{
+    sync(false, 0U);
+
+    //The bytes past the new end of the last chunk are cleared in case the file grows again
+    int rank;
+    MPI_Comm_rank(fcomm, &rank);
+    csize_t c = sz / chunk;
+    if (!rank && sz % chunk && c < index.size() && index[c].csz)
+    {
+        std::vector<uchar> zero(chunk - sz % chunk, 0U);
+        blockIO(true, zero.size(), 1U, [sz] (size_t) { return sz; }, zero.data());
+    }
+    sync(true, sz);
+}
+
+void Compress::blockIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const
+{
+    if (!bsz || !nb)
+        return;
+
+    if (write)
+    {
+        for (size_t i = 0; i < nb; i++)
+        {
+            csize_t offset = off(i);
+            for (size_t pos = offset; pos < offset + bsz;)
+            {
+                csize_t c = pos / chunk;
+                csize_t len = std::min((c + 1U) * chunk, offset + bsz) - pos;
+                auto it = dirty.find(c);
+                if (it == dirty.end())
+                {
+                    Dirty & dc = dirty[c];
+                    dc.d.assign(chunk, 0U);
+                    dc.mask.assign((chunk + 7U) / 8U, 0U);
+                    dc.nset = 0U;
+                    held += dc.d.size() + dc.mask.size();
+                }
+                else if (it->second.d.empty())
+                    unspill({c});
+                Dirty & dc = dirty[c];
+                std::copy(&d[i*bsz + pos - offset], &d[i*bsz + pos - offset + len], &dc.d[pos % chunk]);
+                for (size_t j = pos % chunk; j < pos % chunk + len; j++)
+                    if (!isSet(dc.mask.data(), j))
+                    {
+                        dc.mask[j / 8U] |= uchar(1U << (j % 8U));
+                        dc.nset++;
+                    }
+                pos += len;
+            }
+            fsz = std::max(fsz, offset + bsz);
+        }
+        if (held > budget)
+            storeFull();
+        if (held > budget)
+            spillPartial();
+        return;
+    }
+
+    //The chunks the blocks need up to the end of the file. Chunks this process wrote in full are
+    //not read.
+    std::vector<size_t> cs, need;
+    for (size_t i = 0; i < nb; i++)
+    {
+        csize_t offset = off(i);
+        csize_t end = std::min(offset + bsz, fsz);
+        for (size_t c = offset / chunk; c * chunk < end; c++)
+            cs.push_back(c);
+    }
+    std::sort(cs.begin(), cs.end());
+    cs.erase(std::unique(cs.begin(), cs.end()), cs.end());
+    //Spilled chunks already hold what was written over what was stored
+    std::vector<Entry> es;
+    for (size_t c : cs)
+    {
+        auto it = dirty.find(c);
+        if (it == dirty.end() || it->second.nset < chunk || it->second.d.empty())
+        {
+            need.push_back(c);
+            es.push_back(it != dirty.end() && it->second.d.empty() ? it->second.spill : locate(c));
+        }
+    }
+    std::vector<uchar> stage(need.size() * chunk);
+    fetch(es, stage.data());
+
+    std::unordered_map<size_t, const uchar *> src;
+    for (size_t j = 0; j < need.size(); j++)
+    {
+        uchar * m = &stage[j * chunk];
+        auto it = dirty.find(need[j]);
+        if (it != dirty.end() && !it->second.d.empty())
+            overlay(chunk, it->second.mask.data(), it->second.d.data(), m);
+        src[need[j]] = m;
+    }
+    for (size_t c : cs)
+        if (!src.count(c))
+            src[c] = dirty[c].d.data();
+
+    for (size_t i = 0; i < nb; i++)
+    {
+        csize_t offset = off(i);
+        csize_t end = std::min(offset + bsz, fsz);
+        for (size_t pos = offset; pos < end;)
+        {
+            csize_t c = pos / chunk;
+            csize_t len = std::min((c + 1U) * chunk, end) - pos;
+            std::copy(src[c] + pos % chunk, src[c] + pos % chunk + len, &d[i*bsz + pos - offset]);
+            pos += len;
+        }
+    }
+}
+
+void Compress::read(csize_t offset, csize_t sz, uchar * d) const
+{
+    blockIO(false, sz, 1U, [offset] (size_t) { return offset; }, d);
+}
+
+void Compress::read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
+{
+    blockIO(false, bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, d);
+}
+
+void Compress::read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const
+{
+    blockIO(false, bsz, sz, [offset] (size_t i) { return offset[i]; }, d);
+}
+
+void Compress::write(csize_t offset, csize_t sz, const uchar * d) const
+{
+    blockIO(true, sz, 1U, [offset] (size_t) { return offset; }, const_cast<uchar *>(d));
+}
+
+void Compress::write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const
+{
+    blockIO(true, bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, const_cast<uchar *>(d));
+}
+
+void Compress::write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const
+{
+    blockIO(true, bsz, sz, [offset] (size_t i) { return offset[i]; }, const_cast<uchar *>(d));
+}
+}}
@@ -0,0 +1,340 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief
+ *   \details
+ *//*******************************************************************************************/
+#include <map>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include "data/datamemory.hh"
+#include "share/mpi.hh"
+
+namespace PIOL { namespace Data {
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////       Non-Class       ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! The in-memory file shared by every open instance of it on a process. Chunk c of the file is
+ *  owned by process c % numRank and is found at byte (c / numRank) * chunk of its window.
+ */
+struct Memory::Store
+{
+    MPI_Comm comm;      //!< The MPI communicator which holds the file
+    int rank;           //!< The rank of this process in comm
+    int numRank;        //!< The number of processes in comm
+    size_t chunk;       //!< The size in bytes of a chunk
+    MPI_Win win;        //!< The window of the memory owned by this process
+    uchar * base;       //!< The memory owned by this process
+    size_t lcap;        //!< The number of bytes owned by this process
+    size_t fsz;         //!< The file size all processes agreed on at the last collective call
+    size_t lsz;         //!< The end of the writes of this process since the last collective call
+
+    //! Writes beyond the memory of the processes, kept until the next collective call.
+    std::vector<std::pair<size_t, std::vector<uchar>>> pending;
+
+    /*! Create an empty file
+     *  \param[in] comm_ The MPI communicator which holds the file
+     *  \param[in] chunk_ The size in bytes of a chunk
+     */
+    Store(MPI_Comm comm_, csize_t chunk_) : comm(comm_), chunk(chunk_), win(MPI_WIN_NULL), base(nullptr), lcap(0U), fsz(0U), lsz(0U)
+    {
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &numRank);
+    }
+
+    /*! Free the window unless MPI is already gone
+     */
+    ~Store(void)
+    {
+        int fin = 0;
+        MPI_Finalized(&fin);
+        if (!fin && win != MPI_WIN_NULL)
+            MPI_Win_free(&win);
+    }
+
+    /*! The number of bytes held by all processes together
+     *  \return The capacity in bytes
+     */
+    size_t cap(void) const
+    {
+        return lcap * size_t(numRank);
+    }
+
+    /*! Make sure the processes hold at least sz bytes. Collective with the same sz everywhere.
+     *  \param[in] sz The number of bytes needed
+     *  \return The MPI error code
+     */
+    int grow(csize_t sz)
+    {
+        if (sz <= cap())
+            return MPI_SUCCESS;
+        csize_t nr = size_t(numRank);
+        csize_t ncap = ((sz + chunk - 1U) / chunk + nr - 1U) / nr * chunk;
+        MPI_Win nwin;
+        uchar * nbase;
+        int err = MPI_Win_allocate(MPI_Aint(ncap), 1, MPI_INFO_NULL, comm, &nbase, &nwin);
+        if (err != MPI_SUCCESS)
+            return err;
+
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, rank, 0, nwin);
+        if (win != MPI_WIN_NULL)
+            MPI_Win_lock(MPI_LOCK_EXCLUSIVE, rank, 0, win);
+        std::copy(base, base + lcap, nbase);
+        std::memset(nbase + lcap, 0, ncap - lcap);
+        if (win != MPI_WIN_NULL)
+        {
+            MPI_Win_unlock(rank, win);
+            MPI_Win_free(&win);
+        }
+        MPI_Win_unlock(rank, nwin);
+
+        win = nwin;
+        base = nbase;
+        lcap = ncap;
+        return MPI_SUCCESS;
+    }
+
+    /*! Get or put a range of the file which lies within the capacity. Must be called within a
+     *  passive target access epoch for all processes.
+     *  \param[in] write Whether to put
+     *  \param[in] offset The offset in bytes in the file
+     *  \param[in] sz The number of bytes
+     *  \param[in, out] d The memory to put from or get into
+     *  \return The MPI error code
+     */
+    int access(bool write, csize_t offset, csize_t sz, uchar * d) const
+    {
+        int err = MPI_SUCCESS;
+        for (size_t pos = offset; pos < offset + sz && err == MPI_SUCCESS;)
+        {
+            csize_t c = pos / chunk;
+            csize_t len = std::min((c + 1U) * chunk, offset + sz) - pos;
+            int target = int(c % size_t(numRank));
+            MPI_Aint disp = MPI_Aint((c / size_t(numRank)) * chunk + pos % chunk);
+            if (write)
+                err = MPI_Put(&d[pos - offset], int(len), MPI_BYTE, target, disp, int(len), MPI_BYTE, win);
+            else
+                err = MPI_Get(&d[pos - offset], int(len), MPI_BYTE, target, disp, int(len), MPI_BYTE, win);
+            pos += len;
+        }
+        return err;
+    }
+};
+
+/*! The in-memory files of this process by name
+ *  \return The registry
+ */
+std::map<std::string, std::shared_ptr<Memory::Store>> & memRegistry(void)
+{
+    static std::map<std::string, std::shared_ptr<Memory::Store>> reg;
+    return reg;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////    Class functions    ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////      Constructor & Destructor      ///////////////////////////////
+Memory::Opt::Opt(void)
+{
+    comm = MPI_COMM_WORLD;
+    chunk = 1024U*1024U;
+}
+
+Memory::Memory(const Piol piol_, const std::string name_, const Memory::Opt & opt, FileMode mode) : Interface(piol_, name_)
+{
+    Init(opt, mode);
+}
+
+Memory::Memory(const Piol piol_, const std::string name_, FileMode mode) : Interface(piol_, name_)
+{
+    const Memory::Opt opt;
+    Init(opt, mode);
+}
+
+Memory::~Memory(void)
+{
+    if (store != nullptr)
+    {
+        sync();
+        if (remove)
+            erase(name);
+    }
+}
+
+void Memory::Init(const Memory::Opt & opt, FileMode mode)
+{
+    remove = (mode == FileMode::Test);
+    auto & reg = memRegistry();
+    auto it = reg.find(name);
+    if (it != reg.end())
+    {
+        store = it->second;
+        return;
+    }
+    if (mode == FileMode::Read)
+    {
+        log->record(name, Log::Layer::Data, Log::Status::Error, "There is no in-memory file of this name", Log::Verb::None);
+        return;
+    }
+    if (!opt.chunk || opt.chunk > size_t(std::numeric_limits<int>::max()))
+    {
+        log->record(name, Log::Layer::Data, Log::Status::Error, "The in-memory chunk size must fit in an int and be non-zero", Log::Verb::None);
+        return;
+    }
+    store = std::make_shared<Store>(opt.comm, opt.chunk);
+    reg[name] = store;
+}
+
+bool Memory::isMemory(const std::string & name)
+{
+    return !name.compare(0U, 4U, "mem:");
+}
+
+void Memory::erase(const std::string & name)
+{
+    memRegistry().erase(name);
+}
+
+///////////////////////////////////       Member functions      ///////////////////////////////////
+void Memory::sync(void) const
+{
+    size_t sz = std::max(store->fsz, store->lsz);
+    int err = MPI_Allreduce(MPI_IN_PLACE, &sz, 1, MPIType<size_t>(), MPI_MAX, store->comm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "in-memory file size reduction failed");
+    err = store->grow(sz);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "in-memory MPI_Win_allocate failed");
+
+    if (err == MPI_SUCCESS && store->cap())
+    {
+        MPI_Win_lock_all(0, store->win);
+        for (auto & p : store->pending)
+        {
+            err = store->access(true, p.first, p.second.size(), p.second.data());
+            printErr(log, name, Log::Layer::Data, err, nullptr, "in-memory MPI_Put failed");
+        }
+        MPI_Win_unlock_all(store->win);
+    }
+    //Every put must be complete before any process reads.
+    MPI_Barrier(store->comm);
+
+    store->pending.clear();
+    store->fsz = sz;
+    store->lsz = 0U;
+}
+
+size_t Memory::getFileSz() const
+{
+    return (store != nullptr ? std::max(store->fsz, store->lsz) : 0U);
+}
+
+void Memory::setFileSz(csize_t sz) const
+{
+    if (store == nullptr)
+        return;
+    sync();
+    int err = store->grow(sz);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "in-memory MPI_Win_allocate failed");
+
+    //Clear the bytes cut off so they are not seen if the file grows again.
+    if (sz < store->fsz && err == MPI_SUCCESS)
+    {
+        csize_t nr = size_t(store->numRank);
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, store->rank, 0, store->win);
+        for (size_t j = 0; j < store->lcap / store->chunk; j++)
+        {
+            csize_t pos = (j * nr + size_t(store->rank)) * store->chunk;
+            if (pos + store->chunk > sz)
+            {
+                csize_t skip = (sz > pos ? sz - pos : 0U);
+                std::memset(store->base + j * store->chunk + skip, 0, store->chunk - skip);
+            }
+        }
+        MPI_Win_unlock(store->rank, store->win);
+        MPI_Barrier(store->comm);
+    }
+    store->fsz = sz;
+}
+
+void Memory::blockIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const
+{
+    if (store == nullptr)
+        return;
+    Store & s = *store;
+    csize_t cap = s.cap();
+    csize_t fsz = getFileSz();
+
+    int err = MPI_SUCCESS;
+    if (cap)
+        MPI_Win_lock_all(0, s.win);
+    for (size_t i = 0; i < nb; i++)
+    {
+        csize_t offset = off(i);
+        uchar * bd = &d[i * bsz];
+        //Reads past the end of the file read nothing.
+        csize_t end = (write ? offset + bsz : std::max(std::min(offset + bsz, fsz), offset));
+        csize_t split = std::max(std::min(end, cap), offset);
+        if (split > offset && err == MPI_SUCCESS)
+            err = s.access(write, offset, split - offset, bd);
+        if (end == split)
+            continue;
+
+        //Beyond the capacity only this process can see its own writes until the next collective call.
+        uchar * rd = &bd[split - offset];
+        if (write)
+            s.pending.emplace_back(split, std::vector<uchar>(rd, rd + (end - split)));
+        else
+        {
+            std::fill(rd, rd + (end - split), 0U);
+            for (const auto & p : s.pending)
+            {
+                csize_t lo = std::max(p.first, split);
+                csize_t hi = std::min(p.first + p.second.size(), end);
+                if (lo < hi)
+                    std::copy(&p.second[lo - p.first], &p.second[hi - p.first], &rd[lo - split]);
+            }
+        }
+    }
+    if (cap)
+        MPI_Win_unlock_all(s.win);
+    printErr(log, name, Log::Layer::Data, err, nullptr, std::string("in-memory ") + (write ? "MPI_Put" : "MPI_Get") + " failed");
+
+    if (write && nb && bsz)
+        for (size_t i = 0; i < nb; i++)
+            s.lsz = std::max(s.lsz, off(i) + bsz);
+}
+
+void Memory::read(csize_t offset, csize_t sz, uchar * d) const
+{
+    blockIO(false, sz, 1U, [offset] (size_t) { return offset; }, d);
+}
+
+void Memory::read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
+{
+    blockIO(false, bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, d);
+}
+
+void Memory::read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const
+{
+    blockIO(false, bsz, sz, [offset] (size_t i) { return offset[i]; }, d);
+}
+
+void Memory::write(csize_t offset, csize_t sz, const uchar * d) const
+{
+    blockIO(true, sz, 1U, [offset] (size_t) { return offset; }, const_cast<uchar *>(d));
+}
+
+void Memory::write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const
+{
+    blockIO(true, bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, const_cast<uchar *>(d));
+}
+
+void Memory::write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const
+{
+    blockIO(true, bsz, sz, [offset] (size_t i) { return offset[i]; }, const_cast<uchar *>(d));
+}
+}}
@@ -0,0 +1,209 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief
+ *   \details
+ *//*******************************************************************************************/
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include "data/datammap.hh"
+
+namespace PIOL { namespace Data {
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////    Class functions    ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////      Constructor & Destructor      ///////////////////////////////
+MMap::Opt::Opt(void)
+{
+    advice = Advice::Auto;
+    willSz = 1024U*1024U;
+}
+
+MMap::MMap(const Piol piol_, const std::string name_, const MMap::Opt & opt, FileMode mode) : Interface(piol_, name_)
+{
+    Init(opt, mode);
+}
+
+MMap::MMap(const Piol piol_, const std::string name_, FileMode mode) : Interface(piol_, name_)
+{
+    const MMap::Opt opt;
+    Init(opt, mode);
+}
+
+MMap::~MMap(void)
+{
+    if (map != nullptr)
+        munmap(map, fsz);
+    if (fd >= 0)
+        close(fd);
+}
+
+void MMap::Init(const MMap::Opt & opt, FileMode mode)
+{
+    fsz = 0U;
+    map = nullptr;
+    advice = opt.advice;
+    willSz = opt.willSz;
+
+    fd = -1;
+    if (mode != FileMode::Read)
+    {
+        readOnly("open for writing");
+        return;
+    }
+
+    fd = open(name.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st))
+    {
+        log->record(name, Log::Layer::Data, Log::Status::Error, std::string("open failure (") + std::strerror(errno) + ")", Log::Verb::None);
+        return;
+    }
+
+    //There is nothing to map in an empty file.
+    fsz = size_t(st.st_size);
+    if (!fsz)
+        return;
+
+    void * ptr = mmap(nullptr, fsz, PROT_READ, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED)
+    {
+        log->record(name, Log::Layer::Data, Log::Status::Error, std::string("mmap failure (") + std::strerror(errno) + ")", Log::Verb::None);
+        return;
+    }
+    map = static_cast<uchar *>(ptr);
+
+    switch (advice)
+    {
+        case Advice::Sequential :
+            advise(0U, fsz, MADV_SEQUENTIAL);
+        break;
+        case Advice::Random :
+            advise(0U, fsz, MADV_RANDOM);
+        break;
+        default :
+        break;
+    }
+}
+
+///////////////////////////////////       Member functions      ///////////////////////////////////
+void MMap::advise(csize_t offset, csize_t sz, int adv) const
+{
+    if (map == nullptr || offset >= fsz || !sz)
+        return;
+    //madvise takes whole pages.
+    csize_t page = size_t(sysconf(_SC_PAGESIZE));
+    csize_t start = offset / page * page;
+    csize_t end = std::min(offset + sz, fsz);
+    if (madvise(map + start, end - start, adv))
+        log->record(name, Log::Layer::Data, Log::Status::Warning, std::string("madvise failure (") + std::strerror(errno) + ")", Log::Verb::Extended);
+}
+
+void MMap::copy(csize_t offset, csize_t sz, uchar * d) const
+{
+    if (offset < fsz)
+        std::copy(map + offset, map + std::min(offset + sz, fsz), d);
+}
+
+void MMap::readOnly(const std::string msg) const
+{
+    log->record(name, Log::Layer::Data, Log::Status::Error, "The memory-mapped data layer is read-only: " + msg, Log::Verb::None);
+}
+
+size_t MMap::getFileSz() const
+{
+    return fsz;
+}
+
+void MMap::setFileSz(csize_t sz) const
+{
+    if (sz != fsz)
+        readOnly("set file size");
+}
+
+void MMap::read(csize_t offset, csize_t sz, uchar * d) const
+{
+    //Large contiguous reads start the read-ahead of the whole range at once.
+    if (advice == Advice::Auto && sz >= willSz)
+        advise(offset, sz, MADV_WILLNEED);
+    copy(offset, sz, d);
+}
+
+void MMap::read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
+{
+    if (!nb)
+        return;
+    //A dense stride is read like a contiguous range, a sparse one touches few pages of the span.
+    if (advice == Advice::Auto)
+    {
+        csize_t span = (nb - 1U) * osz + bsz;
+        if (2U * bsz >= osz)
+            advise(offset, span, (span >= willSz ? MADV_WILLNEED : MADV_SEQUENTIAL));
+        else
+            advise(offset, span, MADV_RANDOM);
+    }
+    for (size_t i = 0; i < nb; i++)
+        copy(offset + i * osz, bsz, &d[i * bsz]);
+}
+
+void MMap::read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const
+{
+    if (advice == Advice::Auto && sz)
+    {
+        auto mm = std::minmax_element(offset, offset + sz);
+        advise(*mm.first, *mm.second - *mm.first + bsz, MADV_RANDOM);
+    }
+    for (size_t i = 0; i < sz; i++)
+        copy(offset[i], bsz, &d[i * bsz]);
+}
+
+void MMap::read(csize_t bsz, const std::vector<Extent> & ext, uchar * d) const
+{
+    for (const auto & e : ext)
+    {
+        read(e.offset, bsz, e.osz, e.nb, d);
+        d += e.nb * bsz;
+    }
+}
+
+void MMap::write(csize_t offset, csize_t sz, const uchar * d) const
+{
+    (void)offset;
+    (void)d;
+    if (sz)
+        readOnly("write");
+}
+
+void MMap::write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const
+{
+    (void)offset;
+    (void)osz;
+    (void)d;
+    if (bsz && nb)
+        readOnly("write");
+}
+
+void MMap::write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const
+{
+    (void)offset;
+    (void)d;
+    if (bsz && sz)
+        readOnly("write");
+}
+
+void MMap::write(csize_t bsz, const std::vector<Extent> & ext, const uchar * d) const
+{
+    (void)d;
+    for (const auto & e : ext)
+        if (bsz && e.nb)
+            return readOnly("write");
+}
+}}
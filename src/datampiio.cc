@@ -8,6 +8,8 @@
  *//*******************************************************************************************/
 #include <assert.h>
 #include <algorithm>
+#include <cstdlib>
+#include <numeric>
 #include "data/datampiio.hh"
 #include "share/mpi.hh"
 
@@ -16,29 +18,6 @@ namespace PIOL { namespace Data {
 /////////////////////////////       Non-Class       ///////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! Set a view on a file so that a read of blocks separated by (stride-block) bytes appears contiguous
- *  \param[in] file The MPI-IO file handle
- *  \param[in] info The info structure to use
- *  \param[in] offset The offset in bytes from the start of the file
- *  \param[in] block The block size in bytes
- *  \param[in] stride The stride size in bytes block start to block start
- *  \param[in] count The number of blocks
- *  \param[out] type The datatype which will have been used to create a view
- *  \return Return an MPI error code.
- */
-int strideView(MPI_File file, MPI_Info info, MPI_Offset offset, int block, MPI_Aint stride, int count, MPI_Datatype * type)
-{
-    int err = MPI_Type_create_hvector(count, block, stride, MPI_CHAR, type);
-    if (err != MPI_SUCCESS)
-        return err;
-
-    err = MPI_Type_commit(type);
-    if (err != MPI_SUCCESS)
-        return err;
-
-    return MPI_File_set_view(file, offset, MPI_CHAR, *type, "native", info);
-}
-
 /*! Set a view on a file so that a read of random traces appears contiguous
  *  \param[in] file The MPI-IO file handle
  *  \param[in] info The info structure to use
@@ -46,20 +25,28 @@ int strideView(MPI_File file, MPI_Info info, MPI_Offset offset, int block, MPI_A
  *  \param[in] block The block size in bytes
  *  \param[in] offset An array of offsets in bytes from the start of the file of sizze count
  *  \param[out] type The datatype which will have been used to create a view
+ *  \param[in] len If not null, an array of the size in bytes of each block. The block size is ignored.
  *  \return Return an MPI error code.
  */
-int randBlockView(MPI_File file, MPI_Info info, int count, int block, const MPI_Aint * offset, MPI_Datatype * type)
+int randBlockView(MPI_File file, MPI_Info info, int count, int block, const MPI_Aint * offset, MPI_Datatype * type,
+                  const int * len = nullptr)
 {
+    int err;
+    if (len)
+        err = MPI_Type_create_hindexed(count, len, offset, MPI_CHAR, type);
+    else
+    {
     #ifndef HINDEXED_BLOCK_WORKS
-    std::vector<int> bl(count);
-    for (int i = 0; i < count; i++)
-        bl[i] = block;
-    assert(size_t(count) < std::numeric_limits<int>::max() / (sizeof(int) + sizeof(MPI_Aint)));
+        std::vector<int> bl(count);
+        for (int i = 0; i < count; i++)
+            bl[i] = block;
+        assert(size_t(count) < std::numeric_limits<int>::max() / (sizeof(int) + sizeof(MPI_Aint)));
 
-    int err = MPI_Type_create_hindexed(count, bl.data(), offset, MPI_CHAR, type);
+        err = MPI_Type_create_hindexed(count, bl.data(), offset, MPI_CHAR, type);
     #else
-    int err = MPI_Type_create_hindexed_block(count, block, offset, MPI_CHAR, type);
+        err = MPI_Type_create_hindexed_block(count, block, offset, MPI_CHAR, type);
     #endif
+    }
     if (err != MPI_SUCCESS)
         return err;
 
@@ -116,17 +103,19 @@ int mpiio_write_at_all(MPI_File f, MPI_Offset o, void * d, int s, MPI_Datatype d
  *  \param[in] offset The list of offsets in the file
  *  \param[in, out] d The I/O buffer
  *  \param[in] stat The MPI status object
+ *  \param[in] len If not null, the size in bytes of each block and bsz is the total size.
  *  \return Return the MPI error status
  */
-int iol(const MFp<MPI_Status> fn, MPI_File file, MPI_Info info, int bsz, int chunk, const MPI_Aint * offset, uchar * d, MPI_Status * stat)
+int iol(const MFp<MPI_Status> fn, MPI_File file, MPI_Info info, int bsz, int chunk, const MPI_Aint * offset, uchar * d,
+        MPI_Status * stat, const int * len = nullptr)
 {
     //Set a view so that MPI_File_read... functions only see contiguous data.
     MPI_Datatype type;
-    int err = randBlockView(file, info, chunk, bsz, offset, &type);
+    int err = randBlockView(file, info, chunk, bsz, offset, &type, len);
     if (err != MPI_SUCCESS)
         return err;
 
-    fn(file, 0, d, chunk*bsz, MPI_CHAR, stat);
+    err = fn(file, 0, d, (len ? bsz : chunk*bsz), MPI_CHAR, stat);
     if (err != MPI_SUCCESS)
         return err;
 
@@ -138,6 +127,172 @@ int iol(const MFp<MPI_Status> fn, MPI_File file, MPI_Info info, int bsz, int chu
     return MPI_Type_free(&type);
 }
 
+/*! Set a view on a file so that a read of runs of equally spaced blocks appears contiguous
+ *  \param[in] file The MPI-IO file handle
+ *  \param[in] info The info structure to use
+ *  \param[in] bsz The block size in bytes
+ *  \param[in] ext The runs of blocks
+ *  \param[out] type The datatype which will have been used to create a view
+ *  \return Return an MPI error code.
+ */
+int extentView(MPI_File file, MPI_Info info, int bsz, const std::vector<Extent> & ext, MPI_Datatype * type)
+{
+    std::vector<MPI_Datatype> types(ext.size(), MPI_DATATYPE_NULL);
+    std::vector<MPI_Aint> disp(ext.size());
+    std::vector<int> bl(ext.size(), 1);
+    int err = MPI_SUCCESS;
+    for (size_t i = 0; i < ext.size() && err == MPI_SUCCESS; i++)
+    {
+        disp[i] = MPI_Aint(ext[i].offset);
+        err = MPI_Type_create_hvector(int(ext[i].nb), bsz, MPI_Aint(ext[i].osz), MPI_CHAR, &types[i]);
+    }
+    if (err == MPI_SUCCESS)
+        err = MPI_Type_create_struct(int(ext.size()), bl.data(), disp.data(), types.data(), type);
+    for (auto & t : types)
+        if (t != MPI_DATATYPE_NULL)
+            MPI_Type_free(&t);
+    if (err != MPI_SUCCESS)
+        return err;
+
+    err = MPI_Type_commit(type);
+    if (err != MPI_SUCCESS)
+        return err;
+
+    return MPI_File_set_view(file, 0, MPI_BYTE, *type, "native", info);
+}
+
+/*! Perform I/O on runs of blocks by setting a view then performing the I/O
+ *  \param[in] fn A contiguous I/O function
+ *  \param[in] file The MPI file handle
+ *  \param[in] info The MPI info object
+ *  \param[in] bsz The block size
+ *  \param[in] chunk The number of blocks in the runs
+ *  \param[in] ext The runs of blocks
+ *  \param[in, out] d The I/O buffer
+ *  \param[in] stat The MPI status object
+ *  \return Return the MPI error status
+ */
+int iox(const MFp<MPI_Status> fn, MPI_File file, MPI_Info info, int bsz, int chunk, const std::vector<Extent> & ext,
+        uchar * d, MPI_Status * stat)
+{
+    MPI_Datatype type;
+    int err = extentView(file, info, bsz, ext, &type);
+    if (err != MPI_SUCCESS)
+        return err;
+
+    err = fn(file, 0, d, chunk*bsz, MPI_CHAR, stat);
+    if (err != MPI_SUCCESS)
+        return err;
+
+    err = MPI_File_set_view(file, 0, MPI_CHAR, MPI_CHAR, "native", info);
+    if (err != MPI_SUCCESS)
+        return err;
+
+    return MPI_Type_free(&type);
+}
+
+/*! Check the blocks of a set of runs are in increasing order and do not overlap, as needed by a view.
+ *  \param[in] bsz The block size in bytes
+ *  \param[in] ext The runs of blocks
+ *  \return True if the runs can be used for a view.
+ */
+bool monotonic(csize_t bsz, const std::vector<Extent> & ext)
+{
+    size_t end = 0U;
+    for (const auto & e : ext)
+        if (e.nb)
+        {
+            if (e.offset < end || (e.nb > 1U && e.osz < bsz))
+                return false;
+            end = e.offset + (e.nb - 1U) * e.osz + bsz;
+        }
+    return true;
+}
+
+/*! Find the span of a list of blocks or of runs of blocks
+ *  \param[in] bsz The block size in bytes
+ *  \param[in] sz The number of blocks
+ *  \param[in] offset The offsets in bytes of the blocks if ext is null
+ *  \param[in] ext The runs of blocks. They must be in increasing order.
+ *  \return The offsets in bytes of the start and end of the blocks, or zeros if there are none.
+ */
+std::pair<size_t, size_t> getSpan(csize_t bsz, csize_t sz, csize_t * offset, const std::vector<Extent> * ext)
+{
+    if (!sz || !bsz)
+        return std::make_pair(0U, 0U);
+    if (!ext)
+    {
+        auto lim = std::minmax_element(offset, offset + sz);
+        return std::make_pair(*lim.first, *lim.second + bsz);
+    }
+    size_t lo = 0U, hi = 0U;
+    for (const auto & e : *ext)
+        if (e.nb)
+        {
+            lo = (hi ? lo : e.offset);
+            hi = e.offset + (e.nb - 1U) * e.osz + bsz;
+        }
+    return std::make_pair(lo, hi);
+}
+
+/*! Merge blocks into runs where the gap between the end of one block and the start of the next is
+ *  at most gap bytes. The offsets must be sorted and the blocks must not overlap.
+ *  \param[in] bsz The block size in bytes
+ *  \param[in] sz The number of blocks
+ *  \param[in] offset The offsets in bytes of the blocks
+ *  \param[in] gap The largest gap in bytes to merge
+ *  \param[out] roff The offsets in bytes of the runs
+ *  \param[out] rlen The size in bytes of the runs
+ *  \return The total size of the runs in bytes or zero if no blocks could be merged.
+ */
+size_t sieveRuns(csize_t bsz, csize_t sz, csize_t * offset, csize_t gap, std::vector<MPI_Aint> & roff, std::vector<int> & rlen)
+{
+    roff.clear();
+    rlen.clear();
+    for (size_t i = 1; i < sz; i++)
+        if (offset[i] < offset[i-1] + bsz)
+            return 0U;
+
+    size_t total = 0U;
+    for (size_t i = 0; i < sz; i++)
+        if (i && offset[i] - size_t(roff.back() + rlen.back()) <= gap)
+            rlen.back() = int(offset[i] + bsz - roff.back());
+        else
+        {
+            if (i)
+                total += rlen.back();
+            roff.push_back(MPI_Aint(offset[i]));
+            rlen.push_back(int(bsz));
+        }
+    return (roff.size() < sz ? total + rlen.back() : 0U);
+}
+
+/*! Copy blocks between the I/O buffer and the staging buffer of the runs which contain them.
+ *  \param[in] toStage Whether to copy from the I/O buffer to the staging buffer
+ *  \param[in] bsz The block size in bytes
+ *  \param[in] sz The number of blocks
+ *  \param[in] offset The offsets in bytes of the blocks
+ *  \param[in] roff The offsets in bytes of the runs
+ *  \param[in] rlen The size in bytes of the runs
+ *  \param[in, out] stage The staging buffer which holds the runs back to back
+ *  \param[in, out] d The I/O buffer which holds the blocks back to back
+ */
+void sieveCopy(bool toStage, csize_t bsz, csize_t sz, csize_t * offset, const std::vector<MPI_Aint> & roff,
+               const std::vector<int> & rlen, uchar * stage, uchar * d)
+{
+    size_t r = 0U, base = 0U;
+    for (size_t i = 0; i < sz; i++)
+    {
+        while (offset[i] >= size_t(roff[r] + rlen[r]))
+            base += rlen[r++];
+        uchar * s = &stage[base + offset[i] - roff[r]];
+        if (toStage)
+            std::copy(&d[i*bsz], &d[(i+1U)*bsz], s);
+        else
+            std::copy(s, s + bsz, &d[i*bsz]);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////    Class functions    ///////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -146,10 +301,12 @@ int iol(const MFp<MPI_Status> fn, MPI_File file, MPI_Info info, int bsz, int chu
 Data::MPIIO::Opt::Opt(void)
 {
 #ifdef MPIIO_COLLECTIVES
-    coll = true;
+    mode = IOMode::Collective;
 #else
-    coll = false;
+    mode = IOMode::Independent;
 #endif
+    autoSz = getFabricPacketSz();
+    autoRatio = 4U;
     fcomm = MPI_COMM_WORLD;
     info = MPI_INFO_NULL;
     MPI_Info_create(&info);
@@ -170,6 +327,11 @@ Data::MPIIO::Opt::Opt(void)
 
 //    MPI_Info_set(info, "panfs_concurrent_write", "false");    //ROMIO has this on by default. Annoying.
     maxSize = getLim<int32_t>();
+    typeCache = 16U;
+    persistView = false;
+    sieveGap = 4096U;
+    sieveWrite = false;
+    ahead = 2U;
 }
 
 Data::MPIIO::Opt::~Opt(void)
@@ -211,6 +373,14 @@ MPIIO::MPIIO(Piol piol_, const std::string name_, FileMode mode) : PIOL::Data::I
 
 MPIIO::~MPIIO(void)
 {
+    dropAhead();
+    for (auto & t : types)
+        MPI_Type_free(&t.second);
+    if (ifile != MPI_FILE_NULL)
+    {
+        int err = MPI_File_close(&ifile);
+        printErr(log, name, Log::Layer::Data, err, nullptr, "MPI_File_close of the independent handle failed");
+    }
     if (file != MPI_FILE_NULL)
     {
         int err = MPI_File_close(&file);
@@ -225,9 +395,22 @@ MPIIO::~MPIIO(void)
 
 void MPIIO::Init(const MPIIO::Opt & opt, FileMode mode)
 {
-    coll = opt.coll;
+    this->mode = opt.mode;
+    autoSz = opt.autoSz;
+    autoRatio = std::max(opt.autoRatio, size_t(1U));
     maxSize = opt.maxSize;
+    typeCache = std::max(opt.typeCache, size_t(1U));
+    persistView = opt.persistView;
+    sieveGap = opt.sieveGap;
+    sieveWrite = opt.sieveWrite;
+    aheadMax = opt.ahead;
+    view.active = false;
+    aheadNext = false;
+    bound = 0U;
     file = MPI_FILE_NULL;
+    ifile = MPI_FILE_NULL;
+    cwrote = false;
+    iwrote = false;
     MPI_Aint lb, esz;
     int err = MPI_Type_get_true_extent(MPI_CHAR, &lb, &esz);
     printErr(log, name, Log::Layer::Data, err, nullptr, "Getting MPI extent failed");
@@ -238,6 +421,11 @@ void MPIIO::Init(const MPIIO::Opt & opt, FileMode mode)
     fcomm = opt.fcomm;
 
     int flags = getMPIMode(mode);
+    readable = !(flags & MPI_MODE_WRONLY);
+    //Independent I/O and read-ahead open the file a second time.
+    if (this->mode != IOMode::Collective || (aheadMax && readable))
+        flags &= ~MPI_MODE_UNIQUE_OPEN;
+    iflags = flags & ~(MPI_MODE_CREATE | MPI_MODE_DELETE_ON_CLOSE);
 
     if (opt.info != MPI_INFO_NULL)
     {
@@ -260,6 +448,7 @@ void MPIIO::Init(const MPIIO::Opt & opt, FileMode mode)
 ///////////////////////////////////       Member functions      ///////////////////////////////////
 size_t MPIIO::getFileSz() const
 {
+    syncFor(false);
     MPI_Offset fsz = 0;
     int err = MPI_File_get_size(file, &fsz);
     printErr(log, name, Log::Layer::Data, err, nullptr, "error getting the file size");
@@ -268,16 +457,214 @@ size_t MPIIO::getFileSz() const
 
 void MPIIO::setFileSz(csize_t sz) const
 {
+    dropAhead();
+    syncFor(false);
     int err = MPI_File_set_size(file, MPI_Offset(sz));
     printErr(log, name, Log::Layer::Data, err, nullptr, "error setting the file size");
 }
 
+MPI_File MPIIO::getIndep(void) const
+{
+    if (ifile == MPI_FILE_NULL && file != MPI_FILE_NULL)
+    {
+        int err = MPI_File_open(MPI_COMM_SELF, name.data(), iflags, info, &ifile);
+        printErr(log, name, Log::Layer::Data, err, nullptr, "MPI_File_open failure for independent I/O");
+        if (err != MPI_SUCCESS)
+            ifile = MPI_FILE_NULL;
+    }
+    return ifile;
+}
+
+void MPIIO::syncFor(bool indep) const
+{
+    if (indep && cwrote)
+    {
+        int err = MPI_File_sync(file);
+        printErr(log, name, Log::Layer::Data, err, nullptr, "MPI_File_sync of the collective handle failed");
+        cwrote = false;
+    }
+    else if (!indep && iwrote)
+    {
+        int err = MPI_File_sync(ifile);
+        printErr(log, name, Log::Layer::Data, err, nullptr, "MPI_File_sync of the independent handle failed");
+        iwrote = false;
+    }
+}
+
+MPI_Datatype MPIIO::getType(csize_t bsz, csize_t osz, csize_t nb) const
+{
+    const TypeKey key(bsz, osz, nb);
+    for (auto it = types.begin(); it != types.end(); it++)
+        if (it->first == key)
+        {
+            types.splice(types.begin(), types, it);
+            return it->second;
+        }
+
+    MPI_Datatype type;
+    int err;
+    if (nb == tile)
+    {
+        MPI_Datatype block;
+        err = MPI_Type_contiguous(int(bsz), MPI_CHAR, &block);
+        if (err == MPI_SUCCESS)
+        {
+            err = MPI_Type_create_resized(block, 0, MPI_Aint(osz), &type);
+            MPI_Type_free(&block);
+        }
+    }
+    else
+        err = MPI_Type_create_hvector(int(nb), int(bsz), MPI_Aint(osz), MPI_CHAR, &type);
+
+    if (err == MPI_SUCCESS)
+        err = MPI_Type_commit(&type);
+    printErr(log, name, Log::Layer::Data, err, NULL, "Failed to create a datatype for a view.");
+    if (err != MPI_SUCCESS)
+        return MPI_DATATYPE_NULL;
+
+    //Evict the least recently used datatype
+    if (types.size() >= typeCache)
+    {
+        MPI_Type_free(&types.back().second);
+        types.pop_back();
+    }
+    types.emplace_front(key, type);
+    return type;
+}
+
+size_t MPIIO::setView(csize_t offset, csize_t bsz, csize_t osz, csize_t nb) const
+{
+    int err = MPI_SUCCESS;
+    //A persistent view tiles single blocks so any access of the same shape and alignment can reuse it.
+    //The block and stride are the same on every process for a given access.
+    if (persistView && bsz && osz >= bsz)
+    {
+        csize_t disp = offset % osz;
+        //Setting a view is collective so every process must agree on whether it changes.
+        int change = (nb && !(view.active && view.bsz == bsz && view.osz == osz && view.disp == disp));
+        err = MPI_Allreduce(MPI_IN_PLACE, &change, 1, MPI_INT, MPI_MAX, fcomm);
+        printErr(log, name, Log::Layer::Data, err, NULL, "Failed to agree on a view.");
+        if (change)
+        {
+            //Processes without data keep their current view if they have one
+            if (nb || !view.active)
+            {
+                view.bsz = bsz;
+                view.osz = osz;
+                view.disp = disp;
+            }
+            view.active = true;
+            err = MPI_File_set_view(file, MPI_Offset(view.disp), MPI_CHAR, getType(view.bsz, view.osz, tile), "native", info);
+            printErr(log, name, Log::Layer::Data, err, NULL, "Failed to set a view.");
+        }
+        return (nb ? offset / osz * bsz : 0U);
+    }
+
+    resetView();
+    err = MPI_File_set_view(file, MPI_Offset(offset), MPI_CHAR, getType(bsz, osz, nb), "native", info);
+    printErr(log, name, Log::Layer::Data, err, NULL, "Failed to set a view.");
+    return 0U;
+}
+
+void MPIIO::resetView(void) const
+{
+    if (view.active)
+    {
+        int err = MPI_File_set_view(file, 0, MPI_CHAR, MPI_CHAR, "native", info);
+        printErr(log, name, Log::Layer::Data, err, NULL, "Failed to reset a view.");
+        view.active = false;
+    }
+}
+
+void MPIIO::prefetch(csize_t offset, csize_t sz) const
+{
+    //Syncing the collective handle would make the hint collective, so it is dropped instead
+    if (!aheadMax || !readable || cwrote)
+        return;
+    if (ahead.size() >= aheadMax)
+    {
+        int err = MPI_Waitall(int(ahead.front().req.size()), ahead.front().req.data(), MPI_STATUSES_IGNORE);
+        printErr(log, name, Log::Layer::Data, err, NULL, "Read-ahead failure");
+        ahead.pop_front();
+    }
+
+    ahead.emplace_back();
+    auto & a = ahead.back();
+    a.offset = offset;
+    a.d.resize(sz);
+    MPI_File f = (sz ? getIndep() : MPI_FILE_NULL);
+    for (size_t i = 0; i < sz && f != MPI_FILE_NULL; i += maxSize)
+    {
+        a.req.emplace_back();
+        int err = MPI_File_iread_at(f, MPI_Offset(offset + i), &a.d[i], int(std::min(sz - i, maxSize)), MPIType<uchar>(), &a.req.back());
+        printErr(log, name, Log::Layer::Data, err, NULL, "Read-ahead failure");
+    }
+}
+
+void MPIIO::dropAhead(void) const
+{
+    for (auto & a : ahead)
+    {
+        int err = MPI_Waitall(int(a.req.size()), a.req.data(), MPI_STATUSES_IGNORE);
+        printErr(log, name, Log::Layer::Data, err, NULL, "Read-ahead failure");
+    }
+    ahead.clear();
+    aheadNext = false;
+}
+
+bool MPIIO::fromAhead(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
+{
+    //Without usePrefetch the processes would have to agree, so only independent reads are served
+    const bool sure = aheadNext;
+    aheadNext = false;
+    if (!sure && (mode != IOMode::Independent || ahead.empty()))
+        return false;
+
+    csize_t end = (nb && bsz ? offset + (nb - 1U) * osz + bsz : offset);
+    auto a = ahead.end();
+    for (auto r = ahead.begin(); r != ahead.end(); ++r)
+        if (r->offset <= offset && end <= r->offset + r->d.size())
+            a = r;
+
+    if (a == ahead.end() && end != offset)
+    {
+        if (!sure)
+            return false;
+
+        //Every other process skips the collective read so this process reads alone
+        if (nb == 1U || bsz == osz)
+            chunkIO(MPI_File_read_at, getIndep(), offset, nb * bsz, d, "Read-ahead miss failure", 1U, 1U, maxSize, 0U);
+        else
+            readv(true, offset, bsz, osz, nb, d);
+        return true;
+    }
+
+    //A process with nothing to read is always served
+    if (a == ahead.end())
+    {
+        if (ahead.empty())
+            return true;
+        a = ahead.begin();
+    }
+
+    int err = MPI_Waitall(int(a->req.size()), a->req.data(), MPI_STATUSES_IGNORE);
+    printErr(log, name, Log::Layer::Data, err, NULL, "Read-ahead failure");
+    if (end != offset)
+        for (size_t i = 0; i < nb; i++)
+            std::copy(&a->d[offset + i * osz - a->offset], &a->d[offset + i * osz - a->offset] + bsz, &d[i * bsz]);
+    ahead.erase(a);
+    return true;
+}
+
 void MPIIO::read(csize_t offset, csize_t sz, uchar * d) const
 {
-    contigIO((coll ? MPI_File_read_at_all : MPI_File_read_at), offset, sz, d, " non-collective read Failure\n");
+    if (fromAhead(offset, sz, sz, 1U, d))
+        return;
+    resetView();
+    contigIO(MPI_File_read_at_all, MPI_File_read_at, offset, sz, d, " non-collective read Failure\n");
 }
 
-void MPIIO::readv(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
+void MPIIO::readv(bool indep, csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
 {
     if (nb*osz > size_t(maxSize))
     {
@@ -287,16 +674,30 @@ void MPIIO::readv(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar *
         log->record(name, Log::Layer::Data, Log::Status::Error, "Read overflows MPI settings: " + msg, Log::Verb::None);
     }
 
+    if (indep)
+    {
+        //The view of the independent handle only involves this process.
+        MPI_File f = getIndep();
+        int err = MPI_File_set_view(f, MPI_Offset(offset), MPI_CHAR, getType(bsz, osz, nb), "native", info);
+        printErr(log, name, Log::Layer::Data, err, NULL, "Failed to set a view.");
+        chunkIO(MPI_File_read_at, f, 0U, nb*bsz, d, "Failed to read through a view.", 1U, 1U, maxSize, 0U);
+        err = MPI_File_set_view(f, 0, MPI_CHAR, MPI_CHAR, "native", info);
+        printErr(log, name, Log::Layer::Data, err, NULL, "Failed to reset a view.");
+        return;
+    }
+
     //Set a view so that MPI_File_read... functions only see contiguous data.
-    MPI_Datatype view;
-    int err = strideView(file, info, offset, bsz, osz, nb, &view);
-    printErr(log, name, Log::Layer::Data, err, NULL, "Failed to set a view for reading.");
+    csize_t voff = setView(offset, bsz, osz, nb);
 
-    read(0U, nb*bsz, d);
+    //The caller already chose collective I/O and matched the number of calls. A call covers at most maxSize bytes.
+    chunkIO(MPI_File_read_at_all, file, voff, nb*bsz, d, "Failed to read through a view.", 1U, 1U, maxSize, (nb && bsz ? 0U : 1U));
 
     //Reset the view.
-    MPI_File_set_view(file, 0, MPI_CHAR, MPI_CHAR, "native", info);
-    MPI_Type_free(&view);
+    if (!view.active)
+    {
+        int err = MPI_File_set_view(file, 0, MPI_CHAR, MPI_CHAR, "native", info);
+        printErr(log, name, Log::Layer::Data, err, NULL, "Failed to reset a view.");
+    }
 }
 
 void MPIIO::read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
@@ -306,6 +707,9 @@ void MPIIO::read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d
      *  If MPI_Aint ignores the spec, then we are also constrained to this.
      *  TODO: Investigate which limit is the optimal choice if the need arises
     */
+    if (fromAhead(offset, bsz, osz, nb, d))
+        return;
+
     if (bsz > getFabricPacketSz() || (sizeof(MPI_Aint) < sizeof(size_t) && osz > maxSize))
         for (size_t i = 0; i < nb; i++)
             read(offset+i*osz, bsz, d);
@@ -315,66 +719,209 @@ void MPIIO::read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d
     auto viewIO = [this, offset, bsz, osz]
         (MPI_File file, MPI_Offset off, void * d, int numb, MPI_Datatype da, MPI_Status * stat) -> int
         {
-            readv(off, bsz, osz, size_t(numb), static_cast<uchar *>(d));
+            readv(file != this->file, off, bsz, osz, size_t(numb), static_cast<uchar *>(d));
             return MPI_SUCCESS;
         };
 #pragma GCC diagnostic pop
 
-    contigIO(viewIO, offset, nb, d, "Failed to read data over the integer limit.", bsz, osz);
+    contigIO(viewIO, viewIO, offset, nb, d, "Failed to read data over the integer limit.", bsz, osz);
 }
 
 
-void MPIIO::contigIO(const MFp<MPI_Status> fn, csize_t offset, csize_t sz,
-                     uchar * d, std::string msg, csize_t bsz, csize_t osz) const
+bool MPIIO::choose(csize_t sz, csize_t bsz, csize_t max, size_t * remCall) const
+{
+    *remCall = 0U;
+    if (mode == IOMode::Independent)
+        return true;
+
+    auto calls = [max] (csize_t n) -> size_t { return n / max + (n % max > 0); };
+
+    //The block size is the same on every process for a given call so they all take the same branch.
+    size_t biggest, total, active;
+    csize_t numRank = piol->comm->getNumRank();
+    if (bound && bsz)
+    {
+        biggest = bound / bsz;
+        total = biggest * numRank;
+        active = numRank;
+    }
+    else
+    {
+        auto vec = piol->comm->gather<size_t>(sz);
+        biggest = *std::max_element(vec.begin(), vec.end());
+        total = std::accumulate(vec.begin(), vec.end(), size_t(0U));
+        active = std::count_if(vec.begin(), vec.end(), [] (csize_t n) { return n > 0U; });
+    }
+
+    //Collective I/O costs every process a call and a synchronisation per round. It is not worth it
+    //when there is little data in total or when only a few processes have data to transfer.
+    if (mode == IOMode::Auto && (total * bsz <= autoSz || active * autoRatio <= numRank))
+        return true;
+
+    //The other processes make the calls the bound allows without knowing of this transfer, so the
+    //calls can not be matched. The job is aborted before any of them is made.
+    if (calls(sz) > calls(biggest))
+    {
+        log->record(name, Log::Layer::Data, Log::Status::Error, "Transfer of " + std::to_string(sz * bsz)
+                    + " bytes exceeds the bound of " + std::to_string(bound) + " bytes", Log::Verb::None);
+        log->procLog();
+        MPI_Abort(fcomm, EXIT_FAILURE);
+    }
+    *remCall = calls(biggest) - calls(sz);
+    return false;
+}
+
+void MPIIO::setBound(csize_t bound_) const
+{
+    bound = bound_;
+}
+
+void MPIIO::contigIO(const MFp<MPI_Status> cfn, const MFp<MPI_Status> ifn, csize_t offset, csize_t sz,
+                     uchar * d, std::string msg, csize_t bsz, csize_t osz, bool write) const
 {
-    MPI_Status stat;
-    int err = MPI_SUCCESS;
     size_t max = maxSize / osz;
-    size_t remCall = 0;
-    auto vec = piol->comm->gather<size_t>(sz);
-    remCall = *std::max_element(vec.begin(), vec.end());
-    remCall = remCall/max + (remCall % max > 0) - sz/max - (sz % max > 0);
+    size_t remCall;
+    bool indep = choose(sz, bsz, max, &remCall);
+    syncFor(indep);
+    if (indep)
+    {
+        if (sz)
+            chunkIO(ifn, getIndep(), offset, sz, d, msg, bsz, osz, max, 0U);
+        iwrote |= (write && sz);
+    }
+    else
+    {
+        chunkIO(cfn, file, offset, sz, d, msg, bsz, osz, max, remCall);
+        cwrote |= write;
+    }
+}
 
+void MPIIO::chunkIO(const MFp<MPI_Status> fn, MPI_File f, csize_t offset, csize_t sz, uchar * d, std::string msg,
+                    csize_t bsz, csize_t osz, csize_t max, csize_t remCall) const
+{
+    MPI_Status stat;
+    int err = MPI_SUCCESS;
     for (size_t i = 0; i < sz; i += max)
     {
         size_t chunk = std::min(sz - i, max);
-        err = fn(file, MPI_Offset(offset + osz*i), &d[bsz*i], chunk, MPIType<uchar>(), &stat);
+        err = fn(f, MPI_Offset(offset + osz*i), &d[bsz*i], chunk, MPIType<uchar>(), &stat);
         printErr(log, name, Log::Layer::Data, err, &stat, msg);
     }
 
     for (size_t i = 0; i < remCall; i++)
     {
-        err = fn(file, 0, NULL, 0, MPIType<uchar>(), &stat);
+        err = fn(f, 0, NULL, 0, MPIType<uchar>(), &stat);
         printErr(log, name, Log::Layer::Data, err, &stat, msg);
     }
 }
 
+bool MPIIO::disjoint(const std::pair<size_t, size_t> & span) const
+{
+    auto spans = piol->comm->gather(std::vector<size_t>{span.first, span.second});
+
+    std::vector<std::pair<size_t, size_t>> sorted;
+    for (size_t i = 0; i < spans.size(); i += 2U)
+        if (spans[i+1U])
+            sorted.emplace_back(spans[i], spans[i+1U]);
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 1; i < sorted.size(); i++)
+        if (sorted[i].first < sorted[i-1].second)
+            return false;
+    return true;
+}
+
 //Perform I/O to acquire data corresponding to fixed-size blocks of data located according to a list of offsets.
-void MPIIO::listIO(const MFp<MPI_Status> fn, csize_t bsz, csize_t sz, csize_t * offset, uchar * d, std::string msg) const
+void MPIIO::listIO(const MFp<MPI_Status> cfn, const MFp<MPI_Status> ifn, csize_t bsz, csize_t sz, csize_t * offset,
+                   uchar * d, std::string msg, bool write, const std::vector<Extent> * ext) const
 {
 //TODO: More accurately determine a real limit for setting a view.
 //      Is the problem strides that are too big?
-    size_t max = maxSize / (bsz ? bsz * 2U : 1U);
-    size_t remCall = 0;
-    {
-        auto vec = piol->comm->gather<size_t>(sz);
-        remCall = *std::max_element(vec.begin(), vec.end());
-        remCall = remCall / max + (remCall % max > 0) -  (sz / max) - (sz % max > 0);
-    }
+    //A sieved write reads and rewrites the gaps between its blocks so it is only safe if no other
+    //process writes there. Independent processes need not call so they cannot check.
+    bool sieve = sieveGap && bsz && (!write || (sieveWrite && readable && mode != IOMode::Independent && disjoint(getSpan(bsz, sz, offset, ext))));
+    bool rmw = write && sieve;
+
+    //A sieved chunk spans at most a block and a gap for each block, so only sieved chunks are cut down.
+    size_t max = maxSize / (bsz ? (bsz + (sieve ? sieveGap : 0U)) * 2U : 1U);
+    size_t remCall;
+    bool indep = choose(sz, bsz, max, &remCall);
+    syncFor(indep);
+
+    if (indep && !sz)
+        return;
+    MPI_File f = (indep ? getIndep() : file);
+    (indep ? iwrote : cwrote) |= write;
+    auto fn = (indep ? ifn : cfn);
+    MFp<MPI_Status> rfn = (indep ? MPI_File_read_at : MPI_File_read_at_all);
+
+    //List I/O sets its own views
+    if (!indep)
+        resetView();
 
     int err = MPI_SUCCESS;
     MPI_Status stat;
+    std::vector<uchar> stage;
+    std::vector<MPI_Aint> roff;
+    std::vector<int> rlen;
+    std::vector<Extent> cext;
+    size_t e = 0U, j = 0U;  //The next block of the runs is block j of run e
     for (size_t i = 0; i < sz && err == MPI_SUCCESS; i += max)
     {
         size_t chunk = std::min(sz - i, max);
-        err = iol(fn, file, info, bsz, chunk, reinterpret_cast<const MPI_Aint *>(&offset[i]), &d[i*bsz], &stat);
+        if (ext)
+        {
+            //Take the runs, or parts of runs, which hold the blocks of this chunk
+            cext.clear();
+            for (size_t n = 0U; n < chunk; e++, j = 0U)
+            {
+                const Extent & x = (*ext)[e];
+                size_t cnt = std::min(x.nb - j, chunk - n);
+                if (cnt)
+                    cext.push_back({x.offset + j * x.osz, cnt, x.osz});
+                n += cnt;
+                if (j + cnt < x.nb)
+                {
+                    j += cnt;
+                    break;
+                }
+            }
+            if (rmw && !indep)
+                iol(rfn, f, info, 0, 0, nullptr, nullptr, &stat);
+            err = iox(fn, f, info, bsz, chunk, cext, &d[i*bsz], &stat);
+            printErr(log, name, Log::Layer::Data, err, &stat, msg);
+            continue;
+        }
+
+        size_t total = (sieve ? sieveRuns(bsz, chunk, &offset[i], sieveGap, roff, rlen) : 0U);
+        if (total)
+        {
+            stage.resize(total);
+            if (rmw)
+            {
+                err = iol(rfn, f, info, total, roff.size(), roff.data(), stage.data(), &stat, rlen.data());
+                printErr(log, name, Log::Layer::Data, err, &stat, msg);
+                sieveCopy(true, bsz, chunk, &offset[i], roff, rlen, stage.data(), &d[i*bsz]);
+            }
+            err = iol(fn, f, info, total, roff.size(), roff.data(), stage.data(), &stat, rlen.data());
+            if (!write)
+                sieveCopy(false, bsz, chunk, &offset[i], roff, rlen, stage.data(), &d[i*bsz]);
+        }
+        else
+        {
+            //Every process makes the same calls for each chunk of a sieved write
+            if (rmw && !indep)
+                iol(rfn, f, info, 0, 0, nullptr, nullptr, &stat);
+            err = iol(fn, f, info, bsz, chunk, reinterpret_cast<const MPI_Aint *>(&offset[i]), &d[i*bsz], &stat);
+        }
         printErr(log, name, Log::Layer::Data, err, &stat, msg);
     }
 
     if (remCall)
         for (size_t i = 0; i < remCall; i++)
         {
-            err = iol(fn, file, info, 0, 0, nullptr, nullptr, &stat);
+            if (rmw)
+                iol(rfn, f, info, 0, 0, nullptr, nullptr, &stat);
+            err = iol(fn, f, info, 0, 0, nullptr, nullptr, &stat);
             printErr(log, name, Log::Layer::Data, err, &stat, msg);
         }
 }
@@ -385,20 +932,44 @@ void MPIIO::read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const
         for (size_t i = 0; i < sz; i++)
             read(offset[i], bsz, d);
 
-   listIO((coll ? MPI_File_read_at_all : MPI_File_read_at), bsz, sz, offset, d, "list read failure");
+   listIO(MPI_File_read_at_all, MPI_File_read_at, bsz, sz, offset, d, "list read failure");
+}
+
+void MPIIO::read(csize_t bsz, const std::vector<Extent> & ext, uchar * d) const
+{
+    if (bsz > getFabricPacketSz() || !monotonic(bsz, ext))
+        return Interface::read(bsz, ext, d);
+
+    size_t sz = 0U;
+    for (const auto & e : ext)
+        sz += e.nb;
+    listIO(MPI_File_read_at_all, MPI_File_read_at, bsz, sz, nullptr, d, "extent read failure", false, &ext);
+}
+
+void MPIIO::write(csize_t bsz, const std::vector<Extent> & ext, const uchar * d) const
+{
+    dropAhead();
+    if (bsz > getFabricPacketSz() || !monotonic(bsz, ext))
+        return Interface::write(bsz, ext, d);
+
+    size_t sz = 0U;
+    for (const auto & e : ext)
+        sz += e.nb;
+    listIO(mpiio_write_at_all, mpiio_write_at, bsz, sz, nullptr, const_cast<uchar *>(d), "extent write failure", true, &ext);
 }
 
 void MPIIO::write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const
 {
+    dropAhead();
     if (bsz > getFabricPacketSz())
         for (size_t i = 0; i < sz; i++)
             write(offset[i], bsz, d);
 
 
-    listIO((coll ? mpiio_write_at_all : mpiio_write_at), bsz, sz, offset, const_cast<uchar *>(d), "list write failure");
+    listIO(mpiio_write_at_all, mpiio_write_at, bsz, sz, offset, const_cast<uchar *>(d), "list write failure", true);
 }
 
-void MPIIO::writev(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const
+void MPIIO::writev(bool indep, csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const
 {
     if (nb*osz > size_t(maxSize))
     {
@@ -408,25 +979,41 @@ void MPIIO::writev(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const u
         log->record(name, Log::Layer::Data, Log::Status::Error, "Write overflows MPI settings: " + msg, Log::Verb::None);
     }
 
-    //Set a view so that MPI_File_read... functions only see contiguous data.
-    MPI_Datatype view;
-    int err = strideView(file, info, offset, bsz, osz, nb, &view);
-    printErr(log, name, Log::Layer::Data, err, NULL, "Failed to set a view for reading.");
+    if (indep)
+    {
+        MPI_File f = getIndep();
+        int err = MPI_File_set_view(f, MPI_Offset(offset), MPI_CHAR, getType(bsz, osz, nb), "native", info);
+        printErr(log, name, Log::Layer::Data, err, NULL, "Failed to set a view.");
+        chunkIO(mpiio_write_at, f, 0U, nb*bsz, const_cast<uchar *>(d), "Failed to write through a view.", 1U, 1U, maxSize, 0U);
+        err = MPI_File_set_view(f, 0, MPI_CHAR, MPI_CHAR, "native", info);
+        printErr(log, name, Log::Layer::Data, err, NULL, "Failed to reset a view.");
+        return;
+    }
+
+    //Set a view so that MPI_File_write... functions only see contiguous data.
+    csize_t voff = setView(offset, bsz, osz, nb);
 
-    write(0U, nb*bsz, d);
+    //The caller already chose collective I/O and matched the number of calls. A call covers at most maxSize bytes.
+    chunkIO(mpiio_write_at_all, file, voff, nb*bsz, const_cast<uchar *>(d), "Failed to write through a view.", 1U, 1U, maxSize, (nb && bsz ? 0U : 1U));
 
     //Reset the view.
-    MPI_File_set_view(file, 0, MPI_CHAR, MPI_CHAR, "native", info);
-    MPI_Type_free(&view);
+    if (!view.active)
+    {
+        int err = MPI_File_set_view(file, 0, MPI_CHAR, MPI_CHAR, "native", info);
+        printErr(log, name, Log::Layer::Data, err, NULL, "Failed to reset a view.");
+    }
 }
 
 void MPIIO::write(csize_t offset, csize_t sz, const uchar * d) const
 {
-    contigIO((coll ? mpiio_write_at_all : mpiio_write_at), offset, sz, const_cast<uchar *>(d), "Non-collective write failure.");
+    dropAhead();
+    resetView();
+    contigIO(mpiio_write_at_all, mpiio_write_at, offset, sz, const_cast<uchar *>(d), "Non-collective write failure.", 1U, 1U, true);
 }
 
 void MPIIO::write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const
 {
+    dropAhead();
     /*
      *  If the bsz size is very large, we may as well read do this as a sequence of separate reads.
      *  If MPI_Aint ignores the spec, then we are also contrained to this.
@@ -440,11 +1027,11 @@ void MPIIO::write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uc
     auto viewIO = [this, offset, bsz, osz]
         (MPI_File file, MPI_Offset off, void * d, int numb, MPI_Datatype da, MPI_Status * stat) -> int
         {
-            writev(off, bsz, osz, size_t(numb), static_cast<uchar *>(d));
+            writev(file != this->file, off, bsz, osz, size_t(numb), static_cast<uchar *>(d));
             return MPI_SUCCESS;
         };
 #pragma GCC diagnostic pop
 
-    contigIO(viewIO, offset, nb, const_cast<uchar *>(d), "Failed to read data over the integer limit.", bsz, osz);
+    contigIO(viewIO, viewIO, offset, nb, const_cast<uchar *>(d), "Failed to write data over the integer limit.", bsz, osz, true);
 }
 }}
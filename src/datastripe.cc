@@ -0,0 +1,308 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief
+ *   \details
+ *//*******************************************************************************************/
+#include <unistd.h>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "data/datastripe.hh"
+#include "share/mpi.hh"
+
+namespace PIOL { namespace Data {
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////       Non-Class       ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! Get the name of the manifest of a logical file
+ *  \param[in] name The name of the logical file
+ *  \return The name of the manifest
+ */
+std::string manifestName(const std::string & name)
+{
+    return name + ".stripe";
+}
+
+/*! Get the directory of a file, including the trailing separator
+ *  \param[in] name The name of the file
+ *  \return The directory or an empty string for the current directory
+ */
+std::string dirName(const std::string & name)
+{
+    auto p = name.rfind('/');
+    return (p != std::string::npos ? name.substr(0U, p + 1U) : "");
+}
+
+//Runs of at least this many bytes on a part are transferred on their own. Shorter runs go through
+//list I/O, which is kept well below the size where MPIIO splits lists into single blocks.
+csize_t directSz = 64U*1024U;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////    Class functions    ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////      Constructor & Destructor      ///////////////////////////////
+Stripe::Opt::Opt(void)
+{
+    nparts = 4U;
+    unit = 4U*1024U*1024U;
+    fcomm = MPI_COMM_WORLD;
+}
+
+Stripe::Stripe(const Piol piol_, const std::string name_, const Stripe::Opt & opt, FileMode mode) : Interface(piol_, name_)
+{
+    Init(opt, mode);
+}
+
+Stripe::Stripe(const Piol piol_, const std::string name_, FileMode mode) : Interface(piol_, name_)
+{
+    const Stripe::Opt opt;
+    Init(opt, mode);
+}
+
+Stripe::~Stripe(void)
+{
+    //The parts of a test file delete themselves on close.
+    parts.clear();
+    if (remove)
+    {
+        MPI_Barrier(fcomm);
+        int rank;
+        MPI_Comm_rank(fcomm, &rank);
+        if (!rank)
+            unlink(manifestName(name).c_str());
+    }
+}
+
+bool Stripe::isStriped(const Piol piol, const std::string & name)
+{
+    //Only the first process touches the file system
+    size_t found = 0U;
+    if (!piol->comm->getRank())
+        found = !access(manifestName(name).c_str(), F_OK);
+    return piol->comm->max(found);
+}
+
+bool Stripe::readManifest(std::vector<std::string> & pnames)
+{
+    int rank;
+    MPI_Comm_rank(fcomm, &rank);
+    std::string text;
+    size_t sz = 0U;
+    if (!rank)
+    {
+        std::ifstream in(manifestName(name));
+        std::stringstream ss;
+        ss << in.rdbuf();
+        text = (in ? ss.str() : "");
+        sz = text.size();
+    }
+    int err = MPI_Bcast(&sz, 1, MPIType<size_t>(), 0, fcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Sharing the stripe manifest failed");
+    text.resize(sz);
+    err = MPI_Bcast(&text[0], int(sz), MPI_CHAR, 0, fcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Sharing the stripe manifest failed");
+
+    std::istringstream in(text);
+    std::string line, key, val;
+    if (!std::getline(in, line) || line != "ExSeisDat stripe")
+        return false;
+    unit = 0U;
+    while (in >> key >> val)
+        if (key == "unit")
+            unit = std::stoul(val);
+        else if (key == "part")
+            pnames.push_back(val);
+    return unit && pnames.size();
+}
+
+void Stripe::Init(const Stripe::Opt & opt, FileMode mode)
+{
+    fcomm = opt.fcomm;
+    remove = (mode == FileMode::Test);
+    std::vector<std::string> pnames;
+
+    //A new layout is made for files opened for writing alone, otherwise the layout is read.
+    if (mode == FileMode::Write || mode == FileMode::Test || (mode == FileMode::ReadWrite && !isStriped(piol, name)))
+    {
+        unit = opt.unit;
+        pnames = opt.parts;
+        if (pnames.empty())
+        {
+            std::string base = name.substr(dirName(name).size());
+            for (size_t i = 0; i < opt.nparts; i++)
+                pnames.push_back(base + ".part" + std::to_string(i));
+        }
+        if (!unit || pnames.empty())
+        {
+            log->record(name, Log::Layer::Data, Log::Status::Error, "A striped file needs a stripe unit and at least one part", Log::Verb::None);
+            return;
+        }
+
+        int rank;
+        MPI_Comm_rank(fcomm, &rank);
+        if (!rank)
+        {
+            std::ofstream out(manifestName(name));
+            out << "ExSeisDat stripe\nunit " << unit << "\n";
+            for (auto & p : pnames)
+                out << "part " << p << "\n";
+            if (!out)
+                log->record(name, Log::Layer::Data, Log::Status::Error, "Writing the stripe manifest failed", Log::Verb::None);
+        }
+        MPI_Barrier(fcomm);
+    }
+    else if (!readManifest(pnames))
+    {
+        log->record(name, Log::Layer::Data, Log::Status::Error, "The stripe manifest is missing or invalid", Log::Verb::None);
+        return;
+    }
+
+    //Processes do not share the parts block by block, so independent I/O is used.
+    MPIIO::Opt popt;
+    popt.mode = IOMode::Independent;
+    popt.fcomm = fcomm;
+    for (auto & p : pnames)
+        parts.push_back(std::make_shared<MPIIO>(piol, (p[0] == '/' ? p : dirName(name) + p), popt, mode));
+}
+
+///////////////////////////////////       Member functions      ///////////////////////////////////
+size_t Stripe::getFileSz() const
+{
+    //The logical size is the end of the furthest stripe unit held by any part.
+    csize_t np = parts.size();
+    size_t fsz = 0U;
+    for (size_t p = 0; p < np; p++)
+    {
+        csize_t psz = parts[p]->getFileSz();
+        if (!psz)
+            continue;
+        csize_t s = (psz - 1U) / unit;
+        fsz = std::max(fsz, (s * np + p) * unit + (psz - s * unit));
+    }
+    return fsz;
+}
+
+void Stripe::setFileSz(csize_t sz) const
+{
+    csize_t np = parts.size();
+    csize_t s = sz / unit;
+    for (size_t p = 0; p < np; p++)
+        parts[p]->setFileSz(s / np * unit + (p < s % np ? unit : 0U) + (p == s % np ? sz % unit : 0U));
+}
+
+void Stripe::blockIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const
+{
+    csize_t np = parts.size();
+    if (!np)
+        return;
+
+    //The pieces of the blocks on each part
+    std::vector<std::vector<std::pair<size_t, std::pair<size_t, uchar *>>>> pieces(np);
+    for (size_t i = 0; i < nb; i++)
+    {
+        csize_t offset = off(i);
+        for (size_t pos = offset; pos < offset + bsz;)
+        {
+            csize_t s = pos / unit;
+            csize_t len = std::min((s + 1U) * unit, offset + bsz) - pos;
+            pieces[s % np].push_back({s / np * unit + pos % unit, {len, &d[i*bsz + pos - offset]}});
+            pos += len;
+        }
+    }
+
+    std::map<size_t, std::vector<std::pair<size_t, uchar *>>> small;
+    std::vector<size_t> poff;
+    std::vector<uchar> stage;
+    for (size_t p = 0; p < np; p++)
+    {
+        //Pieces which follow each other both on the part and in memory are merged into runs.
+        //Long runs are transferred on their own straight to or from the caller's memory.
+        auto & pc = pieces[p];
+        std::sort(pc.begin(), pc.end());
+        const MPIIO & part = *parts[p];
+        small.clear();
+        for (size_t j = 0; j < pc.size();)
+        {
+            csize_t start = pc[j].first;
+            uchar * at = pc[j].second.second;
+            size_t len = pc[j].second.first;
+            for (j++; j < pc.size() && pc[j].first == start + len && pc[j].second.second == at + len; j++)
+                len += pc[j].second.first;
+            if (len < directSz)
+                small[len].emplace_back(start, at);
+            else if (write)
+                part.write(start, len, at);
+            else
+                part.read(start, len, at);
+        }
+
+        //Short runs of the same length are transferred together with list I/O. MPI-IO lists must
+        //be in file order, which the runs already are.
+        for (auto & g : small)
+        {
+            csize_t len = g.first;
+            auto & rn = g.second;
+            if (rn.size() == 1U)
+            {
+                if (write)
+                    part.write(rn[0].first, len, rn[0].second);
+                else
+                    part.read(rn[0].first, len, rn[0].second);
+                continue;
+            }
+            poff.resize(rn.size());
+            stage.resize(rn.size() * len);
+            for (size_t j = 0; j < rn.size(); j++)
+            {
+                poff[j] = rn[j].first;
+                if (write)
+                    std::copy(rn[j].second, rn[j].second + len, &stage[j * len]);
+            }
+            if (write)
+                part.write(len, poff.size(), poff.data(), stage.data());
+            else
+            {
+                part.read(len, poff.size(), poff.data(), stage.data());
+                for (size_t j = 0; j < rn.size(); j++)
+                    std::copy(&stage[j * len], &stage[(j + 1U) * len], rn[j].second);
+            }
+        }
+    }
+}
+
+void Stripe::read(csize_t offset, csize_t sz, uchar * d) const
+{
+    blockIO(false, sz, 1U, [offset] (size_t) { return offset; }, d);
+}
+
+void Stripe::read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
+{
+    blockIO(false, bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, d);
+}
+
+void Stripe::read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const
+{
+    blockIO(false, bsz, sz, [offset] (size_t i) { return offset[i]; }, d);
+}
+
+void Stripe::write(csize_t offset, csize_t sz, const uchar * d) const
+{
+    blockIO(true, sz, 1U, [offset] (size_t) { return offset; }, const_cast<uchar *>(d));
+}
+
+void Stripe::write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const
+{
+    blockIO(true, bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, const_cast<uchar *>(d));
+}
+
+void Stripe::write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const
+{
+    blockIO(true, bsz, sz, [offset] (size_t i) { return offset[i]; }, const_cast<uchar *>(d));
+}
+}}
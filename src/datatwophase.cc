@@ -0,0 +1,323 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief
+ *   \details
+ *//*******************************************************************************************/
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include "data/datatwophase.hh"
+#include "share/mpi.hh"
+
+namespace PIOL { namespace Data {
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////    Class functions    ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////      Constructor & Destructor      ///////////////////////////////
+TwoPhase::Opt::Opt(void)
+{
+    aggPerNode = 1U;
+    stripe = 1024U*1024U;
+    gap = 64U*1024U;
+    round = 16U*1024U*1024U;
+    fcomm = MPI_COMM_WORLD;
+}
+
+TwoPhase::TwoPhase(const Piol piol_, const std::string name_, const TwoPhase::Opt & opt, FileMode mode) : Interface(piol_, name_)
+{
+    Init(opt, mode);
+}
+
+TwoPhase::TwoPhase(const Piol piol_, const std::string name_, FileMode mode) : Interface(piol_, name_)
+{
+    const TwoPhase::Opt opt;
+    Init(opt, mode);
+}
+
+TwoPhase::~TwoPhase(void)
+{
+    file.reset();
+    if (acomm != MPI_COMM_NULL)
+        MPI_Comm_free(&acomm);
+    if (gcomm != MPI_COMM_NULL)
+        MPI_Comm_free(&gcomm);
+}
+
+void TwoPhase::Init(const TwoPhase::Opt & opt, FileMode mode)
+{
+    fcomm = opt.fcomm;
+    gcomm = MPI_COMM_NULL;
+    acomm = MPI_COMM_NULL;
+    stripe = std::max(opt.stripe, size_t(1U));
+    gap = opt.gap;
+
+    //The processes of a node are dealt out to the aggregators of the node in turn.
+    int rank, nrank, nsize;
+    MPI_Comm ncomm;
+    MPI_Comm_rank(fcomm, &rank);
+    int err = MPI_Comm_split_type(fcomm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &ncomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Splitting the processes by node failed");
+    if (err != MPI_SUCCESS)
+        return;
+    MPI_Comm_rank(ncomm, &nrank);
+    MPI_Comm_size(ncomm, &nsize);
+    int nagg = int(std::min(std::max(opt.aggPerNode, size_t(1U)), size_t(nsize)));
+    err = MPI_Comm_split(ncomm, nrank % nagg, nrank, &gcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Splitting the processes by aggregator failed");
+    MPI_Comm_free(&ncomm);
+
+    err = MPI_Comm_split(fcomm, (nrank < nagg ? 0 : MPI_UNDEFINED), rank, &acomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Making the aggregator communicator failed");
+
+    //The byte counts and displacements of a round must fit in an int.
+    int fsize;
+    MPI_Comm_size(fcomm, &fsize);
+    round = std::max(std::min(opt.round, size_t(std::numeric_limits<int>::max()) / size_t(fsize)), size_t(1U));
+
+    MPIIO::Opt dopt;
+    dopt.mode = IOMode::Independent;
+    dopt.fcomm = fcomm;
+    file = std::make_unique<MPIIO>(piol, name, dopt, mode);
+}
+
+///////////////////////////////////       Member functions      ///////////////////////////////////
+size_t TwoPhase::getFileSz() const
+{
+    return (file != nullptr ? file->getFileSz() : 0U);
+}
+
+void TwoPhase::setFileSz(csize_t sz) const
+{
+    if (file != nullptr)
+        file->setFileSz(sz);
+}
+
+void TwoPhase::domainIO(bool write, const std::vector<size_t> & off, const std::vector<size_t> & len, uchar * d) const
+{
+    std::vector<size_t> pos(off.size() + 1U, 0U);
+    std::partial_sum(len.begin(), len.end(), pos.begin() + 1U);
+    std::vector<size_t> order(off.size());
+    std::iota(order.begin(), order.end(), 0U);
+    std::stable_sort(order.begin(), order.end(), [&off] (size_t a, size_t b) { return off[a] < off[b]; });
+
+    //Pieces which touch or overlap form a run. Reads also take in small gaps.
+    std::vector<uchar> buf;
+    for (size_t i = 0; i < order.size();)
+    {
+        csize_t start = off[order[i]];
+        size_t end = start + len[order[i]];
+        size_t j = i + 1U;
+        for (; j < order.size() && off[order[j]] <= end + (write ? 0U : gap); j++)
+            end = std::max(end, off[order[j]] + len[order[j]]);
+
+        buf.assign(end - start, 0U);
+        if (write)
+        {
+            for (size_t k = i; k < j; k++)
+                std::copy(&d[pos[order[k]]], &d[pos[order[k] + 1U]], &buf[off[order[k]] - start]);
+            file->write(start, buf.size(), buf.data());
+        }
+        else
+        {
+            file->read(start, buf.size(), buf.data());
+            for (size_t k = i; k < j; k++)
+                std::copy(&buf[off[order[k]] - start], &buf[off[order[k]] - start + len[order[k]]], &d[pos[order[k]]]);
+        }
+        i = j;
+    }
+}
+
+void TwoPhase::exchange(bool write, const std::vector<size_t> & off, const std::vector<size_t> & len, uchar * d) const
+{
+    int gsize, grank;
+    MPI_Comm_size(gcomm, &gsize);
+    MPI_Comm_rank(gcomm, &grank);
+    const MPI_Datatype stype = MPIType<size_t>();
+
+    //Phase one: the processes of a node send their pieces to their aggregator.
+    int n = int(off.size());
+    int nbytes = int(std::accumulate(len.begin(), len.end(), size_t(0U)));
+    std::vector<int> cnt(grank ? 0U : gsize), bcnt(grank ? 0U : gsize);
+    int err = MPI_Gather(&n, 1, MPI_INT, cnt.data(), 1, MPI_INT, 0, gcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase gather of counts failed");
+    err = MPI_Gather(&nbytes, 1, MPI_INT, bcnt.data(), 1, MPI_INT, 0, gcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase gather of counts failed");
+
+    auto disp = getDispls(cnt);
+    auto bdisp = getDispls(bcnt);
+    size_t total = (grank ? 0U : size_t(std::accumulate(cnt.begin(), cnt.end(), 0)));
+    size_t btotal = (grank ? 0U : size_t(std::accumulate(bcnt.begin(), bcnt.end(), 0)));
+    std::vector<size_t> goff(total), glen(total);
+    std::vector<uchar> gdata(btotal);
+    err = MPI_Gatherv(off.data(), n, stype, goff.data(), cnt.data(), disp.data(), stype, 0, gcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase gather of offsets failed");
+    err = MPI_Gatherv(len.data(), n, stype, glen.data(), cnt.data(), disp.data(), stype, 0, gcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase gather of sizes failed");
+    if (write)
+    {
+        err = MPI_Gatherv(d, nbytes, MPI_BYTE, gdata.data(), bcnt.data(), bdisp.data(), MPI_BYTE, 0, gcomm);
+        printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase gather of data failed");
+    }
+
+    if (acomm != MPI_COMM_NULL)
+    {
+        //Phase two: the aggregators split the span of the request into stripe aligned domains.
+        int asize;
+        MPI_Comm_size(acomm, &asize);
+        size_t lo = std::numeric_limits<size_t>::max(), hi = 0U;
+        for (size_t i = 0; i < total; i++)
+            if (glen[i])
+            {
+                lo = std::min(lo, goff[i]);
+                hi = std::max(hi, goff[i] + glen[i]);
+            }
+        err = MPI_Allreduce(MPI_IN_PLACE, &lo, 1, stype, MPI_MIN, acomm);
+        printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase reduction of the span failed");
+        err = MPI_Allreduce(MPI_IN_PLACE, &hi, 1, stype, MPI_MAX, acomm);
+        printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase reduction of the span failed");
+
+        if (lo < hi)
+        {
+            csize_t base = lo / stripe * stripe;
+            csize_t dsz = ((hi - base + size_t(asize) - 1U) / size_t(asize) + stripe - 1U) / stripe * stripe;
+
+            //Cut the pieces at the domain boundaries
+            std::vector<std::vector<size_t>> toff(asize), tlen(asize);
+            std::vector<std::vector<uchar *>> tptr(asize);
+            for (size_t i = 0, p = 0; i < total; p += glen[i++])
+                for (size_t o = goff[i]; o < goff[i] + glen[i];)
+                {
+                    csize_t t = (o - base) / dsz;
+                    csize_t e = std::min(base + (t + 1U) * dsz, goff[i] + glen[i]);
+                    toff[t].push_back(o);
+                    tlen[t].push_back(e - o);
+                    tptr[t].push_back(&gdata[p + o - goff[i]]);
+                    o = e;
+                }
+
+            std::vector<int> scnt(asize), rcnt(asize), sb(asize, 0), rb(asize, 0);
+            std::vector<size_t> soff, slen;
+            for (int t = 0; t < asize; t++)
+            {
+                scnt[t] = int(toff[t].size());
+                soff.insert(soff.end(), toff[t].begin(), toff[t].end());
+                slen.insert(slen.end(), tlen[t].begin(), tlen[t].end());
+                sb[t] = int(std::accumulate(tlen[t].begin(), tlen[t].end(), size_t(0U)));
+            }
+            err = MPI_Alltoall(scnt.data(), 1, MPI_INT, rcnt.data(), 1, MPI_INT, acomm);
+            printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase exchange of counts failed");
+            auto sdisp = getDispls(scnt);
+            auto rdisp = getDispls(rcnt);
+            std::vector<size_t> roff(rdisp.back() + rcnt.back()), rlen(roff.size());
+            err = MPI_Alltoallv(soff.data(), scnt.data(), sdisp.data(), stype, roff.data(), rcnt.data(), rdisp.data(), stype, acomm);
+            printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase exchange of offsets failed");
+            err = MPI_Alltoallv(slen.data(), scnt.data(), sdisp.data(), stype, rlen.data(), rcnt.data(), rdisp.data(), stype, acomm);
+            printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase exchange of sizes failed");
+
+            for (int s = 0; s < asize; s++)
+                rb[s] = int(std::accumulate(rlen.data() + rdisp[s], rlen.data() + rdisp[s] + rcnt[s], size_t(0U)));
+            auto sbdisp = getDispls(sb);
+            auto rbdisp = getDispls(rb);
+            std::vector<uchar> sdata(sbdisp.back() + sb.back()), rdata(rbdisp.back() + rb.back());
+
+            if (write)
+            {
+                for (int t = 0, q = 0; t < asize; t++)
+                    for (size_t k = 0; k < toff[t].size(); q += int(tlen[t][k++]))
+                        std::copy(tptr[t][k], tptr[t][k] + tlen[t][k], &sdata[q]);
+                err = MPI_Alltoallv(sdata.data(), sb.data(), sbdisp.data(), MPI_BYTE, rdata.data(), rb.data(), rbdisp.data(), MPI_BYTE, acomm);
+                printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase exchange of data failed");
+                domainIO(true, roff, rlen, rdata.data());
+            }
+            else
+            {
+                domainIO(false, roff, rlen, rdata.data());
+                err = MPI_Alltoallv(rdata.data(), rb.data(), rbdisp.data(), MPI_BYTE, sdata.data(), sb.data(), sbdisp.data(), MPI_BYTE, acomm);
+                printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase exchange of data failed");
+                for (int t = 0, q = 0; t < asize; t++)
+                    for (size_t k = 0; k < toff[t].size(); q += int(tlen[t][k++]))
+                        std::copy(&sdata[q], &sdata[q] + tlen[t][k], tptr[t][k]);
+            }
+        }
+    }
+
+    if (!write)
+    {
+        err = MPI_Scatterv(gdata.data(), bcnt.data(), bdisp.data(), MPI_BYTE, d, nbytes, MPI_BYTE, 0, gcomm);
+        printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase scatter of data failed");
+    }
+}
+
+void TwoPhase::blockIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const
+{
+    if (file == nullptr)
+        return;
+
+    //Blocks are cut into pieces of at most a round and the pieces are packed into rounds.
+    std::vector<size_t> poff, plen, rstart(1U, 0U);
+    size_t rbytes = 0U;
+    for (size_t i = 0; i < nb; i++)
+        for (size_t j = 0; j < bsz; j += round)
+        {
+            csize_t len = std::min(round, bsz - j);
+            if (rbytes + len > round && rbytes)
+            {
+                rstart.push_back(poff.size());
+                rbytes = 0U;
+            }
+            poff.push_back(off(i) + j);
+            plen.push_back(len);
+            rbytes += len;
+        }
+    rstart.push_back(poff.size());
+
+    size_t nround = rstart.size() - 1U;
+    int err = MPI_Allreduce(MPI_IN_PLACE, &nround, 1, MPIType<size_t>(), MPI_MAX, fcomm);
+    printErr(log, name, Log::Layer::Data, err, nullptr, "Two-phase reduction of the number of rounds failed");
+
+    std::vector<size_t> roff, rlen;
+    for (size_t r = 0; r < nround; r++)
+    {
+        csize_t lo = (r + 1U < rstart.size() ? rstart[r] : poff.size());
+        csize_t hi = (r + 2U < rstart.size() ? rstart[r + 1U] : poff.size());
+        roff.assign(poff.begin() + lo, poff.begin() + hi);
+        rlen.assign(plen.begin() + lo, plen.begin() + hi);
+        exchange(write, roff, rlen, d);
+        d += std::accumulate(rlen.begin(), rlen.end(), size_t(0U));
+    }
+}
+
+void TwoPhase::read(csize_t offset, csize_t sz, uchar * d) const
+{
+    blockIO(false, sz, 1U, [offset] (size_t) { return offset; }, d);
+}
+
+void TwoPhase::read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
+{
+    blockIO(false, bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, d);
+}
+
+void TwoPhase::read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const
+{
+    blockIO(false, bsz, sz, [offset] (size_t i) { return offset[i]; }, d);
+}
+
+void TwoPhase::write(csize_t offset, csize_t sz, const uchar * d) const
+{
+    blockIO(true, sz, 1U, [offset] (size_t) { return offset; }, const_cast<uchar *>(d));
+}
+
+void TwoPhase::write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const
+{
+    blockIO(true, bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, const_cast<uchar *>(d));
+}
+
+void TwoPhase::write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const
+{
+    blockIO(true, bsz, sz, [offset] (size_t i) { return offset[i]; }, const_cast<uchar *>(d));
+}
+}}
@@ -0,0 +1,548 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief
+ *   \details
+ *//*******************************************************************************************/
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include "data/datauring.hh"
+#ifdef __NR_io_uring_setup
+#include <linux/io_uring.h>
+#define PIOL_URING
+#endif
+
+namespace PIOL { namespace Data {
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////       Non-Class       ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! A single request of a transfer
+ */
+struct Piece
+{
+    size_t off;     //!< The offset in bytes in the file
+    size_t len;     //!< The length in bytes
+    uchar * d;      //!< The memory the request reads into or writes from
+};
+
+/*! Get the description of the last system error
+ *  \param[in] err The error number
+ *  \return The description
+ */
+std::string sysErr(int err)
+{
+    return std::string(" (") + std::strerror(err) + ")";
+}
+
+#ifdef PIOL_URING
+/*! The io_uring queues and registered buffers of a URing instance
+ */
+struct URing::Ring
+{
+    int fd = -1;                        //!< The io_uring file descriptor
+    unsigned * sqTail = nullptr;        //!< The tail of the submission queue
+    unsigned * sqMask = nullptr;        //!< The index mask of the submission queue
+    unsigned * sqArray = nullptr;       //!< The index array of the submission queue
+    unsigned * cqHead = nullptr;        //!< The head of the completion queue
+    unsigned * cqTail = nullptr;        //!< The tail of the completion queue
+    unsigned * cqMask = nullptr;        //!< The index mask of the completion queue
+    io_uring_sqe * sqes = nullptr;      //!< The submission queue entries
+    io_uring_cqe * cqes = nullptr;      //!< The completion queue entries
+    void * sqPtr = MAP_FAILED;          //!< The mapping of the submission ring
+    void * cqPtr = MAP_FAILED;          //!< The mapping of the completion ring
+    size_t sqLen = 0U;                  //!< The size of the submission ring mapping
+    size_t cqLen = 0U;                  //!< The size of the completion ring mapping
+    size_t sqeLen = 0U;                 //!< The size of the submission queue entry mapping
+    uchar * buf = nullptr;              //!< The buffers, one for each request in flight
+    bool registered = false;            //!< Whether the buffers are registered with the kernel
+    unsigned queued = 0U;               //!< The number of entries not yet passed to the kernel
+
+    /*! Set up the queues and buffers. On failure fd is -1.
+     *  \param[in] depth The number of requests in flight
+     *  \param[in] bufSz The size of each buffer
+     *  \param[in] align The alignment of the buffers
+     *  \param[in] fixed Whether to register the buffers
+     */
+    Ring(csize_t depth, csize_t bufSz, csize_t align, bool fixed)
+    {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        fd = int(syscall(__NR_io_uring_setup, unsigned(depth), &p));
+        if (fd < 0)
+            return;
+
+        sqLen = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqLen = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single)
+            sqLen = cqLen = std::max(sqLen, cqLen);
+
+        sqPtr = mmap(nullptr, sqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        cqPtr = (single ? sqPtr : mmap(nullptr, cqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING));
+        sqeLen = p.sq_entries * sizeof(io_uring_sqe);
+        void * sqePtr = mmap(nullptr, sqeLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqPtr == MAP_FAILED || cqPtr == MAP_FAILED || sqePtr == MAP_FAILED
+            || posix_memalign(reinterpret_cast<void **>(&buf), align, depth * bufSz))
+        {
+            if (sqePtr != MAP_FAILED)
+                munmap(sqePtr, sqeLen);
+            release();
+            return;
+        }
+        sqes = static_cast<io_uring_sqe *>(sqePtr);
+
+        uchar * sq = static_cast<uchar *>(sqPtr);
+        uchar * cq = static_cast<uchar *>(cqPtr);
+        sqTail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        cqHead = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        cqTail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+
+        if (fixed)
+        {
+            std::vector<iovec> iov(depth);
+            for (size_t i = 0; i < depth; i++)
+                iov[i] = {buf + i * bufSz, bufSz};
+            registered = !syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, iov.data(), unsigned(depth));
+        }
+    }
+
+    /*! Unmap the queues and close the io_uring file descriptor
+     */
+    void release(void)
+    {
+        if (sqes)
+            munmap(sqes, sqeLen);
+        if (cqPtr != MAP_FAILED && cqPtr != sqPtr)
+            munmap(cqPtr, cqLen);
+        if (sqPtr != MAP_FAILED)
+            munmap(sqPtr, sqLen);
+        if (fd >= 0)
+            close(fd);
+        free(buf);
+        sqes = nullptr;
+        sqPtr = cqPtr = MAP_FAILED;
+        buf = nullptr;
+        fd = -1;
+    }
+
+    ~Ring(void)
+    {
+        release();
+    }
+
+    /*! Queue a read or write.
+     *  \param[in] write Whether to write
+     *  \param[in] file The file descriptor
+     *  \param[in] off The offset in the file
+     *  \param[in] len The length
+     *  \param[in] d The memory to read into or write from
+     *  \param[in] slot The registered buffer d is in, or -1 if d is not in a registered buffer
+     *  \param[in] tag The tag returned with the completion
+     */
+    void queue(bool write, int file, csize_t off, csize_t len, uchar * d, int slot, csize_t tag)
+    {
+        unsigned tail = *sqTail;
+        unsigned idx = tail & *sqMask;
+        io_uring_sqe * sqe = &sqes[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        if (slot >= 0 && registered)
+        {
+            sqe->opcode = (write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED);
+            sqe->buf_index = uint16_t(slot);
+        }
+        else
+            sqe->opcode = (write ? IORING_OP_WRITE : IORING_OP_READ);
+        sqe->fd = file;
+        sqe->off = off;
+        sqe->addr = reinterpret_cast<uint64_t>(d);
+        sqe->len = unsigned(len);
+        sqe->user_data = tag;
+        sqArray[idx] = idx;
+        __atomic_store_n(sqTail, tail + 1U, __ATOMIC_RELEASE);
+        queued++;
+    }
+
+    /*! Pass the queued requests to the kernel and wait for at least one completion.
+     *  \return Zero on success or the error number.
+     */
+    int submit(void)
+    {
+        for (;;)
+        {
+            int n = int(syscall(__NR_io_uring_enter, fd, queued, 1U, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (n >= 0)
+            {
+                queued -= unsigned(n);
+                return 0;
+            }
+            if (errno != EINTR)
+                return errno;
+        }
+    }
+
+    /*! Process every available completion
+     *  \param[in] fn The function to call with the tag and result of each completion
+     */
+    template <class F>
+    void reap(F fn)
+    {
+        unsigned head = __atomic_load_n(cqHead, __ATOMIC_RELAXED);
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++)
+        {
+            const io_uring_cqe & cqe = cqes[head & *cqMask];
+            fn(size_t(cqe.user_data), cqe.res);
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+};
+#else
+/*! An empty placeholder where io_uring is not available
+ */
+struct URing::Ring
+{
+};
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////    Class functions    ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////      Constructor & Destructor      ///////////////////////////////
+URing::Opt::Opt(void)
+{
+    depth = 32U;
+    bufSz = 256U*1024U;
+    fixed = true;
+    direct = false;
+    align = 4096U;
+}
+
+URing::URing(const Piol piol_, const std::string name_, const URing::Opt & opt, FileMode mode) : Interface(piol_, name_)
+{
+    Init(opt, mode);
+}
+
+URing::URing(const Piol piol_, const std::string name_, FileMode mode) : Interface(piol_, name_)
+{
+    const URing::Opt opt;
+    Init(opt, mode);
+}
+
+URing::~URing(void)
+{
+    ring.reset();
+    if (dfd >= 0)
+        close(dfd);
+    if (fd >= 0)
+        close(fd);
+    //Matches the delete on close of the MPI-IO test mode. Every process must be done with the file.
+    if (remove)
+    {
+        piol->comm->barrier();
+        if (!piol->comm->getRank())
+            unlink(name.c_str());
+    }
+}
+
+void URing::Init(const URing::Opt & opt, FileMode mode)
+{
+    depth = std::max(opt.depth, size_t(1U));
+    align = std::max(opt.align, size_t(1U));
+    //O_DIRECT needs aligned buffers with room for a request and its alignment.
+    bufSz = (opt.direct ? std::max((opt.bufSz + align - 1U) / align * align, 4U * align) : std::max(opt.bufSz, size_t(1U)));
+    fixed = opt.fixed;
+    remove = (mode == FileMode::Test);
+    dfd = -1;
+
+    int flags;
+    switch (mode)
+    {
+        default :
+        case FileMode::Read :
+            flags = O_RDONLY;
+        break;
+        case FileMode::Write :
+            flags = O_WRONLY | O_CREAT;
+        break;
+        case FileMode::ReadWrite :
+        case FileMode::Test :
+            flags = O_RDWR | O_CREAT;
+        break;
+    }
+
+    fd = open(name.c_str(), flags, 0644);
+    if (fd < 0)
+    {
+        log->record(name, Log::Layer::Data, Log::Status::Error, "open failure" + sysErr(errno), Log::Verb::None);
+        return;
+    }
+
+    //Not every filesystem supports O_DIRECT, in which case the page cache is used.
+    if (opt.direct)
+        dfd = open(name.c_str(), (flags & ~O_CREAT) | O_DIRECT);
+
+#ifdef PIOL_URING
+    if (opt.depth)
+        ring.reset(new Ring(depth, bufSz, align, fixed));
+    if (ring && ring->fd < 0)
+    {
+        log->record(name, Log::Layer::Data, Log::Status::Warning, "io_uring is not available, using pread and pwrite",
+                    Log::Verb::Extended);
+        ring.reset();
+    }
+#endif
+    //Aligned requests need the buffers of the ring.
+    if (!ring && dfd >= 0)
+    {
+        close(dfd);
+        dfd = -1;
+    }
+}
+
+///////////////////////////////////       Member functions      ///////////////////////////////////
+size_t URing::getFileSz() const
+{
+    struct stat st;
+    if (fstat(fd, &st))
+    {
+        log->record(name, Log::Layer::Data, Log::Status::Error, "error getting the file size" + sysErr(errno), Log::Verb::None);
+        return 0U;
+    }
+    return size_t(st.st_size);
+}
+
+void URing::setFileSz(csize_t sz) const
+{
+    if (ftruncate(fd, off_t(sz)))
+        log->record(name, Log::Layer::Data, Log::Status::Error, "error setting the file size" + sysErr(errno), Log::Verb::None);
+}
+
+void URing::syncIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const
+{
+    for (size_t i = 0; i < nb; i++)
+        for (size_t done = 0; done < bsz; )
+        {
+            ssize_t n = (write ? pwrite(fd, &d[i*bsz + done], bsz - done, off_t(off(i) + done))
+                               : pread(fd, &d[i*bsz + done], bsz - done, off_t(off(i) + done)));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+                log->record(name, Log::Layer::Data, Log::Status::Error, std::string(write ? "pwrite" : "pread")
+                            + " failure" + sysErr(errno), Log::Verb::None);
+            if (n <= 0)
+                break;
+            done += size_t(n);
+        }
+}
+
+void URing::blockIO(bool write, csize_t bsz, csize_t nb, const std::function<size_t(size_t)> & off, uchar * d) const
+{
+    if (!nb || !bsz || fd < 0)
+        return;
+    if (!ring)
+        return syncIO(write, bsz, nb, off, d);
+#ifdef PIOL_URING
+    //The state of a request in flight
+    struct Flight
+    {
+        Piece p;        //!< The request
+        size_t aoff;    //!< The offset in the file of the request as made
+        size_t alen;    //!< The length of the request as made
+        bool slot;      //!< Whether the request goes through the registered buffer of the tag
+    };
+    std::vector<Flight> fly(depth);
+    std::vector<size_t> tags(depth);
+    for (size_t t = 0; t < depth; t++)
+        tags[t] = depth - 1U - t;
+    std::deque<Piece> retry;
+    size_t blk = 0U, pos = 0U;
+
+    //Make the next request from the requests to retry or from the blocks.
+    auto next = [&] (Piece & p) -> bool
+    {
+        if (retry.size())
+        {
+            p = retry.front();
+            retry.pop_front();
+            return true;
+        }
+        if (blk == nb)
+            return false;
+        csize_t rem = bsz - pos;
+        csize_t o = off(blk) + pos;
+        uchar * m = &d[blk*bsz + pos];
+        size_t len = std::min(rem, (dfd >= 0 || (fixed && rem < bufSz) ? bufSz - (dfd >= 0 ? 2U*align : 0U) : size_t(1U << 30)));
+        //Memory placed like the file is moved without a copy from the first aligned byte. The
+        //unaligned head and tail go through the buffers.
+        if (dfd >= 0 && uintptr_t(m) % align == o % align)
+        {
+            csize_t lead = (align - o % align) % align;
+            if (lead)
+                len = std::min(rem, lead);
+            else if (rem >= align)
+                len = std::min(rem, size_t(1U << 30)) / align * align;
+        }
+        p = {o, len, m};
+        pos += len;
+        if (pos == bsz)
+        {
+            blk++;
+            pos = 0U;
+        }
+        return true;
+    };
+
+    //Queue a request on a free tag
+    auto issue = [&] (Piece p)
+    {
+        csize_t t = tags.back();
+        tags.pop_back();
+        Flight & f = fly[t];
+        uchar * sbuf = ring->buf + t * bufSz;
+        //Aligned requests from aligned memory need no buffer. Writes which are not aligned bypass O_DIRECT.
+        bool zero = dfd >= 0 && !(p.off % align) && !(p.len % align) && !(uintptr_t(p.d) % align);
+        bool dir = dfd >= 0 && (zero || !write || (!(p.off % align) && !(p.len % align)));
+        //What is left of a short request may not fit in a buffer
+        if (dir && !zero && p.len > bufSz - 2U*align)
+        {
+            retry.push_front({p.off + bufSz - 2U*align, p.len - (bufSz - 2U*align), p.d + bufSz - 2U*align});
+            p.len = bufSz - 2U*align;
+        }
+        f.p = p;
+        if (zero)
+        {
+            f.aoff = p.off;
+            f.alen = p.len;
+            f.slot = false;
+        }
+        else if (dir)
+        {
+            f.aoff = p.off / align * align;
+            f.alen = (p.off + p.len + align - 1U) / align * align - f.aoff;
+            f.slot = true;
+        }
+        else
+        {
+            f.aoff = p.off;
+            f.alen = p.len;
+            f.slot = fixed && p.len <= bufSz;
+        }
+        if (f.slot && write)
+            std::copy(p.d, p.d + p.len, sbuf);
+        ring->queue(write, (dir ? dfd : fd), f.aoff, f.alen, (f.slot ? sbuf : p.d), (f.slot ? int(t) : -1), t);
+    };
+
+    //Finish a request and queue what remains of it if it was short
+    auto complete = [&] (size_t t, int res)
+    {
+        Flight & f = fly[t];
+        tags.push_back(t);
+        if (res == -EINTR || res == -EAGAIN)
+        {
+            retry.push_back(f.p);
+            return;
+        }
+        if (res < 0)
+        {
+            log->record(name, Log::Layer::Data, Log::Status::Error, std::string(write ? "io_uring write" : "io_uring read")
+                        + " failure" + sysErr(-res), Log::Verb::None);
+            return;
+        }
+        csize_t lead = f.p.off - f.aoff;
+        csize_t done = std::min(f.p.len, (size_t(res) > lead ? size_t(res) - lead : 0U));
+        if (f.slot && !write)
+        {
+            uchar * sbuf = ring->buf + t * bufSz + lead;
+            std::copy(sbuf, sbuf + done, f.p.d);
+        }
+        //A short transfer is made again for what remains. Reading nothing means the end of the file.
+        if (done < f.p.len && res > 0)
+            retry.push_back({f.p.off + done, f.p.len - done, f.p.d + done});
+    };
+
+    size_t inflight = 0U;
+    Piece p;
+    for (;;)
+    {
+        while (inflight < depth && next(p))
+        {
+            issue(p);
+            inflight++;
+        }
+        if (!inflight)
+            break;
+
+        int err = ring->submit();
+        if (err)
+        {
+            log->record(name, Log::Layer::Data, Log::Status::Error, "io_uring submission failure" + sysErr(err), Log::Verb::None);
+            return;
+        }
+        ring->reap([&] (size_t t, int res)
+        {
+            complete(t, res);
+            inflight--;
+        });
+    }
+#endif
+}
+
+void URing::read(csize_t offset, csize_t sz, uchar * d) const
+{
+    blockIO(false, sz, 1U, [offset] (size_t) { return offset; }, d);
+}
+
+void URing::read(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, uchar * d) const
+{
+    blockIO(false, bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, d);
+}
+
+void URing::read(csize_t bsz, csize_t sz, csize_t * offset, uchar * d) const
+{
+    blockIO(false, bsz, sz, [offset] (size_t i) { return offset[i]; }, d);
+}
+
+void URing::write(csize_t offset, csize_t sz, const uchar * d) const
+{
+    blockIO(true, sz, 1U, [offset] (size_t) { return offset; }, const_cast<uchar *>(d));
+}
+
+void URing::write(csize_t offset, csize_t bsz, csize_t osz, csize_t nb, const uchar * d) const
+{
+    blockIO(true, bsz, nb, [offset, osz] (size_t i) { return offset + i * osz; }, const_cast<uchar *>(d));
+}
+
+void URing::write(csize_t bsz, csize_t sz, csize_t * offset, const uchar * d) const
+{
+    blockIO(true, bsz, sz, [offset] (size_t i) { return offset[i]; }, const_cast<uchar *>(d));
+}
+
+uchar * URing::place(csize_t offset, csize_t sz, std::vector<uchar> & buf) const
+{
+    if (dfd < 0)
+        return Interface::place(offset, sz, buf);
+    //Room to start at any point within an alignment
+    if (buf.size() < sz + align - 1U)
+        buf.resize(sz + align - 1U);
+    csize_t shift = (offset % align + align - uintptr_t(buf.data()) % align) % align;
+    return buf.data() + shift;
+}
+}}
@@ -7,6 +7,7 @@
  *   \details
  *//*******************************************************************************************/
 #include <limits>
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include <iostream>
@@ -42,6 +43,7 @@ Rule::Rule(RuleMap translate_, bool full)
         }
 
     flag.fullextent = full;
+    flag.badprog = true;
 
     if (full)
     {
@@ -66,6 +68,7 @@ Rule::Rule(std::initializer_list<Meta> mlist, bool full)
 
     //TODO: Change this when extents are flexible
     flag.fullextent = full;
+    flag.badprog = true;
 
     for (auto m : mlist)
     {
@@ -148,6 +151,7 @@ Rule::Rule(bool full, bool defaults, bool extra)
     numCopy = 0;
 
     flag.fullextent = full;
+    flag.badprog = true;
 
     if (defaults)
     {
@@ -230,6 +234,7 @@ void Rule::addLong(Meta m, Tr loc)
         rmRule(m);
     translate[m] = new SEGYLongRuleEntry(numLong++, loc);
     flag.badextent = (!flag.fullextent);
+    flag.badprog = true;
 }
 
 void Rule::addShort(Meta m, Tr loc)
@@ -239,6 +244,7 @@ void Rule::addShort(Meta m, Tr loc)
         rmRule(m);
     translate[m] = new SEGYShortRuleEntry(numShort++, loc);
     flag.badextent = (!flag.fullextent);
+    flag.badprog = true;
 }
 
 void Rule::addSEGYFloat(Meta m, Tr loc, Tr scalLoc)
@@ -248,6 +254,7 @@ void Rule::addSEGYFloat(Meta m, Tr loc, Tr scalLoc)
         rmRule(m);
     translate[m] = new SEGYFloatRuleEntry(numFloat++, loc, scalLoc);
     flag.badextent = (!flag.fullextent);
+    flag.badprog = true;
 }
 
 void Rule::addIndex(Meta m)
@@ -256,6 +263,7 @@ void Rule::addIndex(Meta m)
     if (ent != translate.end())
         rmRule(m);
     translate[m] = new SEGYIndexRuleEntry(numIndex++);
+    flag.badprog = true;
 }
 
 void Rule::rmRule(Meta m)
@@ -281,6 +289,7 @@ void Rule::rmRule(Meta m)
     delete translate[m];
     translate.erase(m);
     flag.badextent = (!flag.fullextent);
+    flag.badprog = true;
 }
 
 RuleEntry * Rule::getEntry(Meta entry)
@@ -288,6 +297,51 @@ RuleEntry * Rule::getEntry(Meta entry)
     return translate[entry];
 }
 
+const RuleProgram & Rule::program(void)
+{
+    extent();
+    if (flag.badprog)
+    {
+        prog = RuleProgram();
+        for (const auto & v : translate)
+        {
+            const auto t = v.second;
+            if (t == nullptr)
+                continue;
+            RuleOp op = {t->loc - start - 1U, t->num, 0U};
+            switch (t->type())
+            {
+                case MdType::Float :
+                {
+                    size_t sloc = static_cast<SEGYFloatRuleEntry *>(t)->scalLoc - start - 1U;
+                    auto it = std::find(prog.scal.begin(), prog.scal.end(), sloc);
+                    op.scal = it - prog.scal.begin();
+                    if (it == prog.scal.end())
+                        prog.scal.push_back(sloc);
+                    prog.flt.push_back(op);
+                }
+                break;
+                case MdType::Long :
+                prog.lng.push_back(op);
+                break;
+                case MdType::Short :
+                prog.shrt.push_back(op);
+                break;
+                case MdType::Copy :
+                case MdType::Index : break;
+            }
+        }
+
+        //Sorting by location gives a sequential pass over the header
+        auto comp = [] (const RuleOp & a, const RuleOp & b) { return a.loc < b.loc; };
+        std::sort(prog.lng.begin(), prog.lng.end(), comp);
+        std::sort(prog.shrt.begin(), prog.shrt.end(), comp);
+        std::sort(prog.flt.begin(), prog.flt.end(), comp);
+        flag.badprog = false;
+    }
+    return prog;
+}
+
 size_t Rule::memUsage(void) const
 {
     return numLong * sizeof(SEGYLongRuleEntry) + numShort * sizeof(SEGYShortRuleEntry)
@@ -398,8 +452,9 @@ void insertParam(size_t sz, const Param * prm, uchar * buf, size_t stride, size_
 {
     if (prm == nullptr)
         return;
-    auto r = prm->r;
-    size_t start = r->start;
+    Rule * r = prm->r.get();
+    const RuleProgram & prog = r->program();
+    csize_t step = r->extent() + stride;
 
     if (r->numCopy)
     {
@@ -411,55 +466,32 @@ void insertParam(size_t sz, const Param * prm, uchar * buf, size_t stride, size_
                           &buf[i * (stride + SEGSz::getMDSz())]);
     }
 
+    std::vector<int16_t> scal(prog.scal.size());
     for (size_t i = 0; i < sz; i++)
     {
-        uchar * md = &buf[(r->extent() + stride)*i];
-#if defined(__INTEL_COMPILER) || __GNUC__ < 6    //Compiler defects
-        std::unordered_map<Tr, int16_t, EnumHash> scal;
-#else
-        std::unordered_map<Tr, int16_t> scal;
-#endif
-        std::vector<const SEGYFloatRuleEntry *> rule;
-        for (const auto v : r->translate)
-        {
-            const auto t = v.second;
-            size_t loc = t->loc - start-1U;
-            switch (t->type())
-            {
-                case MdType::Float :
-                {
-                    rule.push_back(dynamic_cast<SEGYFloatRuleEntry *>(t));
-                    auto tr = static_cast<Tr>(rule.back()->scalLoc);
-                    int16_t scal1 = (scal.find(tr) != scal.end() ? scal[tr] : 1);
-                    int16_t scal2 = deScale(prm->f[(i + skip) * r->numFloat + t->num]);
-
-                    //if the scale is bigger than 1 that means we need to use the largest
-                    //to ensure conservation of the most significant digit
-                    //otherwise we choose the scale that preserves the most digits
-                    //after the decimal place.
-                    scal[tr] = ((scal1 > 1 || scal2 > 1) ? std::max(scal1, scal2) : std::min(scal1, scal2));
-                }
-                break;
-                case MdType::Short :
-                getBigEndian(prm->s[(i + skip) * r->numShort + t->num], &md[loc]);
-                break;
-                case MdType::Long :
-                getBigEndian(int32_t(prm->i[(i + skip) * r->numLong + t->num]), &md[loc]);
-                break;
-                case MdType::Copy :
-                case MdType::Index : break;
-            }
-        }
-
-        //Finish off the floats. Floats are inherently annoying in SEG-Y
-        for (const auto & s : scal)
-            getBigEndian(s.second, &md[size_t(s.first)-start-1U]);
-
-        for (size_t j = 0; j < rule.size(); j++)
+        uchar * md = &buf[step * i];
+        for (const auto & op : prog.lng)
+            getBigEndian(int32_t(prm->i[(i + skip) * r->numLong + op.num]), &md[op.loc]);
+        for (const auto & op : prog.shrt)
+            getBigEndian(prm->s[(i + skip) * r->numShort + op.num], &md[op.loc]);
+
+        //Floats are inherently annoying in SEG-Y. Floats which share a scaler need a common scale.
+        //If the scale is bigger than 1 that means we need to use the largest
+        //to ensure conservation of the most significant digit
+        //otherwise we choose the scale that preserves the most digits
+        //after the decimal place.
+        std::fill(scal.begin(), scal.end(), int16_t(1));
+        for (const auto & op : prog.flt)
         {
-            geom_t gscale = scaleConv(scal[static_cast<Tr>(rule[j]->scalLoc)]);
-            getBigEndian(int32_t(std::lround(prm->f[(i + skip) * r->numFloat + rule[j]->num] / gscale)), &md[rule[j]->loc-start-1U]);
+            int16_t scal1 = scal[op.scal];
+            int16_t scal2 = deScale(prm->f[(i + skip) * r->numFloat + op.num]);
+            scal[op.scal] = ((scal1 > 1 || scal2 > 1) ? std::max(scal1, scal2) : std::min(scal1, scal2));
         }
+        for (size_t j = 0; j < scal.size(); j++)
+            getBigEndian(scal[j], &md[prog.scal[j]]);
+        for (const auto & op : prog.flt)
+            getBigEndian(int32_t(std::lround(prm->f[(i + skip) * r->numFloat + op.num] / scaleConv(scal[op.scal]))),
+                         &md[op.loc]);
     }
 }
 
@@ -468,6 +500,8 @@ void extractParam(size_t sz, const uchar * buf, Param * prm, size_t stride, size
     if (prm == nullptr)
         return;
     Rule * r = prm->r.get();
+    const RuleProgram & prog = r->program();
+    csize_t step = r->extent() + stride;
 
     if (r->numCopy)
     {
@@ -475,33 +509,23 @@ void extractParam(size_t sz, const uchar * buf, Param * prm, size_t stride, size
             std::copy(buf, &buf[sz * SEGSz::getMDSz()], &prm->c[skip * SEGSz::getMDSz()]);
         else
             for (size_t i = 0; i < sz; i++)
-                std::copy(&buf[i * (stride + SEGSz::getMDSz())], &buf[(i+1U) * (stride + SEGSz::getMDSz())], &prm->c[(i + skip) * SEGSz::getMDSz()]);
+                std::copy(&buf[i * (stride + SEGSz::getMDSz())], &buf[i * (stride + SEGSz::getMDSz()) + SEGSz::getMDSz()],
+                          &prm->c[(i + skip) * SEGSz::getMDSz()]);
     }
 
-    for (size_t i = 0; i < sz; i++)
+    //Each field is decoded for every trace in turn
+    for (const auto & op : prog.lng)
+        for (size_t i = 0; i < sz; i++)
+            prm->i[(i + skip) * r->numLong + op.num] = getHost<int32_t>(&buf[step * i + op.loc]);
+    for (const auto & op : prog.shrt)
+        for (size_t i = 0; i < sz; i++)
+            prm->s[(i + skip) * r->numShort + op.num] = getHost<int16_t>(&buf[step * i + op.loc]);
+    for (const auto & op : prog.flt)
     {
-        const uchar * md = &buf[(r->extent() + stride)*i];
-        //Loop through each rule and extract data
-        for (const auto v : r->translate)
-        {
-            const auto t = v.second;
-            size_t loc = t->loc - r->start - 1U;
-            switch (t->type())
-            {
-                case MdType::Float :
-                prm->f[(i + skip) * r->numFloat + t->num] = scaleConv(getHost<int16_t>(&md[dynamic_cast<SEGYFloatRuleEntry *>(t)->scalLoc - r->start-1U]))
-                                                   * geom_t(getHost<int32_t>(&md[loc]));
-                break;
-                case MdType::Short :
-                prm->s[(i + skip) * r->numShort + t->num] = getHost<int16_t>(&md[loc]);
-                break;
-                case MdType::Long :
-                prm->i[(i + skip) * r->numLong + t->num] = getHost<int32_t>(&md[loc]);
-                break;
-                case MdType::Copy :
-                case MdType::Index : break;
-            }
-        }
+        csize_t sloc = prog.scal[op.scal];
+        for (size_t i = 0; i < sz; i++)
+            prm->f[(i + skip) * r->numFloat + op.num] = scaleConv(getHost<int16_t>(&buf[step * i + sloc]))
+                                                      * geom_t(getHost<int32_t>(&buf[step * i + op.loc]));
     }
 }
 }}
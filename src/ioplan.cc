@@ -0,0 +1,74 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date October 2016
+ *   \brief
+ *   \details
+ *//*******************************************************************************************/
+#include <algorithm>
+#include "file/ioplan.hh"
+namespace PIOL { namespace File {
+IOPlan::IOPlan(ExSeisPIOL * piol_, csize_t lnt_, csize_t max_) : piol(piol_), lnt(lnt_), max(std::max(max_, size_t(1U)))
+{
+    auto vec = piol->comm->gather(std::vector<size_t>{lnt / max + (lnt % max > 0), max});
+    nround = 0U;
+    gmax = 0U;
+    for (size_t i = 0; i < vec.size(); i += 2U)
+    {
+        nround = std::max(nround, vec[i]);
+        gmax = std::max(gmax, vec[i+1U]);
+    }
+}
+
+void IOPlan::add(const ReadInterface * f, csize_t isz_)
+{
+    fbound.push_back([f] (csize_t bound) { f->setBound(bound); });
+    isz.push_back(isz_);
+}
+
+void IOPlan::add(const WriteInterface * f, csize_t isz_)
+{
+    fbound.push_back([f] (csize_t bound) { f->setBound(bound); });
+    isz.push_back(isz_);
+}
+
+void IOPlan::readAhead(const ReadInterface * f, csize_t offset)
+{
+    fahead.push_back([f, offset] (size_t i, size_t sz) { f->prefetchTrace(offset + i, sz); });
+    fdrop.push_back([f] (void) { f->dropPrefetch(); });
+    fuse.push_back([f] (void) { f->usePrefetch(); });
+}
+
+void IOPlan::run(std::function<void(size_t, size_t)> fn) const
+{
+    for (size_t j = 0; j < fbound.size(); j++)
+        fbound[j](gmax * isz[j]);
+
+    //Every process reads ahead the same rounds, including rounds with no items.
+    auto ahead = [this] (size_t r)
+    {
+        size_t i = std::min(r * max, lnt);
+        for (auto & f : fahead)
+            f(i, std::min(max, lnt - i));
+    };
+
+    if (nround)
+        ahead(0U);
+    for (size_t r = 0; r < nround; r++)
+    {
+        if (r + 1U < nround)
+            ahead(r + 1U);
+        //Every process read this round ahead
+        for (auto & f : fuse)
+            f();
+        size_t i = std::min(r * max, lnt);
+        fn(i, std::min(max, lnt - i));
+    }
+
+    for (auto & f : fdrop)
+        f();
+    for (size_t j = 0; j < fbound.size(); j++)
+        fbound[j](0U);
+}
+}}
@@ -18,4 +18,38 @@ void Interface::setFileSz(csize_t sz) const
 {
     return data->setFileSz(sz);
 }
+
+void Interface::setBound(csize_t bound) const
+{
+    if (data != nullptr)
+        data->setBound(bound);
+}
+
+uchar * Interface::place(csize_t offset, csize_t sz, std::vector<uchar> & buf) const
+{
+    if (data != nullptr)
+        return data->place(offset, sz, buf);
+    if (buf.size() < sz)
+        buf.resize(sz);
+    return buf.data();
+}
+
+void Interface::dropPrefetch(void) const
+{
+    if (data != nullptr)
+        data->dropPrefetch();
+}
+
+void Interface::usePrefetch(void) const
+{
+    if (data != nullptr)
+        data->usePrefetch();
+}
+
+void Interface::prefetchDO(csize_t offset, csize_t ns, csize_t sz) const
+{
+    (void)offset;
+    (void)ns;
+    (void)sz;
+}
 }}
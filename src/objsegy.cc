@@ -10,6 +10,52 @@
 #include "share/segy.hh"
 #include "data/data.hh"
 namespace PIOL { namespace Obj {
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////       Non-Class       ///////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/*! Build runs of equally spaced blocks from a list of data-object numbers. Each run is the longest
+ *  stretch of increasing numbers with the same difference.
+ *  \param[in] sz The number of data-objects
+ *  \param[in] offset The data-object numbers
+ *  \param[in] start The location in bytes of the block of data-object zero
+ *  \param[in] step The size in bytes of a data-object
+ *  \return The runs of blocks. This is empty if the runs are not on average at least two blocks
+ *          long as a list of offsets is then just as good.
+ */
+std::vector<Data::Extent> getExtents(csize_t sz, csize_t * offset, csize_t start, csize_t step)
+{
+    //Find the length of the run starting at i
+    auto runLen = [sz, offset] (size_t i) -> size_t
+    {
+        size_t n = 1U;
+        if (i + 1U < sz && offset[i+1U] > offset[i])
+        {
+            csize_t diff = offset[i+1U] - offset[i];
+            while (i + n < sz && offset[i+n] > offset[i+n-1U] && offset[i+n] - offset[i+n-1U] == diff)
+                n++;
+        }
+        return n;
+    };
+
+    size_t runs = 0U;
+    for (size_t i = 0U; i < sz; i += runLen(i))
+        runs++;
+
+    std::vector<Data::Extent> ext;
+    if (2U * runs > sz)
+        return ext;
+
+    ext.reserve(runs);
+    for (size_t i = 0U; i < sz; )
+    {
+        csize_t n = runLen(i);
+        csize_t diff = (n > 1U ? offset[i+1U] - offset[i] : 1U);
+        ext.push_back({start + offset[i] * step, n, diff * step});
+        i += n;
+    }
+    return ext;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////    Class functions    ///////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -46,6 +92,11 @@ void SEGY::readDO(csize_t offset, csize_t ns, csize_t sz, uchar * d) const
     data->read(SEGSz::getDOLoc(offset, ns), sz * SEGSz::getDOSz(ns), d);
 }
 
+void SEGY::prefetchDO(csize_t offset, csize_t ns, csize_t sz) const
+{
+    data->prefetch(SEGSz::getDOLoc(offset, ns), sz * SEGSz::getDOSz(ns));
+}
+
 void SEGY::writeDO(csize_t offset, csize_t ns, csize_t sz, const uchar * d) const
 {
     data->write(SEGSz::getDOLoc(offset, ns), sz * SEGSz::getDOSz(ns), d);
@@ -74,6 +125,10 @@ void SEGY::writeDODF(csize_t offset, csize_t ns, csize_t sz, const uchar * df) c
 //TODO: Add optional validation in this layer?
 void SEGY::readDO(csize_t ns, csize_t sz, csize_t * offset, uchar * d) const
 {
+    auto ext = getExtents(sz, offset, SEGSz::getDOLoc(0U, ns), SEGSz::getDOSz(ns));
+    if (ext.size())
+        return data->read(SEGSz::getDOSz(ns), ext, d);
+
     std::vector<size_t> dooff(sz);
     for (size_t i = 0; i < sz; i++)
         dooff[i] = SEGSz::getDOLoc(offset[i], ns);
@@ -82,6 +137,10 @@ void SEGY::readDO(csize_t ns, csize_t sz, csize_t * offset, uchar * d) const
 
 void SEGY::writeDO(csize_t ns, csize_t sz, csize_t * offset, const uchar * d) const
 {
+    auto ext = getExtents(sz, offset, SEGSz::getDOLoc(0U, ns), SEGSz::getDOSz(ns));
+    if (ext.size())
+        return data->write(SEGSz::getDOSz(ns), ext, d);
+
     std::vector<size_t> dooff(sz);
     for (size_t i = 0; i < sz; i++)
         dooff[i] = SEGSz::getDOLoc(offset[i], ns);
@@ -90,6 +149,10 @@ void SEGY::writeDO(csize_t ns, csize_t sz, csize_t * offset, const uchar * d) co
 
 void SEGY::readDOMD(csize_t ns, csize_t sz, csize_t * offset, uchar * md) const
 {
+    auto ext = getExtents(sz, offset, SEGSz::getDOLoc(0U, ns), SEGSz::getDOSz(ns));
+    if (ext.size())
+        return data->read(SEGSz::getMDSz(), ext, md);
+
     std::vector<size_t> dooff(sz);
     for (size_t i = 0; i < sz; i++)
         dooff[i] = SEGSz::getDOLoc(offset[i], ns);
@@ -98,6 +161,10 @@ void SEGY::readDOMD(csize_t ns, csize_t sz, csize_t * offset, uchar * md) const
 
 void SEGY::writeDOMD(csize_t ns, csize_t sz, csize_t * offset, const uchar * md) const
 {
+    auto ext = getExtents(sz, offset, SEGSz::getDOLoc(0U, ns), SEGSz::getDOSz(ns));
+    if (ext.size())
+        return data->write(SEGSz::getMDSz(), ext, md);
+
     std::vector<size_t> dooff(sz);
     for (size_t i = 0; i < sz; i++)
         dooff[i] = SEGSz::getDOLoc(offset[i], ns);
@@ -108,6 +175,10 @@ void SEGY::readDODF(csize_t ns, csize_t sz, csize_t * offset, uchar * df) const
 {
     if (ns == 0)
         return;
+    auto ext = getExtents(sz, offset, SEGSz::getDODFLoc(0U, ns), SEGSz::getDOSz(ns));
+    if (ext.size())
+        return data->read(SEGSz::getDFSz(ns), ext, df);
+
     std::vector<size_t> dooff(sz);
     for (size_t i = 0; i < sz; i++)
         dooff[i] = SEGSz::getDODFLoc(offset[i], ns);
@@ -118,6 +189,10 @@ void SEGY::writeDODF(csize_t ns, csize_t sz, csize_t * offset, const uchar * df)
 {
     if (ns == 0)
         return;
+    auto ext = getExtents(sz, offset, SEGSz::getDODFLoc(0U, ns), SEGSz::getDOSz(ns));
+    if (ext.size())
+        return data->write(SEGSz::getDFSz(ns), ext, df);
+
     std::vector<size_t> dooff(sz);
     for (size_t i = 0; i < sz; i++)
         dooff[i] = SEGSz::getDODFLoc(offset[i], ns);
@@ -7,6 +7,8 @@
  *   \details
  *//*******************************************************************************************/
 #include "file/file.hh"
+#include "file/rawparam.hh"
+#include "object/object.hh"
 namespace PIOL { namespace File {
 const Param * PARAM_NULL = (Param *)1;
 
@@ -24,4 +26,65 @@ geom_t ReadInterface::readInc(void) const
 {
    return inc;
 }
+
+void ReadInterface::setBound(csize_t bound) const
+{
+    if (obj != nullptr)
+        obj->setBound(bound);
+}
+
+void ReadInterface::prefetchTrace(csize_t offset, csize_t sz) const
+{
+    //The same traces as readTrace reads
+    if (obj != nullptr)
+        obj->prefetchDO(offset, ns, (!sz ? sz : (offset + sz > nt ? nt - offset : sz)));
+}
+
+void ReadInterface::dropPrefetch(void) const
+{
+    if (obj != nullptr)
+        obj->dropPrefetch();
+}
+
+void ReadInterface::usePrefetch(void) const
+{
+    if (obj != nullptr)
+        obj->usePrefetch();
+}
+
+/*! Encode the parameters into the raw trace headers of a view.
+ *  \param[in] sz The number of sets of parameters.
+ *  \param[in] prm The parameter structure.
+ *  \param[out] view The view of the raw headers.
+ *  \param[in] skip Skip the first "skip" entries of the view.
+ */
+static void encodeRaw(csize_t sz, const Param * prm, RawParamView * view, csize_t skip)
+{
+    if (sz)
+        insertParam(sz, prm, view->data(skip), SEGSz::getMDSz() - prm->r->extent(), 0U);
+}
+
+void ReadInterface::readParam(csize_t offset, csize_t sz, RawParamView * prm, csize_t skip) const
+{
+    if (prm == nullptr)
+        readParam(offset, sz, static_cast<Param *>(nullptr), 0U);
+    else
+    {
+        Param tprm(prm->r, sz);
+        readParam(offset, sz, &tprm, 0U);
+        encodeRaw(sz, &tprm, prm, skip);
+    }
+}
+
+void ReadInterface::readParam(csize_t sz, csize_t * offset, RawParamView * prm, csize_t skip) const
+{
+    if (prm == nullptr)
+        readParam(sz, offset, static_cast<Param *>(nullptr), 0U);
+    else
+    {
+        Param tprm(prm->r, sz);
+        readParam(sz, offset, &tprm, 0U);
+        encodeRaw(sz, &tprm, prm, skip);
+    }
+}
 }}
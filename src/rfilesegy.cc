@@ -8,10 +8,25 @@
  *//*******************************************************************************************/
 #include "global.hh"
 #include "file/filesegy.hh"
+#include "file/rawparam.hh"
 #include "object/object.hh"
 #include "file/iconv.hh"
 #include "share/misc.hh"
 namespace PIOL { namespace File {
+/*! Convert trace samples from the file format to the host IEEE754 format.
+ *  \param[in] format The format of the samples in the file
+ *  \param[in] sz The number of samples
+ *  \param[in] src The samples in the file format
+ *  \param[out] dst The samples in the host format. This can be the same as src.
+ */
+static void toHost(Format format, csize_t sz, const uchar * src, trace_t * dst)
+{
+    if (format == Format::IBM)
+        convertIBMtoIEEE(sz, reinterpret_cast<const float *>(src), dst, true);
+    else
+        swap4Bytes(sz, src, reinterpret_cast<uchar *>(dst));
+}
+
 ///////////////////////////////      Constructor & Destructor      ///////////////////////////////
 ReadSEGY::Opt::Opt(void)
 {
@@ -76,25 +91,24 @@ void ReadSEGY::readTrace(csize_t offset, csize_t sz, trace_t * trace, Param * pr
     uchar * buf = reinterpret_cast<uchar *>(trace);
 
     if (prm == PARAM_NULL)
+    {
         obj->readDODF(offset, ns, ntz, buf);
+        toHost(format, ns * ntz, buf, trace);
+    }
     else
     {
-        std::vector<uchar> dobuf(ntz * SEGSz::getDOSz(ns)); //FIXME: Potentially a big allocation
-        obj->readDO(offset, ns, ntz, dobuf.data());
+        //Placed so the Data layer can read into it without a copy
+        std::vector<uchar> scratch; //FIXME: Potentially a big allocation
+        uchar * dobuf = obj->place(SEGSz::getDOLoc(offset, ns), ntz * SEGSz::getDOSz(ns), scratch);
+        obj->readDO(offset, ns, ntz, dobuf);
 
         if (ntz)
-            extractParam(ntz, dobuf.data(), prm, SEGSz::getDFSz(ns), skip);
+            extractParam(ntz, dobuf, prm, SEGSz::getDFSz(ns), skip);
 
+        //Copy the samples out of the data-objects and convert them in the same pass
         for (size_t i = 0; i < ntz; i++)
-            std::copy(&dobuf[i * SEGSz::getDOSz(ns) + SEGSz::getMDSz()], &dobuf[(i+1) * SEGSz::getDOSz(ns)],
-                      buf + i * SEGSz::getDFSz(ns));
+            toHost(format, ns, &dobuf[i * SEGSz::getDOSz(ns) + SEGSz::getMDSz()], trace + i * ns);
     }
-    if (format == Format::IBM)
-        for (size_t i = 0; i < ns * ntz; i ++)
-            trace[i] = convertIBMtoIEEE(trace[i], true);
-    else
-        for (size_t i = 0; i < ns * ntz; i++)
-            reverse4Bytes(&buf[i*sizeof(float)]);
 }
 
 //TODO: Unit test
@@ -121,7 +135,10 @@ void ReadSEGY::readTrace(csize_t sz, csize_t * offset, trace_t * trace, Param *
 {
     uchar * buf = reinterpret_cast<uchar *>(trace);
     if (prm == PARAM_NULL)
+    {
         obj->readDODF(ns, sz, offset, buf);
+        toHost(format, ns * sz, buf, trace);
+    }
     else
     {
         std::vector<uchar> dobuf(sz * SEGSz::getDOSz(ns)); //FIXME: Potentially a big allocation
@@ -130,21 +147,20 @@ void ReadSEGY::readTrace(csize_t sz, csize_t * offset, trace_t * trace, Param *
         if (sz)
             extractParam(sz, dobuf.data(), prm, SEGSz::getDFSz(ns), skip);
 
+        //Copy the samples out of the data-objects and convert them in the same pass
         for (size_t i = 0; i < sz; i++)
-            std::copy(&dobuf[i * SEGSz::getDOSz(ns) + SEGSz::getMDSz()], &dobuf[(i+1) * SEGSz::getDOSz(ns)],
-                      buf + i * SEGSz::getDFSz(ns));
+            toHost(format, ns, &dobuf[i * SEGSz::getDOSz(ns) + SEGSz::getMDSz()], trace + i * ns);
     }
-
-    if (format == Format::IBM)
-        for (size_t i = 0; i < ns * sz; i ++)
-            trace[i] = convertIBMtoIEEE(trace[i], true);
-    else
-        for (size_t i = 0; i < ns * sz; i++)
-            reverse4Bytes(&buf[i*sizeof(float)]);
 }
 
 void ReadSEGY::readTraceNonMono(csize_t sz, csize_t * offset, trace_t * trace, Param * prm, csize_t skip) const
 {
+    if (!sz)    //Still make the collective calls
+    {
+        readTrace(0U, offset, trace, prm, skip);
+        return;
+    }
+
     //Sort the initial offset and make a new offset without duplicates
     auto idx = getSortIndex(sz, offset);
     std::vector<size_t> nodups;
@@ -181,4 +197,32 @@ void ReadSEGY::readParam(csize_t sz, csize_t * offset, Param * prm, csize_t skip
             extractParam(sz, buf.data(), prm, 0U, skip);
     }
 }
+
+void ReadSEGY::readParam(csize_t offset, csize_t sz, RawParamView * prm, csize_t skip) const
+{
+    if (offset >= nt && sz)   //Nothing to be read.
+    {
+        piol->log->record(name, Log::Layer::File, Log::Status::Warning,
+            "readParam() was called for a zero byte read", Log::Verb::None);
+        return;
+    }
+
+    //Don't process beyond end of file if we can
+    size_t ntz = (!sz ? 0U : (offset + sz > nt ? nt - offset : sz));
+
+    //The headers are read straight into the view
+    std::vector<uchar> buf(prm == nullptr ? SEGSz::getMDSz() * ntz : 0U);
+    obj->readDOMD(offset, ns, ntz, (prm == nullptr ? buf.data() : prm->data(skip)));
+}
+
+void ReadSEGY::readParam(csize_t sz, csize_t * offset, RawParamView * prm, csize_t skip) const
+{
+    if (!sz)   //Nothing to be written.
+        obj->readDOMD(0, 0, nullptr, nullptr);
+    else
+    {
+        std::vector<uchar> buf(prm == nullptr ? SEGSz::getMDSz() * sz : 0U);
+        obj->readDOMD(ns, sz, offset, (prm == nullptr ? buf.data() : prm->data(skip)));
+    }
+}
 }}
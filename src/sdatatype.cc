@@ -9,6 +9,10 @@
 #include "global.hh"
 #include "share/datatype.hh"
 #include <arpa/inet.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PIOL_X86
+#endif
 
 namespace PIOL {
 void reverse4Bytes(uchar * src)
@@ -72,4 +76,308 @@ float convertIBMtoIEEE(const float f, bool bigEndian)
 
     return tofloat(sign | exp | frac);
 }
+
+#ifdef PIOL_X86
+/*! Convert IBM floats to IEEE754 floats with SSE4.1. The method is the same as the scalar
+ *  version but branch-free, the leading zero count is the number of the thresholds
+ *  2^21, 2^22 and 2^23 which the fraction is below.
+ *  \param[in] sz The number of floats
+ *  \param[in] src The array of IBM floats
+ *  \param[out] dst The array of IEEE754 floats. This can be the same as src.
+ *  \param[in] bigEndian True if the data is in big endian format
+ *  \return The number of floats converted. The remainder is left for the scalar version.
+ */
+__attribute__((target("sse4.1,ssse3")))
+static size_t convertSSE4(csize_t sz, const float * src, float * dst, bool bigEndian)
+{
+    const __m128i swap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    const __m128i fmask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i smask = _mm_set1_epi32(int32_t(0x80000000));
+    const __m128i emask = _mm_set1_epi32(0x7F);
+    const __m128i m23 = _mm_set1_epi32(0x7FFFFF);
+    const __m128i byte = _mm_set1_epi32(0xFF);
+    const __m128i bias = _mm_set1_epi32(256 - 126);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i t21 = _mm_set1_epi32(1 << 21);
+    const __m128i t22 = _mm_set1_epi32(1 << 22);
+    const __m128i t23 = _mm_set1_epi32(1 << 23);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 4U <= sz; i += 4U)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        if (bigEndian)
+            v = _mm_shuffle_epi8(v, swap);
+        __m128i frac = _mm_and_si128(v, fmask);
+        __m128i sign = _mm_and_si128(v, smask);
+        __m128i exp = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 24), emask), 2);
+
+        //Each mask is -1 where the fraction is below the threshold
+        __m128i c21 = _mm_cmplt_epi32(frac, t21);
+        __m128i c22 = _mm_cmplt_epi32(frac, t22);
+        __m128i c23 = _mm_cmplt_epi32(frac, t23);
+
+        //Multiply by 2^shift = 1 + c23 + 2*c22 + 4*c21 (with the masks taken as 1)
+        __m128i pow = _mm_sub_epi32(one, _mm_add_epi32(c23, _mm_add_epi32(_mm_slli_epi32(c22, 1), _mm_slli_epi32(c21, 2))));
+        frac = _mm_and_si128(_mm_mullo_epi32(frac, pow), m23);
+
+        exp = _mm_add_epi32(exp, _mm_add_epi32(c21, _mm_add_epi32(c22, c23)));
+        exp = _mm_slli_epi32(_mm_and_si128(_mm_sub_epi32(exp, bias), byte), 23);
+
+        __m128i res = _mm_or_si128(sign, _mm_or_si128(exp, frac));
+        __m128i isz = _mm_cmpeq_epi32(_mm_and_si128(v, fmask), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_andnot_si128(isz, res));
+    }
+    return i;
+}
+
+/*! Convert IBM floats to IEEE754 floats with AVX2.
+ *  \param[in] sz The number of floats
+ *  \param[in] src The array of IBM floats
+ *  \param[out] dst The array of IEEE754 floats. This can be the same as src.
+ *  \param[in] bigEndian True if the data is in big endian format
+ *  \return The number of floats converted. The remainder is left for the scalar version.
+ */
+__attribute__((target("avx2")))
+static size_t convertAVX2(csize_t sz, const float * src, float * dst, bool bigEndian)
+{
+    const __m256i swap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                         12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    const __m256i fmask = _mm256_set1_epi32(0x00FFFFFF);
+    const __m256i smask = _mm256_set1_epi32(int32_t(0x80000000));
+    const __m256i emask = _mm256_set1_epi32(0x7F);
+    const __m256i m23 = _mm256_set1_epi32(0x7FFFFF);
+    const __m256i byte = _mm256_set1_epi32(0xFF);
+    const __m256i bias = _mm256_set1_epi32(256 - 126);
+    const __m256i t21 = _mm256_set1_epi32((1 << 21) - 1);
+    const __m256i t22 = _mm256_set1_epi32((1 << 22) - 1);
+    const __m256i t23 = _mm256_set1_epi32((1 << 23) - 1);
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 8U <= sz; i += 8U)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        if (bigEndian)
+            v = _mm256_shuffle_epi8(v, swap);
+        __m256i frac = _mm256_and_si256(v, fmask);
+        __m256i sign = _mm256_and_si256(v, smask);
+        __m256i exp = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(v, 24), emask), 2);
+
+        //Each mask is -1 where the fraction is below the threshold, so the sum is -shift
+        __m256i nshift = _mm256_add_epi32(_mm256_cmpgt_epi32(t21, frac),
+                         _mm256_add_epi32(_mm256_cmpgt_epi32(t22, frac), _mm256_cmpgt_epi32(t23, frac)));
+        frac = _mm256_and_si256(_mm256_sllv_epi32(frac, _mm256_sub_epi32(zero, nshift)), m23);
+
+        exp = _mm256_add_epi32(exp, nshift);
+        exp = _mm256_slli_epi32(_mm256_and_si256(_mm256_sub_epi32(exp, bias), byte), 23);
+
+        __m256i res = _mm256_or_si256(sign, _mm256_or_si256(exp, frac));
+        __m256i isz = _mm256_cmpeq_epi32(_mm256_and_si256(v, fmask), zero);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_andnot_si256(isz, res));
+    }
+    return i;
+}
+
+/*! Convert IBM floats to IEEE754 floats with AVX-512.
+ *  \param[in] sz The number of floats
+ *  \param[in] src The array of IBM floats
+ *  \param[out] dst The array of IEEE754 floats. This can be the same as src.
+ *  \param[in] bigEndian True if the data is in big endian format
+ *  \return The number of floats converted. The remainder is left for the scalar version.
+ */
+__attribute__((target("avx512f,avx512bw")))
+static size_t convertAVX512(csize_t sz, const float * src, float * dst, bool bigEndian)
+{
+    const __m512i swap = _mm512_set_epi32(0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203,
+                                          0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203,
+                                          0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203,
+                                          0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203);
+    const __m512i fmask = _mm512_set1_epi32(0x00FFFFFF);
+    const __m512i smask = _mm512_set1_epi32(int32_t(0x80000000));
+    const __m512i emask = _mm512_set1_epi32(0x7F);
+    const __m512i m23 = _mm512_set1_epi32(0x7FFFFF);
+    const __m512i byte = _mm512_set1_epi32(0xFF);
+    const __m512i bias = _mm512_set1_epi32(256 - 126);
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i t21 = _mm512_set1_epi32(1 << 21);
+    const __m512i t22 = _mm512_set1_epi32(1 << 22);
+    const __m512i t23 = _mm512_set1_epi32(1 << 23);
+    //The unmasked shifts merge into an undefined vector, which GCC reports as maybe uninitialized.
+    //The zero masked forms with every lane selected are the same instructions.
+    const __mmask16 all = 0xFFFF;
+
+    size_t i = 0;
+    for (; i + 16U <= sz; i += 16U)
+    {
+        __m512i v = _mm512_loadu_si512(src + i);
+        if (bigEndian)
+            v = _mm512_shuffle_epi8(v, swap);
+        __m512i frac = _mm512_and_si512(v, fmask);
+        __m512i sign = _mm512_and_si512(v, smask);
+        __m512i exp = _mm512_maskz_slli_epi32(all, _mm512_and_si512(_mm512_maskz_srli_epi32(all, v, 24), emask), 2);
+
+        __m512i shift = _mm512_maskz_mov_epi32(_mm512_cmplt_epu32_mask(frac, t21), one);
+        shift = _mm512_mask_add_epi32(shift, _mm512_cmplt_epu32_mask(frac, t22), shift, one);
+        shift = _mm512_mask_add_epi32(shift, _mm512_cmplt_epu32_mask(frac, t23), shift, one);
+        frac = _mm512_and_si512(_mm512_maskz_sllv_epi32(all, frac, shift), m23);
+
+        exp = _mm512_sub_epi32(exp, _mm512_add_epi32(shift, bias));
+        exp = _mm512_maskz_slli_epi32(all, _mm512_and_si512(exp, byte), 23);
+
+        __m512i res = _mm512_or_si512(sign, _mm512_or_si512(exp, frac));
+        __mmask16 nz = _mm512_test_epi32_mask(v, fmask);
+        _mm512_storeu_si512(dst + i, _mm512_maskz_mov_epi32(nz, res));
+    }
+    return i;
+}
+/*! Reverse the byte order of 4 byte words with SSSE3 byte shuffles.
+ *  \param[in] sz The number of words
+ *  \param[in] src The input words
+ *  \param[out] dst The output words. This can be the same as src.
+ *  \return The number of words processed. The remainder is left for the scalar version.
+ */
+__attribute__((target("ssse3")))
+static size_t swapSSE4(csize_t sz, const uchar * src, uchar * dst)
+{
+    const __m128i swap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    size_t i = 0;
+    for (; i + 4U <= sz; i += 4U)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4U*i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4U*i), _mm_shuffle_epi8(v, swap));
+    }
+    return i;
+}
+
+/*! Reverse the byte order of 4 byte words with AVX2 byte shuffles.
+ *  \param[in] sz The number of words
+ *  \param[in] src The input words
+ *  \param[out] dst The output words. This can be the same as src.
+ *  \return The number of words processed. The remainder is left for the scalar version.
+ */
+__attribute__((target("avx2")))
+static size_t swapAVX2(csize_t sz, const uchar * src, uchar * dst)
+{
+    const __m256i swap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                         12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    size_t i = 0;
+    for (; i + 8U <= sz; i += 8U)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4U*i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 4U*i), _mm256_shuffle_epi8(v, swap));
+    }
+    return i;
+}
+
+/*! Reverse the byte order of 4 byte words with AVX-512 byte shuffles.
+ *  \param[in] sz The number of words
+ *  \param[in] src The input words
+ *  \param[out] dst The output words. This can be the same as src.
+ *  \return The number of words processed. The remainder is left for the scalar version.
+ */
+__attribute__((target("avx512f,avx512bw")))
+static size_t swapAVX512(csize_t sz, const uchar * src, uchar * dst)
+{
+    const __m512i swap = _mm512_set_epi32(0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203,
+                                          0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203,
+                                          0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203,
+                                          0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203);
+    size_t i = 0;
+    for (; i + 16U <= sz; i += 16U)
+        _mm512_storeu_si512(dst + 4U*i, _mm512_shuffle_epi8(_mm512_loadu_si512(src + 4U*i), swap));
+    return i;
+}
+#endif
+
+Isa getIsa(void)
+{
+    static const Isa isa = [] () -> Isa
+    {
+#ifdef PIOL_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            return Isa::AVX512;
+        if (__builtin_cpu_supports("avx2"))
+            return Isa::AVX2;
+        if (__builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("ssse3"))
+            return Isa::SSE4;
+#endif
+        return Isa::Scalar;
+    }();
+    return isa;
+}
+
+void convertIBMtoIEEE(Isa isa, csize_t sz, const float * src, float * dst, bool bigEndian)
+{
+    size_t i = 0;
+#ifdef PIOL_X86
+    switch (isa)
+    {
+        case Isa::AVX512 :
+            i = convertAVX512(sz, src, dst, bigEndian);
+        break;
+        case Isa::AVX2 :
+            i = convertAVX2(sz, src, dst, bigEndian);
+        break;
+        case Isa::SSE4 :
+            i = convertSSE4(sz, src, dst, bigEndian);
+        break;
+        default :
+        break;
+    }
+#endif
+    for (; i < sz; i++)
+        dst[i] = convertIBMtoIEEE(src[i], bigEndian);
+}
+
+void convertIBMtoIEEE(Isa isa, csize_t sz, float * f, bool bigEndian)
+{
+    convertIBMtoIEEE(isa, sz, f, f, bigEndian);
+}
+
+void convertIBMtoIEEE(csize_t sz, const float * src, float * dst, bool bigEndian)
+{
+    convertIBMtoIEEE(getIsa(), sz, src, dst, bigEndian);
+}
+
+void convertIBMtoIEEE(csize_t sz, float * f, bool bigEndian)
+{
+    convertIBMtoIEEE(getIsa(), sz, f, f, bigEndian);
+}
+
+void swap4Bytes(Isa isa, csize_t sz, const uchar * src, uchar * dst)
+{
+    size_t i = 0;
+#ifdef PIOL_X86
+    switch (isa)
+    {
+        case Isa::AVX512 :
+            i = swapAVX512(sz, src, dst);
+        break;
+        case Isa::AVX2 :
+            i = swapAVX2(sz, src, dst);
+        break;
+        case Isa::SSE4 :
+            i = swapSSE4(sz, src, dst);
+        break;
+        default :
+        break;
+    }
+#endif
+    for (; i < sz; i++)
+    {
+        uchar b[4] = {src[4U*i], src[4U*i+1U], src[4U*i+2U], src[4U*i+3U]};
+        dst[4U*i] = b[3];
+        dst[4U*i+1U] = b[2];
+        dst[4U*i+2U] = b[1];
+        dst[4U*i+3U] = b[0];
+    }
+}
+
+void swap4Bytes(csize_t sz, const uchar * src, uchar * dst)
+{
+    swap4Bytes(getIsa(), sz, src, dst);
+}
 }
@@ -11,11 +11,14 @@
 #include <regex>
 #include <numeric>
 #include <map>
+#include <algorithm>
 #include "global.hh"
 #include "share/misc.hh"    //For getSort..
 #include "set/set.hh"
 #include "data/datampiio.hh"
+#include "data/datamemory.hh"
 #include "file/filesegy.hh"
+#include "file/ioplan.hh"
 #include "object/objsegy.hh"
 namespace PIOL {
 typedef std::pair<std::vector<size_t>, std::vector<size_t>> iolst;      //!< Type to link input to output
@@ -54,25 +57,23 @@ size_t readWriteAll(ExSeisPIOL * piol, size_t doff, std::shared_ptr<File::Rule>
     size_t offset = dec.first;
     size_t lnt = dec.second;
     size_t ns = src->readNs();
-    size_t max = memlim / (2U*SEGSz::getDOSz(ns) + rule->memUsage());
+    //The rounds read ahead by the input file are held as well as the read and write data-object buffers.
+    const Data::MPIIO::Opt dopt;
+    size_t max = memlim / ((2U + dopt.ahead)*SEGSz::getDOSz(ns) + rule->memUsage());
     size_t fmax = std::min(max, lnt);
 
-    auto biggest = piol->comm->max(lnt);
-    size_t extra = biggest/max - lnt/max + (biggest % max > 0) - (lnt % max > 0);
+    File::IOPlan plan(piol, lnt, max);
+    plan.add(src, SEGSz::getDOSz(ns));
+    plan.add(dst, SEGSz::getDOSz(ns));
+    plan.readAhead(src, offset);
 
     File::Param prm(rule, fmax);
     std::vector<trace_t> trc(ns * fmax);
-    for (size_t i = 0; i < lnt; i += max)
-    {
-        size_t rblock = (i + max < lnt ? max : lnt - i);
-        src->readTrace(offset + i, rblock, trc.data(), &prm);
-        dst->writeTrace(doff + offset + i, rblock, trc.data(), &prm);
-    }
-    for (size_t i = 0; i < extra; i++)
-    {
-        src->readTrace(size_t(0), size_t(0), nullptr, (File::Param *)nullptr);
-        dst->writeTrace(size_t(0), size_t(0), nullptr, (File::Param *)nullptr);
-    }
+    plan.run([&] (size_t i, size_t rblock)
+        {
+            src->readTrace(offset + i, rblock, trc.data(), &prm);
+            dst->writeTrace(doff + offset + i, rblock, trc.data(), &prm);
+        });
     return src->readNt();
 }
 
@@ -106,11 +107,11 @@ void readWriteTraces(ExSeisPIOL * piol, std::shared_ptr<File::Rule> rule, size_t
     File::Param oprm(rule, fmax);
     std::vector<trace_t> itrc(fmax * ns);
     std::vector<trace_t> otrc(fmax * ns);
-    auto biggest = piol->comm->max(lnt);
-    size_t extra = biggest/max - lnt/max + (biggest % max > 0) - (lnt % max > 0);
-    for (size_t i = 0; i < lnt; i += max)
+    File::IOPlan plan(piol, lnt, max);
+    plan.add(in, SEGSz::getDOSz(ns));
+    plan.add(out, SEGSz::getDOSz(ns));
+    plan.run([&] (size_t i, size_t rblock)
     {
-        size_t rblock = (i + max < lnt ? max : lnt - i);
         in->readTrace(rblock, ilist.data() + i, itrc.data(), &iprm);
         modify(ns, &iprm, itrc.data());
         std::vector<size_t> sortlist = getSortIndex(rblock, olist.data() + i);
@@ -124,12 +125,177 @@ void readWriteTraces(ExSeisPIOL * piol, std::shared_ptr<File::Rule> rule, size_t
         }
 
         out->writeTrace(rblock, sortlist.data(), otrc.data(), &oprm);
+    });
+}
+
+/*! Exchange sets of trace parameters between all processes, a column type at a time.
+ *  \param[in] piol A pointer to the PIOL object.
+ *  \param[in] scnt The number of sets to send to each process, in order.
+ *  \param[in] rcnt The number of sets to receive from each process.
+ *  \param[in] sprm The parameter structure to send, grouped by destination.
+ *  \param[out] rprm The parameter structure to receive into, ordered by the rank of the sender.
+ */
+void exchangePrm(ExSeisPIOL * piol, const std::vector<size_t> & scnt, const std::vector<size_t> & rcnt,
+                 const File::Param & sprm, File::Param * rprm)
+{
+    auto r = sprm.r;
+    rprm->f = File::exchange(piol, scnt, rcnt, r->numFloat, sprm.f);
+    rprm->i = File::exchange(piol, scnt, rcnt, r->numLong, sprm.i);
+    rprm->s = File::exchange(piol, scnt, rcnt, r->numShort, sprm.s);
+    rprm->t = File::exchange(piol, scnt, rcnt, r->numIndex, sprm.t);
+    if (r->numCopy)
+        rprm->c = File::exchange(piol, scnt, rcnt, SEGSz::getMDSz(), sprm.c);
+}
+
+/*! Read the traces of a group of input files and write them to a single output. The output is
+ *  processed in windows. In each window every process reads the local traces which belong in the
+ *  window and sends them to the process which owns their output location. Each process owns a
+ *  contiguous block of each window and writes it with a single contiguous write. A window ends
+ *  before the output location of the first trace which does not fit in the read buffers of a
+ *  process, so no process holds more than half of max traces in any buffer.
+ *  \param[in] piol A pointer to the PIOL object.
+ *  \param[in] rule The rule to use for the trace parameters.
+ *  \param[in] max The maximum number of traces a process holds in two sets of buffers.
+ *  \param[in] desc The input file descriptors.
+ *  \param[in] modify The function to modify traces and parameters.
+ *  \param[out] out The output file interface.
+ *  \return Return false if the output locations are not a permutation of the output traces.
+ *          Nothing is read or written in that case.
+ */
+bool shuffleTraces(ExSeisPIOL * piol, std::shared_ptr<File::Rule> rule, size_t max, std::deque<FileDesc *> & desc,
+                   Mod modify, File::WriteInterface * out)
+{
+    size_t numRank = piol->comm->getNumRank();
+    size_t rank = piol->comm->getRank();
+    size_t ns = desc.front()->ifc->readNs();
+
+    //For each file, the input and output locations ordered by output location
+    std::vector<std::vector<size_t>> ilist(desc.size());
+    std::vector<std::vector<size_t>> olist(desc.size());
+    std::vector<size_t> dest;
+    for (size_t j = 0U; j < desc.size(); j++)
+    {
+        auto & lst = desc[j]->lst;
+        for (size_t i = 0U; i < lst.size(); i++)
+            if (lst[i] != NOT_IN_OUTPUT)
+            {
+                ilist[j].push_back(desc[j]->offset + i);
+                olist[j].push_back(lst[i]);
+            }
+        auto idx = getSortIndex(olist[j].size(), olist[j].data());
+        std::vector<size_t> itmp(idx.size()), otmp(idx.size());
+        for (size_t i = 0U; i < idx.size(); i++)
+        {
+            itmp[i] = ilist[j][idx[i]];
+            otmp[i] = olist[j][idx[i]];
+        }
+        ilist[j] = std::move(itmp);
+        olist[j] = std::move(otmp);
+        dest.insert(dest.end(), olist[j].begin(), olist[j].end());
     }
-    for (size_t i = 0; i < extra; i++)
+    std::sort(dest.begin(), dest.end());
+
+    //Each output location is counted by the process which owns it in a decomposition of the output
+    size_t nt = piol->comm->sum(dest.size());
+    if (piol->comm->max(size_t(!dest.empty() && dest.back() >= nt)))
+        return false;
+    std::vector<size_t> tbound(numRank + 1U, nt);
+    for (size_t i = 0U; i < numRank; i++)
+        tbound[i] = decompose(nt, numRank, i).first;
+    std::vector<size_t> dcnt(numRank, 0U);
+    for (size_t d : dest)
+        dcnt[std::upper_bound(tbound.begin(), tbound.end(), d) - tbound.begin() - 1U]++;
+    std::vector<size_t> rdest = File::exchange(piol, dcnt, File::exchangeCount(piol, dcnt), 1U, dest);
+
+    size_t tsz = tbound[rank + 1U] - tbound[rank];
+    std::vector<bool> seen(tsz, false);
+    bool bad = (rdest.size() != tsz);
+    for (size_t d : rdest)
     {
-        in->readTrace(0, nullptr, nullptr, const_cast<File::Param *>(File::PARAM_NULL));
-        out->writeTrace(0, nullptr, nullptr, File::PARAM_NULL);
+        bad |= seen[d - tbound[rank]];
+        seen[d - tbound[rank]] = true;
+    }
+    if (piol->comm->max(size_t(bad)))
+        return false;
+
+    //Four sets of trace and parameter buffers are held where max allows for two
+    size_t lim = std::max(max / 2U, size_t(1U));
+    File::Param iprm(rule, lim);
+    File::Param sprm(rule, lim);
+    File::Param oprm(rule, lim);
+    std::vector<trace_t> itrc(lim * ns);
+    std::vector<trace_t> strc(lim * ns);
+    std::vector<trace_t> otrc(lim * ns);
+    std::vector<size_t> ipos(lim);
+    std::vector<size_t> cur(desc.size(), 0U);
+    size_t dcur = 0U;
+
+    for (size_t wstart = 0U; wstart < nt;)
+    {
+        //No process reads more than lim traces of the window or owns more than lim of its output
+        size_t lend = (dcur + lim < dest.size() ? dest[dcur + lim] : nt);
+        size_t wend = std::min(piol->comm->min(lend), std::min(nt, wstart + lim * numRank));
+        size_t wsz = wend - wstart;
+        std::vector<size_t> bound(numRank + 1U, wsz);
+        for (size_t i = 0U; i < numRank; i++)
+            bound[i] = decompose(wsz, numRank, i).first;
+
+        //Read the local traces which belong in the window in input order
+        size_t k = 0U;
+        for (size_t j = 0U; j < desc.size(); j++)
+        {
+            size_t n = std::upper_bound(olist[j].begin() + cur[j], olist[j].end(), wend - 1U)
+                     - (olist[j].begin() + cur[j]);
+            auto idx = getSortIndex(n, ilist[j].data() + cur[j]);
+            std::vector<size_t> list(n);
+            for (size_t i = 0U; i < n; i++)
+            {
+                list[i] = ilist[j][cur[j] + idx[i]];
+                ipos[k + i] = olist[j][cur[j] + idx[i]] - wstart;
+            }
+            if (n)
+                desc[j]->ifc->readTrace(n, list.data(), itrc.data() + k * ns, &iprm, k);
+            else
+                desc[j]->ifc->readTrace(0, nullptr, nullptr, const_cast<File::Param *>(File::PARAM_NULL));
+            cur[j] += n;
+            k += n;
+        }
+        modify(ns, &iprm, itrc.data());
+
+        //Group the traces by the process which owns their output location
+        auto idx = getSortIndex(k, ipos.data());
+        std::vector<size_t> scnt(numRank, 0U);
+        std::vector<size_t> spos(k);
+        for (size_t i = 0U; i < k; i++)
+        {
+            spos[i] = ipos[idx[i]];
+            cpyPrm(idx[i], &iprm, i, &sprm);
+            std::copy(itrc.begin() + idx[i] * ns, itrc.begin() + (idx[i] + 1U) * ns, strc.begin() + i * ns);
+            scnt[std::upper_bound(bound.begin(), bound.end(), spos[i]) - bound.begin() - 1U]++;
+        }
+
+        std::vector<size_t> rcnt = File::exchangeCount(piol, scnt);
+        std::vector<size_t> rpos = File::exchange(piol, scnt, rcnt, 1U, spos);
+        std::vector<trace_t> rtrc = File::exchange(piol, scnt, rcnt, ns, strc);
+        File::Param rprm(rule, rpos.size());
+        exchangePrm(piol, scnt, rcnt, sprm, &rprm);
+
+        //Place the received traces in output order and write the local block of the window
+        size_t osz = bound[rank + 1U] - bound[rank];
+        for (size_t i = 0U; i < rpos.size(); i++)
+        {
+            size_t o = rpos[i] - bound[rank];
+            cpyPrm(i, &rprm, o, &oprm);
+            std::copy(rtrc.begin() + i * ns, rtrc.begin() + (i + 1U) * ns, otrc.begin() + o * ns);
+        }
+        if (osz)
+            out->writeTrace(wstart + bound[rank], osz, otrc.data(), &oprm);
+        else
+            out->writeTrace(size_t(0), size_t(0), nullptr, File::PARAM_NULL);
+        dcur += k;
+        wstart = wend;
     }
+    return true;
 }
 
 /*! For CoordElem. Update the dst element based on if the operation gives true.
@@ -152,6 +318,19 @@ void updateElem(CoordElem * src, CoordElem * dst)
     }
 }
 
+/*! Open the Data layer of a file. Names starting with "mem:" are held in memory instead of on storage.
+ *  \param[in] piol The PIOL object
+ *  \param[in] name The name of the file
+ *  \param[in] mode The filemode
+ *  \return The Data layer of the file
+ */
+std::shared_ptr<Data::Interface> openData(Piol piol, const std::string & name, FileMode mode)
+{
+    if (Data::Memory::isMemory(name))
+        return std::make_shared<Data::Memory>(piol, name, mode);
+    return std::make_shared<Data::MPIIO>(piol, name, mode);
+}
+
 //////////////////////////////////////////////CLASS MEMBERS///////////////////////////////////////////////////////////
 
 InternalSet::InternalSet(Piol piol_, std::string pattern, std::string outfix_, std::shared_ptr<File::Rule> rule_) : piol(piol_), outfix(outfix_), rule(rule_)
@@ -168,7 +347,7 @@ InternalSet::~InternalSet(void)
 //TODO: Make multi-file
 void InternalSet::add(std::string name)
 {
-    auto data = std::make_shared<Data::MPIIO>(piol, name, FileMode::Read);
+    auto data = openData(piol, name, FileMode::Read);
     auto obj = std::make_shared<Obj::SEGY>(piol, name, data, FileMode::Read);
     auto in = std::make_unique<File::ReadSEGY>(piol, name, obj);
     add(std::move(in));
@@ -201,35 +380,43 @@ void InternalSet::add(std::unique_ptr<File::ReadInterface> in)
 void InternalSet::fillDesc(std::shared_ptr<ExSeisPIOL> piol, std::string pattern)
 {
     outmsg = "ExSeisPIOL: Set layer output\n";
-    //TODO: Regexes might be more useful for pattern matching instead of globbing
-    glob_t globs;
-    int err = glob(pattern.c_str(), GLOB_TILDE | GLOB_MARK, NULL, &globs);
-    if (err)
-        exit(-1);
-
-    std::regex reg(".*se?gy$", std::regex_constants::icase | std::regex_constants::optimize | std::regex::extended);
+    //In-memory files are not on storage to be globbed, so the pattern is the name of the file.
+    std::vector<std::string> names;
+    if (Data::Memory::isMemory(pattern))
+        names.push_back(pattern);
+    else
+    {
+        //TODO: Regexes might be more useful for pattern matching instead of globbing
+        glob_t globs;
+        int err = glob(pattern.c_str(), GLOB_TILDE | GLOB_MARK, NULL, &globs);
+        if (err)
+            exit(-1);
+
+        std::regex reg(".*se?gy$", std::regex_constants::icase | std::regex_constants::optimize | std::regex::extended);
+        for (size_t i = 0; i < globs.gl_pathc; i++)
+            if (std::regex_match(globs.gl_pathv[i], reg))   //For each input file which matches the regex
+                names.push_back(globs.gl_pathv[i]);
+        globfree(&globs);
+    }
 
-    for (size_t i = 0; i < globs.gl_pathc; i++)
-        if (std::regex_match(globs.gl_pathv[i], reg))   //For each input file which matches the regex
-        {
-            std::string name = globs.gl_pathv[i];
-
-            //Open the file and create the associated layers
-            auto data = std::make_shared<Data::MPIIO>(piol, name, FileMode::Read);
-            auto obj = std::make_shared<Obj::SEGY>(piol, name, data, FileMode::Read);
-            //TODO: There could be a problem with excessive amounts of open files
-            file.emplace_back(std::make_unique<FileDesc>());
-            auto & f = file.back();
-            f->ifc = std::make_unique<File::ReadSEGY>(piol, name, obj);
-
-            //Perform and store the decomposition
-            auto dec = decompose(f->ifc->readNt(), piol->comm->getNumRank(), piol->comm->getRank());
-            f->lst.resize(dec.second);
-            f->offset = dec.first;
-            auto key = std::make_pair<size_t, geom_t>(f->ifc->readNs(), f->ifc->readInc());
-            fmap[key].emplace_back(f.get());
-            offmap[key] = 0U;
-        }
+    for (auto & name : names)
+    {
+        //Open the file and create the associated layers
+        auto data = openData(piol, name, FileMode::Read);
+        auto obj = std::make_shared<Obj::SEGY>(piol, name, data, FileMode::Read);
+        //TODO: There could be a problem with excessive amounts of open files
+        file.emplace_back(std::make_unique<FileDesc>());
+        auto & f = file.back();
+        f->ifc = std::make_unique<File::ReadSEGY>(piol, name, obj);
+
+        //Perform and store the decomposition
+        auto dec = decompose(f->ifc->readNt(), piol->comm->getNumRank(), piol->comm->getRank());
+        f->lst.resize(dec.second);
+        f->offset = dec.first;
+        auto key = std::make_pair<size_t, geom_t>(f->ifc->readNs(), f->ifc->readInc());
+        fmap[key].emplace_back(f.get());
+        offmap[key] = 0U;
+    }
 
     for (auto & f : file)
     {
@@ -245,7 +432,6 @@ void InternalSet::fillDesc(std::shared_ptr<ExSeisPIOL> piol, std::string pattern
         off += f->ifc->readNt();
     }
 
-    globfree(&globs);
     piol->isErr();
 }
 
@@ -289,6 +475,14 @@ void InternalSet::summary(void) const
 }
 
 void InternalSet::sort(File::Compare<File::Param> func)
+{
+    sort(File::SortFunc([func] (ExSeisPIOL * piol, File::Param * prm) -> std::vector<size_t>
+        {
+            return File::sort(piol, prm, func);
+        }));
+}
+
+void InternalSet::sort(File::SortFunc func)
 {
     for (auto & o : fmap)   //Per target output file
     {
@@ -303,46 +497,34 @@ void InternalSet::sort(File::Compare<File::Param> func)
         size_t off = 0U;
         for (size_t i = 0; i < piol->comm->getRank(); i++)
             off += sizes[i];
-        size_t nt = off;
-        for (size_t i = piol->comm->getRank(); i < piol->comm->getNumRank(); i++)
-            nt += sizes[i];
 
-        if (nt < 3U * piol->comm->getNumRank()) //TODO: It will eventually be necessary to support this use case.
-        {
-            piol->log->record("", Log::Layer::Set, Log::Status::Error,
-                "Email cathal@ichec.ie if you want to sort -very- small sets of files with multiple processes.", Log::Verb::None);
-            return;
-        }
-        else
+        //TODO: Do not make assumptions about Parameter sizes fitting in memory.
+        File::Param prm(lsnt);
+        size_t loff = 0;
+        size_t c = 0;
+        for (auto & f : o.second)
         {
-            //TODO: Do not make assumptions about Parameter sizes fitting in memory.
-            File::Param prm(lsnt);
-            size_t loff = 0;
-            size_t c = 0;
-            for (auto & f : o.second)
+            std::vector<size_t> list;
+            for (size_t i = 0; i < f->lst.size(); i++)
+                if (f->lst[i] != NOT_IN_OUTPUT)
+                    list.push_back(f->offset + i);
+
+            f->ifc->readParam(list.size(), list.data(), &prm, loff);
+            for (size_t i = 0; i < list.size(); i++)
             {
-                std::vector<size_t> list;
-                for (size_t i = 0; i < f->lst.size(); i++)
-                    if (f->lst[i] != NOT_IN_OUTPUT)
-                        list.push_back(f->offset + i);
-
-                f->ifc->readParam(list.size(), list.data(), &prm, loff);
-                for (size_t i = 0; i < list.size(); i++)
-                {
-                    setPrm(loff+i, Meta::gtn, off + loff + i, &prm);
-                    setPrm(loff+i, Meta::ltn, list[i] * o.second.size() + c, &prm);
-                }
-                c++;
-                loff += list.size();
+                setPrm(loff+i, Meta::gtn, off + loff + i, &prm);
+                setPrm(loff+i, Meta::ltn, list[i] * o.second.size() + c, &prm);
             }
-
-            auto trlist = File::sort(piol.get(), &prm, func);
-            size_t j = 0;
-            for (auto & f : o.second)
-                for (auto & l : f->lst)
-                    if (l != NOT_IN_OUTPUT)
-                        l = trlist[j++];
+            c++;
+            loff += list.size();
         }
+
+        auto trlist = func(piol.get(), &prm);
+        size_t j = 0;
+        for (auto & f : o.second)
+            for (auto & l : f->lst)
+                if (l != NOT_IN_OUTPUT)
+                    l = trlist[j++];
     }
 }
 
@@ -359,7 +541,7 @@ std::vector<std::string> InternalSet::output(std::string oname)
             name = oname + std::to_string(ns) + "_" + std::to_string(o.first.second) + ".segy";
         names.push_back(name);
 
-        auto data = std::make_shared<Data::MPIIO>(piol, name, FileMode::Write);
+        auto data = openData(piol, name, FileMode::Write);
         auto obj = std::make_shared<Obj::SEGY>(piol, name, data, FileMode::Write);
         auto out = std::make_unique<File::WriteSEGY>(piol, name, obj);
 
@@ -375,13 +557,40 @@ std::vector<std::string> InternalSet::output(std::string oname)
 // The ideal is to have a buffer for each which is emptied when full or EOF. This is a little tricky
 // because the write buffer would interleave with the read a bit.
 
-        for (auto & f : o.second)
-            readWriteTraces(piol.get(), rule, max, f, modify, out.get());
+        if (omode != OutMode::Shuffle || !shuffleTraces(piol.get(), rule, max, o.second, modify, out.get()))
+            for (auto & f : o.second)
+                readWriteTraces(piol.get(), rule, max, f, modify, out.get());
     }
     return names;
 }
 
 void InternalSet::getMinMax(File::Func<File::Param> xlam, File::Func<File::Param> ylam, CoordElem * minmax)
+{
+    //The functions expect each parameter structure to have exactly one entry
+    File::Param e(rule, 1U);
+    getMinMax([xlam, ylam, &e] (const File::RawParamView & prm, File::CoordPair * coord)
+        {
+            for (size_t i = 0; i < prm.size(); i++)
+            {
+                prm.toParam(i, 1U, &e);
+                coord[i] = {xlam(e), ylam(e)};
+            }
+        }, minmax);
+}
+
+void InternalSet::getMinMax(Meta m1, Meta m2, CoordElem * minmax)
+{
+    //Only the two entries are decoded from the raw trace headers
+    getMinMax([m1, m2] (const File::RawParamView & prm, File::CoordPair * coord)
+        {
+            File::RawParamCol<geom_t> x(m1, &prm);
+            File::RawParamCol<geom_t> y(m2, &prm);
+            for (size_t i = 0; i < prm.size(); i++)
+                coord[i] = {x[i], y[i]};
+        }, minmax);
+}
+
+void InternalSet::getMinMax(std::function<void(const File::RawParamView &, File::CoordPair *)> fill, CoordElem * minmax)
 {
     minmax[0].val = std::numeric_limits<geom_t>::max();
     minmax[1].val = std::numeric_limits<geom_t>::min();
@@ -399,16 +608,15 @@ void InternalSet::getMinMax(File::Func<File::Param> xlam, File::Func<File::Param
             if (f->lst[i] != NOT_IN_OUTPUT)
                 l.push_back(f->offset + i);
 
-        std::vector<File::Param> vprm;
-        File::Param prm(rule, l.size());
+        File::RawParamView prm(rule, l.size());
         f->ifc->readParam(l.size(), l.data(), &prm);
 
-        for (size_t i = 0; i < l.size(); i++)
-        {
-            vprm.emplace_back(rule, 1U);
-            cpyPrm(i, &prm, 0, &vprm.back());
-        }
-        File::getMinMax(piol.get(), f->offset, l.size(), vprm.data(), xlam, ylam, tminmax);
+        std::vector<File::CoordPair> coord(l.size());
+        fill(prm, coord.data());
+
+        File::getMinMax<File::CoordPair>(piol.get(), f->offset, l.size(), coord.data(),
+                                         [] (const File::CoordPair & a) -> geom_t { return a.x; },
+                                         [] (const File::CoordPair & a) -> geom_t { return a.y; }, tminmax);
         for (size_t i = 0U; i < 2U; i++)
         {
             updateElem<std::less<geom_t>>(&tminmax[2U*i], &minmax[2U*i]);
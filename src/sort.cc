@@ -4,13 +4,18 @@
  *   \copyright TBD. Do not distribute
  *   \date November 2016
  *   \brief The Sort Operation
- *   \details The algorithm used is a nearest neighbour approach where at each iteration
- *   the lowest valued metadata entries are moved to adjacent processes with a lower rank and a
- *   sort is performed. After the sort the highest entries are moved again to the process with a
- *   higher rank. If each process has the same traces it started off with, the sort
- *   is complete.
+ *   \details The algorithm used is a sample sort (parallel sorting by regular sampling).
+ *   Each process sorts its local entries and selects numRank-1 regularly spaced samples.
+ *   The samples are gathered on the first process which selects numRank-1 splitters and
+ *   shares them with every process. Each process then partitions its sorted entries with
+ *   the splitters and the partitions are exchanged with a single MPI_Alltoallv. The
+ *   received runs are already sorted, so a local merge completes the sort. A final
+ *   exchange restores the original number of entries on each process.
 *//*******************************************************************************************/
 #include <algorithm>
+#include <list>
+#include <memory>
+#include <numeric>
 #include "global.hh"
 #include "ops/sort.hh"
 #include "file/dynsegymd.hh"
@@ -18,325 +23,136 @@
 #include "share/api.hh"
 
 namespace PIOL { namespace File {
-/*! Wait on two requests to finish. The largest and smallest rank only wait on one request.
- *  \param[in] piol The PIOL object.
- *  \param[in] req1 The request that all processes except rank of numRank-1 wait on.
- *  \param[in] req2 The request that all processes except rank of 0 wait on..
- */
-void Wait(ExSeisPIOL * piol, std::vector<MPI_Request> req1, std::vector<MPI_Request> req2)
-{
-    MPI_Status stat;
-    int err;
-    if (piol->comm->getRank() != piol->comm->getNumRank()-1)
-        for (size_t i = 0; i < req1.size(); i++)
-        {
-            err = MPI_Wait(&req1[i], &stat);
-            printErr(piol->log.get(), "", Log::Layer::Ops, err, &stat, "Sort Rcv error");
-        }
-    if (piol->comm->getRank())
-        for (size_t i = 0; i < req2.size(); i++)
-        {
-            err = MPI_Wait(&req2[i], &stat);
-            printErr(piol->log.get(), "", Log::Layer::Ops, err, &stat, "Sort Snd error");
-        }
-}
-
-/*! Send objects from the current processes to the process one rank higher if
- *  such a process exists. Objects are taken from the end of a vector.
- *  Receiving processes put the objects at the start of their vector.
- *  \tparam T Type of vector
- *  \param[in] piol The PIOL object.
- *  \param[in] regionSz The size of data to send/receive.
- *  \param[in,out] dat Vector to be accessed
- */
-template <class T>
-void sendRight(ExSeisPIOL * piol, size_t regionSz, std::vector<T> & dat)
+size_t offcalc(ExSeisPIOL * piol, size_t sz)
 {
     size_t rank = piol->comm->getRank();
-    size_t cnt = regionSz * sizeof(T);
-    std::vector<MPI_Request> rsnd(1);
-    std::vector<MPI_Request> rrcv(1);
+    auto szall = piol->comm->gather(std::vector<size_t>{sz});
 
-    //TODO: Move to the communication layer?
-    if (rank)
-    {
-        int err = MPI_Irecv(dat.data(), cnt, MPI_CHAR, rank-1, 1, MPI_COMM_WORLD, &rrcv[0]);
-        printErr(piol->log.get(), "", Log::Layer::Ops, err, NULL, "Sort MPI_Recv error");
-    }
-    if (rank != piol->comm->getNumRank()-1)
-    {
-        int err = MPI_Isend(&dat[dat.size()-regionSz], cnt, MPI_CHAR, rank+1, 1, MPI_COMM_WORLD, &rsnd[0]);
-        printErr(piol->log.get(), "", Log::Layer::Ops, err, NULL, "Sort MPI_Send error");
-    }
-    Wait(piol, rsnd, rrcv);
+    szall[rank] = 0U;
+    for (size_t i = 0U; i < rank; i++)
+        szall[rank] += szall[i];
+    return szall[rank];
 }
 
-/*! Send objects from the current processes to the process one rank lower if
- *  such a process exists. Objects are taken from the start of a vector.
- *  Receiving processes put the objects at the end of their vector.
- *  \tparam T Type of vector
- *  \param[in] piol The PIOL object.
- *  \param[in] regionSz The size of data to send/receive.
- *  \param[in,out] dat Vector to be accessed
- */
-template <class T>
-void sendLeft(ExSeisPIOL * piol, size_t regionSz, std::vector<T> & dat)
+std::vector<size_t> exchangeCount(ExSeisPIOL * piol, const std::vector<size_t> & scnt)
 {
-    size_t rank = piol->comm->getRank();
-    size_t cnt = regionSz * sizeof(T);
-    std::vector<MPI_Request> rsnd(1);
-    std::vector<MPI_Request> rrcv(1);
-
-    if (rank)
-    {
-        int err = MPI_Isend(dat.data(), cnt, MPI_CHAR, rank-1, 0, MPI_COMM_WORLD, &rsnd[0]);
-        printErr(piol->log.get(), "", Log::Layer::Ops, err, NULL, "Sort MPI_Send error");
-    }
-    if (rank != piol->comm->getNumRank()-1)
-    {
-        int err = MPI_Irecv(&dat[dat.size()-regionSz], cnt, MPI_CHAR, rank+1, 0, MPI_COMM_WORLD, &rrcv[0]);
-        printErr(piol->log.get(), "", Log::Layer::Ops, err, NULL, "Sort MPI_Recv error");
-    }
-    Wait(piol, rrcv, rsnd);
+    std::vector<size_t> rcnt(scnt.size());
+    int err = MPI_Alltoall(scnt.data(), 1, MPIType<size_t>(), rcnt.data(), 1, MPIType<size_t>(), MPI_COMM_WORLD);
+    printErr(piol->log.get(), "", Log::Layer::Ops, err, NULL, "Sort MPI_Alltoall error");
+    return rcnt;
 }
 
-/*! Send objects from the current processes to the process one rank higher if
- *  such a process exists. Objects are taken from the end of a vector.
- *  Receiving processes put the objects at the start of their vector.
- *  \tparam T Type of vector
- *  \param[in] piol The PIOL object.
- *  \param[in] regionSz The size of data to send/receive.
- *  \param[in,out] dat Vector to be accessed
+/*! A handle for a single set of trace parameters within a parameter structure. The handle is
+ *  a flat record so the sort does not need a parameter structure for each trace.
  */
-template <>
-void sendRight<Param>(ExSeisPIOL * piol, size_t regionSz, std::vector<Param> & dat)
+struct PrmRow
 {
-    Param sprm(dat[0].r, regionSz);
-    Param rprm(dat[0].r, regionSz);
-
-    size_t rank = piol->comm->getRank();
-    std::vector<MPI_Request> rsnd(4);
-    std::vector<MPI_Request> rrcv(4);
-
-    Log::Logger * log = piol->log.get();
-    auto err = [log] (int errc, std::string msg, size_t i) -> void
-        {
-            printErr(log, "", Log::Layer::Ops, errc, NULL, msg + std::to_string(i));
-        };
-    if (rank)
-    {
-        std::string msg = "Sort right MPI_Irecv error ";
-        err(MPI_Irecv(rprm.f.data(), rprm.f.size() * sizeof(geom_t), MPI_CHAR, rank-1, 0, MPI_COMM_WORLD, &rrcv[0]), msg, 1);
-        err(MPI_Irecv(rprm.i.data(), rprm.i.size() * sizeof(llint),  MPI_CHAR, rank-1, 0, MPI_COMM_WORLD, &rrcv[1]), msg, 2);
-        err(MPI_Irecv(rprm.s.data(), rprm.s.size() * sizeof(short),  MPI_CHAR, rank-1, 0, MPI_COMM_WORLD, &rrcv[2]), msg, 3);
-        err(MPI_Irecv(rprm.t.data(), rprm.t.size() * sizeof(size_t), MPI_CHAR, rank-1, 0, MPI_COMM_WORLD, &rrcv[3]), msg, 4);
-    }
-    if (rank != piol->comm->getNumRank()-1)
-    {
-        for (size_t i = 0; i < regionSz; i++)
-            cpyPrm(0U, &dat[i+dat.size()-regionSz], i, &sprm);
-
-        std::string msg = "Sort right MPI_Isend error ";
-        err(MPI_Isend(sprm.f.data(), sprm.f.size() * sizeof(geom_t), MPI_CHAR, rank+1, 0, MPI_COMM_WORLD, &rsnd[0]), msg, 1);
-        err(MPI_Isend(sprm.i.data(), sprm.i.size() * sizeof(llint),  MPI_CHAR, rank+1, 0, MPI_COMM_WORLD, &rsnd[1]), msg, 2);
-        err(MPI_Isend(sprm.s.data(), sprm.s.size() * sizeof(short),  MPI_CHAR, rank+1, 0, MPI_COMM_WORLD, &rsnd[2]), msg, 3);
-        err(MPI_Isend(sprm.t.data(), sprm.t.size() * sizeof(size_t), MPI_CHAR, rank+1, 0, MPI_COMM_WORLD, &rsnd[3]), msg, 4);
-    }
-    Wait(piol, rsnd, rrcv);
-
-    if (rank)
-        for (size_t i = 0; i < regionSz; i++)
-            cpyPrm(i, &rprm, 0U, &dat[i]);
-}
-
-/*! Send objects from the current processes to the process one rank lower if
- *  such a process exists. Objects are taken from the start of a vector.
- *  Receiving processes put the objects at the end of their vector.
- *  \tparam T Type of vector
- *  \param[in] piol The PIOL object.
- *  \param[in] regionSz The size of data to send/receive.
- *  \param[in,out] dat Vector to be accessed
+    const Param * prm;  //!< The parameter structure.
+    size_t i;           //!< The set of trace parameters within the structure.
+    size_t gtn;         //!< The global trace number of the set.
+};
+
+/*! Make the handles of every set of trace parameters in a parameter structure.
+ *  \param[in] prm The parameter structure.
+ *  eturn The handles.
  */
-template <>
-void sendLeft<Param>(ExSeisPIOL * piol, size_t regionSz, std::vector<Param> & dat)
+static std::vector<PrmRow> makeRows(const Param * prm)
 {
-    Param sprm(dat[0].r, regionSz);
-    Param rprm(dat[0].r, regionSz);
-
-    size_t rank = piol->comm->getRank();
-    std::vector<MPI_Request> rsnd(4);
-    std::vector<MPI_Request> rrcv(4);
-
-    Log::Logger * log = piol->log.get();
-    auto err = [log] (int errc, std::string msg, size_t i) -> void
-        {
-            printErr(log, "", Log::Layer::Ops, errc, NULL, msg + std::to_string(i));
-        };
-
-    if (rank)
-    {
-        for (size_t i = 0; i < regionSz; i++)
-            cpyPrm(0U, &dat[i], i, &sprm);
-
-        std::string msg = "Sort left MPI_Irecv error ";
-        err(MPI_Isend(sprm.f.data(), sprm.f.size() * sizeof(geom_t), MPI_CHAR, rank-1, 1, MPI_COMM_WORLD, &rsnd[0]), msg, 1);
-        err(MPI_Isend(sprm.i.data(), sprm.i.size() * sizeof(llint),  MPI_CHAR, rank-1, 1, MPI_COMM_WORLD, &rsnd[1]), msg, 2);
-        err(MPI_Isend(sprm.s.data(), sprm.s.size() * sizeof(short),  MPI_CHAR, rank-1, 1, MPI_COMM_WORLD, &rsnd[2]), msg, 3);
-        err(MPI_Isend(sprm.t.data(), sprm.t.size() * sizeof(size_t), MPI_CHAR, rank-1, 1, MPI_COMM_WORLD, &rsnd[3]), msg, 4);
-    }
-    if (rank != piol->comm->getNumRank()-1)
-    {
-        std::string msg = "Sort left MPI_Isend error ";
-        err(MPI_Irecv(rprm.f.data(), rprm.f.size() * sizeof(geom_t), MPI_CHAR, rank+1, 1, MPI_COMM_WORLD, &rrcv[0]), msg, 1);
-        err(MPI_Irecv(rprm.i.data(), rprm.i.size() * sizeof(llint),  MPI_CHAR, rank+1, 1, MPI_COMM_WORLD, &rrcv[1]), msg, 2);
-        err(MPI_Irecv(rprm.s.data(), rprm.s.size() * sizeof(short),  MPI_CHAR, rank+1, 1, MPI_COMM_WORLD, &rrcv[2]), msg, 3);
-        err(MPI_Irecv(rprm.t.data(), rprm.t.size() * sizeof(size_t), MPI_CHAR, rank+1, 1, MPI_COMM_WORLD, &rrcv[3]), msg, 4);
-    }
-
-    Wait(piol, rrcv, rsnd);
-
-    if (rank != piol->comm->getNumRank()-1)
-        for (size_t i = 0; i < regionSz; i++)
-            cpyPrm(i, &rprm, 0U, &dat[i+dat.size()-regionSz]);
-}
-
-/*! Calculate an offset based on local size and implied ordering of left to right.
- *  \param[in] piol The piol handle
- *  \param[in] sz The local size
- *  \return The associated offset
- */
-static size_t offcalc(ExSeisPIOL * piol, size_t sz)
-{
-    size_t rank = piol->comm->getRank();
-    auto szall = piol->comm->gather(std::vector<size_t>{sz});
-
-    szall[rank] = 0U;
-    for (size_t i = 0U; i < rank; i++)
-        szall[rank] += szall[i];
-    return szall[rank];
+    ParamCol<size_t> gtn(Meta::gtn, prm);
+    std::vector<PrmRow> row(prm->size());
+    for (size_t i = 0; i < row.size(); i++)
+        row[i] = {prm, i, gtn[i]};
+    return row;
 }
 
-/*! Function to sort a given vector by a nearest neighbour approach.
- *  \tparam T Type of vector
+/*! Exchange sets of trace parameters between all processes. The sets are gathered into a
+ *  single parameter structure which is exchanged a column type at a time.
  *  \param[in] piol The PIOL object.
- *  \param[in] regionSz The size of the region which will be shared
- *  \param[in] temp1 Temporary vector which is the dat.size()+regionSz.
- *  \param[in,out] dat The vector to sort
- *  \param[in] comp The function to use for less-than comparisons between objects in the
- *                  vector.
+ *  \param[in] scnt The number of sets to send to each process, in order.
+ *  \param[in] rcnt The number of sets to receive from each process.
+ *  \param[in] r The rules shared by all of the parameter structures.
+ *  \param[in] dat The handles of the sets to send.
+ *  \param[in,out] store The owner of the parameter structure which is received.
+ *  \return The handles of the sets received, ordered by the rank of the sender.
  */
-template <class T>
-void sort(ExSeisPIOL * piol, size_t regionSz, std::vector<T> & temp1, std::vector<T> & dat, Compare<T> comp = nullptr)
+static std::vector<PrmRow> exchange(ExSeisPIOL * piol, const std::vector<size_t> & scnt, const std::vector<size_t> & rcnt,
+                                    std::shared_ptr<Rule> r, const std::vector<PrmRow> & dat, std::list<Param> & store)
 {
-    size_t lnt = dat.size();
-    size_t numRank = piol->comm->getNumRank();
-    size_t rank = piol->comm->getRank();
-    size_t edge1 = (rank ? regionSz : 0U);
-    size_t edge2 = (rank != numRank-1 ? regionSz : 0U);
-
-    if (comp != nullptr)
-        std::sort(dat.begin(), dat.begin() + lnt, [comp](auto & a, auto & b) -> bool { return comp(a, b); });
-    else
-        std::sort(dat.begin(), dat.begin() + lnt);
-
-    std::copy(dat.begin(), dat.end(), temp1.begin());
-    std::vector<T> temp2;
-    while (numRank > 1) //Infinite loop if there is more than one process, otherwise no loop
-    {
-        temp2 = temp1;
-        sendLeft(piol, regionSz, temp1);
-
-        if (comp != nullptr)
-            std::sort(temp1.begin() + edge1, temp1.end(), [comp](auto & a, auto & b) -> bool { return comp(a, b); });
-        else
-            std::sort(temp1.begin() + edge1, temp1.end()); // default pair sorting is first then second
-
-        sendRight(piol, regionSz, temp1);
-
-        if (comp != nullptr)
-            std::sort(temp1.begin(), temp1.end() - edge2, [comp](auto & a, auto & b) -> bool { return comp(a, b); });
-        else
-            std::sort(temp1.begin(), temp1.end() - edge2);
-
-        int reduced = 0;
-        for (size_t j = 0; j < lnt && !reduced; j++)
-            reduced += (temp1[j] != temp2[j]);
-        int greduced = 1;
-
-        int err = MPI_Allreduce(&reduced, &greduced, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-        printErr(piol->log.get(), "", Log::Layer::Ops, err, NULL, "Sort MPI_Allreduce error");
-
-        if (!greduced)
-            break;
-    }
-    for (size_t i = 0; i < lnt; i++)
-        dat[i] = temp1[i];
+    Param sprm(r, dat.size());
+    for (size_t i = 0; i < dat.size(); i++)
+        cpyPrm(dat[i].i, dat[i].prm, i, &sprm);
+
+    store.emplace_back(r, std::accumulate(rcnt.begin(), rcnt.end(), size_t(0U)));
+    Param & rprm = store.back();
+    rprm.f = exchange(piol, scnt, rcnt, r->numFloat, sprm.f);
+    rprm.i = exchange(piol, scnt, rcnt, r->numLong, sprm.i);
+    rprm.s = exchange(piol, scnt, rcnt, r->numShort, sprm.s);
+    rprm.t = exchange(piol, scnt, rcnt, r->numIndex, sprm.t);
+    if (r->numCopy)
+        rprm.c = exchange(piol, scnt, rcnt, SEGSz::getMDSz(), sprm.c);
+    return makeRows(&rprm);
 }
 
-/*! Parallel sort a list. Local vector is part of the entire list.
- *  \param[in] piol The PIOL object.
- *  \param[in] list The local vector
- *  \return Return a new sorted vector
- */
 std::vector<size_t> sort(ExSeisPIOL * piol, std::vector<size_t> list)
 {
-    csize_t lnt = list.size();
-    csize_t regionSz = piol->comm->min(lnt) / 4U;
-    csize_t edge2 = (piol->comm->getRank() != piol->comm->getNumRank()-1 ? regionSz : 0U);
-    csize_t offset = offcalc(piol, lnt);
+    csize_t offset = offcalc(piol, list.size());
 
-    std::vector<std::pair<size_t, size_t>> plist(lnt);
-    for (size_t i = 0; i < lnt; i++)
+    //The sort is stable so entries with equal values keep their original order
+    std::vector<SortKey<1U>> key(list.size());
+    for (size_t i = 0; i < list.size(); i++)
     {
-        plist[i].first = list[i];
-        plist[i].second = offset + i;
+        key[i].k[0] = list[i];
+        key[i].gtn = offset + i;
     }
-
-    {
-        std::vector<std::pair<size_t, size_t>> temp1(lnt+edge2);
-
-        //Work-around for bug in the intel compiler (intel/2016-u3) on Fionn with std::pair less-than operator
-        #if defined(__INTEL_COMPILER)
-        Compare<std::pair<size_t, size_t>> check = [](const std::pair<size_t, size_t> & e1, const std::pair<size_t, size_t> & e2) -> bool
-            {
-                return (e1.first < e2.first || (e1.first == e2.first && e1.second < e2.second));
-            };
-        sort(piol, regionSz, temp1, plist, check);
-        #else
-        sort(piol, regionSz, temp1, plist);
-        #endif
-    }
-
-    for (size_t i = 0; i < lnt; i++)
-        list[i] = plist[i].second;
-    return list;
+    return sort(piol, key);
 }
 
 std::vector<size_t> sort(ExSeisPIOL * piol, Param * prm, Compare<Param> comp, bool FileOrder)
 {
-    size_t lnt = prm->size();
-    size_t regionSz = piol->comm->min(lnt) / 4U;
-    size_t edge2 = (piol->comm->getRank() != piol->comm->getNumRank()-1 ? regionSz : 0U);
+    csize_t lnt = prm->size();
+    std::shared_ptr<Rule> r = prm->r;
 
-    std::vector<Param> vprm;
-    for (size_t i = 0; i < lnt; i++)
-    {
-        vprm.emplace_back(prm->r, 1U);
-        cpyPrm(i, prm, 0, &vprm.back());
-    }
+    std::vector<PrmRow> row = makeRows(prm);
 
+    //The comparison function expects each parameter structure to have exactly one entry. A row
+    //is only copied into its scratch structure when it is not already there, which is often
+    //the case as one side of a comparison tends to be reused.
+    struct Scratch
     {
-        std::vector<Param> temp1; //The extra vector temp1 is needed to be larger than vprm for passing values to neighbours
-        for (size_t i = 0; i < lnt+edge2; i++)
-            temp1.emplace_back(prm->r, 1U);
+        Param prm;          //!< The copy of the row.
+        const Param * src;  //!< The parameter structure the row was copied from.
+        size_t i;           //!< The row which was copied.
+        Scratch(std::shared_ptr<Rule> r) : prm(r, 1U), src(nullptr), i(0U) { }
+        const Param & get(const PrmRow & row)
+        {
+            if (src != row.prm || i != row.i)
+            {
+                cpyPrm(row.i, row.prm, 0U, &prm);
+                src = row.prm;
+                i = row.i;
+            }
+            return prm;
+        }
+    };
+    auto e1 = std::make_shared<Scratch>(r);
+    auto e2 = std::make_shared<Scratch>(r);
+    Compare<PrmRow> rcomp = [comp, e1, e2] (const PrmRow & a, const PrmRow & b) -> bool
+        {
+            return comp(e1->get(a), e2->get(b));
+        };
 
-        sort(piol, regionSz, temp1, vprm, comp);
-    }
+    std::list<Param> store;
+    sort(piol, row, rcomp, [piol, r, &store] (const std::vector<size_t> & scnt, const std::vector<size_t> & rcnt,
+                                              const std::vector<PrmRow> & dat)
+        {
+            return exchange(piol, scnt, rcnt, r, dat, store);
+        });
 
-    std::vector<size_t> list(lnt);
-    for (size_t i = 0; i < lnt; i++)
-        list[i] = getPrm<size_t>(0U, Meta::gtn, &vprm[i]);
+    std::vector<size_t> list(row.size());
+    for (size_t i = 0; i < row.size(); i++)
+        list[i] = row[i].gtn;
+    list = balance(piol, lnt, list);
 
-    return (FileOrder ? sort(piol, list): list);
+    return (FileOrder ? sort(piol, list) : list);
 }
 }}
@@ -0,0 +1,17 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \copyright TBD. Do not distribute
+ *   \date July 2016
+ *   \brief
+ *   \details
+ *//*******************************************************************************************/
+#include "file/file.hh"
+#include "object/object.hh"
+namespace PIOL { namespace File {
+void WriteInterface::setBound(csize_t bound) const
+{
+    if (obj != nullptr)
+        obj->setBound(bound);
+}
+}}
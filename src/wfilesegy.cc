@@ -18,6 +18,9 @@ namespace PIOL { namespace File {
 WriteSEGY::Opt::Opt(void)
 {
     incFactor = SI::Micro;
+    scratchMax = 64U * 1024U * 1024U;
+    behindMax = 0U;
+    behindCalls = 0U;
 }
 
 WriteSEGY::WriteSEGY(const Piol piol_, const std::string name_, const WriteSEGY::Opt & opt, std::shared_ptr<Obj::Interface> obj_)
@@ -55,6 +58,83 @@ WriteSEGY::~WriteSEGY(void)
 }
 
 ///////////////////////////////////       Member functions      ///////////////////////////////////
+uchar * WriteSEGY::getScratch(csize_t sz)
+{
+    if (scratch.size() < sz)
+        scratch.resize(sz);
+    return scratch.data();
+}
+
+void WriteSEGY::trimScratch(void)
+{
+    if (scratch.size() > scratchMax)
+        std::vector<uchar>().swap(scratch);
+}
+
+bool WriteSEGY::holdBack(const Part part, csize_t offset, csize_t sz, csize_t tsz, uchar ** d)
+{
+    if (!behindMax)
+        return false;
+
+    //One if the run would pass the cap with what is held, two if it would pass it on its own
+    csize_t over = piol->comm->max(sz * tsz > behindMax ? 2U : (behind.d.size() + sz * tsz > behindMax ? 1U : 0U));
+    if (behind.calls && (over || (behindCalls && behind.calls >= behindCalls) || behind.part != part || behind.ns != ns))
+        writeBehind();
+    if (over == 2U)
+        return false;
+
+    behind.part = part;
+    behind.ns = ns;
+    behind.calls++;
+    if (sz)
+    {
+        if (behind.runs.size() && behind.runs.back().first + behind.runs.back().second == offset)
+            behind.runs.back().second += sz;
+        else
+            behind.runs.emplace_back(offset, sz);
+    }
+    csize_t end = behind.d.size();
+    behind.d.resize(end + sz * tsz);
+    *d = behind.d.data() + end;
+    return true;
+}
+
+void WriteSEGY::writeBehind(void)
+{
+    //Processes which held fewer runs make empty writes to match the others
+    csize_t nrun = piol->comm->max(behind.runs.size());
+    csize_t tsz = (behind.part == Part::DO ? SEGSz::getDOSz(behind.ns)
+                : (behind.part == Part::DF ? SEGSz::getDFSz(behind.ns) : SEGSz::getMDSz()));
+    uchar * d = behind.d.data();
+    for (size_t i = 0; i < nrun; i++)
+    {
+        csize_t offset = (i < behind.runs.size() ? behind.runs[i].first : 0U);
+        csize_t sz = (i < behind.runs.size() ? behind.runs[i].second : 0U);
+        switch (behind.part)
+        {
+            case Part::DO :
+                obj->writeDO(offset, behind.ns, sz, (sz ? d : nullptr));
+            break;
+            case Part::DF :
+                obj->writeDODF(offset, behind.ns, sz, (sz ? d : nullptr));
+            break;
+            case Part::MD :
+                obj->writeDOMD(offset, behind.ns, sz, (sz ? d : nullptr));
+            break;
+        }
+        d += sz * tsz;
+    }
+    behind.calls = 0U;
+    behind.runs.clear();
+    behind.d.clear();
+}
+
+void WriteSEGY::flush(void)
+{
+    if (behind.calls)
+        writeBehind();
+}
+
 void WriteSEGY::packHeader(uchar * buf) const
 {
     for (size_t i = 0; i < text.size(); i++)
@@ -74,6 +154,12 @@ void WriteSEGY::packHeader(uchar * buf) const
 void WriteSEGY::Init(const WriteSEGY::Opt & opt)
 {
     incFactor = opt.incFactor;
+    scratchMax = opt.scratchMax;
+    behindMax = opt.behindMax;
+    behindCalls = opt.behindCalls;
+    behind.part = Part::DO;
+    behind.ns = 0U;
+    behind.calls = 0U;
     memset(&state, 0, sizeof(Flags));
     format = Format::IEEE;
     ns = 0U;
@@ -85,6 +171,7 @@ void WriteSEGY::Init(const WriteSEGY::Opt & opt)
 
 size_t WriteSEGY::calcNt(void)
 {
+    flush();
     if (state.stalent)
     {
         nt = piol->comm->max(nt);
@@ -154,7 +241,7 @@ void WriteSEGY::writeInc(const geom_t inc_)
     }
 }
 
-void WriteSEGY::writeTrace(csize_t offset, csize_t sz, trace_t * trace, const Param * prm, csize_t skip)
+void WriteSEGY::writeTrace(csize_t offset, csize_t sz, const trace_t * trace, const Param * prm, csize_t skip)
 {
     #ifdef NT_LIMITS
     if (sz+offset > NT_LIMITS)
@@ -165,28 +252,42 @@ void WriteSEGY::writeTrace(csize_t offset, csize_t sz, trace_t * trace, const Pa
     }
     #endif
 
-    uchar * buf = reinterpret_cast<uchar *>(trace);
-
-    //TODO: Check cache effects doing both of these loops the other way.
-    //TODO: Add unit test for reverse4Bytes
-    for (size_t i = 0; i < ns * sz; i++)
-        reverse4Bytes(&buf[i*sizeof(float)]); //TODO: Add length check
+    const uchar * buf = reinterpret_cast<const uchar *>(trace);
 
+    //The samples are swapped into the scratch buffer so the caller's traces are never modified
+    //A held back run is converted straight into the write-behind buffer
     if (prm == PARAM_NULL)
-        obj->writeDODF(offset, ns, sz, buf);
+    {
+        uchar * dfbuf = nullptr;
+        const bool held = holdBack(Part::DF, offset, sz, SEGSz::getDFSz(ns), &dfbuf);
+        if (!held)
+            dfbuf = getScratch(sz * SEGSz::getDFSz(ns));
+        swap4Bytes(ns * sz, buf, dfbuf);
+        if (!held)
+            obj->writeDODF(offset, ns, sz, dfbuf);
+    }
     else
     {
-        std::vector<uchar> dobuf(sz * SEGSz::getDOSz(ns)); //FIXME: Potentially a big allocation
-        if (sz)
-            insertParam(sz, prm, dobuf.data(), SEGSz::getDFSz(ns), skip);
+        uchar * dobuf = nullptr;
+        const bool held = holdBack(Part::DO, offset, sz, SEGSz::getDOSz(ns), &dobuf);
+        if (!held)
+        {
+            //Placed so the Data layer can write the scratch buffer without a copy
+            dobuf = obj->place(SEGSz::getDOLoc(offset, ns), sz * SEGSz::getDOSz(ns), scratch);
+        }
+        //Copy the samples into the data-objects and swap them in the same pass. The scratch
+        //buffer is reused so the trace headers are cleared first.
         for (size_t i = 0; i < sz; i++)
-            std::copy(&buf[i * SEGSz::getDFSz(ns)], &buf[(i+1) * SEGSz::getDFSz(ns)],
-                      dobuf.begin() + i * SEGSz::getDOSz(ns) + SEGSz::getMDSz());
-        obj->writeDO(offset, ns, sz, dobuf.data());
+        {
+            std::fill(&dobuf[i * SEGSz::getDOSz(ns)], &dobuf[i * SEGSz::getDOSz(ns) + SEGSz::getMDSz()], 0U);
+            swap4Bytes(ns, &buf[i * SEGSz::getDFSz(ns)], &dobuf[i * SEGSz::getDOSz(ns) + SEGSz::getMDSz()]);
+        }
+        if (sz)
+            insertParam(sz, prm, dobuf, SEGSz::getDFSz(ns), skip);
+        if (!held)
+            obj->writeDO(offset, ns, sz, dobuf);
     }
-
-    for (size_t i = 0; i < ns * sz; i++)
-        reverse4Bytes(&buf[i*sizeof(float)]);
+    trimScratch();
 
     state.stalent = true;
     nt = std::max(offset + sz, nt);
@@ -202,46 +303,55 @@ void WriteSEGY::writeParam(csize_t offset, csize_t sz, const Param * prm, csize_
         return;
     }
     #endif
+    uchar * mdbuf = nullptr;
+    const bool held = holdBack(Part::MD, offset, sz, SEGSz::getMDSz(), &mdbuf);
     if (!sz)   //Nothing to be written.
     {
-        obj->writeDOMD(0, 0, size_t(0), nullptr);
+        if (!held)
+            obj->writeDOMD(0, 0, size_t(0), nullptr);
         return;
     }
-    std::vector<uchar> buf(SEGSz::getMDSz() * sz);
+    std::vector<uchar> buf(held ? 0U : SEGSz::getMDSz() * sz);
+    if (!held)
+        mdbuf = buf.data();
 
     if (prm != nullptr)
-        insertParam(sz, prm, buf.data(), 0U, skip);
+        insertParam(sz, prm, mdbuf, 0U, skip);
 
-    obj->writeDOMD(offset, ns, sz, buf.data());
+    if (!held)
+        obj->writeDOMD(offset, ns, sz, mdbuf);
 
     state.stalent = true;
     nt = std::max(offset + sz, nt);
 }
 
-void WriteSEGY::writeTrace(csize_t sz, csize_t * offset, trace_t * trace, const Param * prm, csize_t skip)
+void WriteSEGY::writeTrace(csize_t sz, csize_t * offset, const trace_t * trace, const Param * prm, csize_t skip)
 {
-    uchar * buf = reinterpret_cast<uchar *>(trace);
-
-    //TODO: Check cache effects doing both of these loops the other way.
-    //TODO: Add unit test for reverse4Bytes
-    for (size_t i = 0; i < ns * sz; i++)
-        reverse4Bytes(&buf[i*sizeof(float)]); //TODO: Add length check
+    flush();
+    const uchar * buf = reinterpret_cast<const uchar *>(trace);
 
+    //The samples are swapped into the scratch buffer so the caller's traces are never modified
     if (prm == PARAM_NULL)
-        obj->writeDODF(ns, sz, offset, buf);
+    {
+        uchar * dfbuf = getScratch(sz * SEGSz::getDFSz(ns));
+        swap4Bytes(ns * sz, buf, dfbuf);
+        obj->writeDODF(ns, sz, offset, dfbuf);
+    }
     else
     {
-        std::vector<uchar> dobuf(sz * SEGSz::getDOSz(ns));          //FIXME: Potentially a big allocation
-        if (sz)
-            insertParam(sz, prm, dobuf.data(), SEGSz::getDFSz(ns), skip);
+        uchar * dobuf = getScratch(sz * SEGSz::getDOSz(ns));
+        //Copy the samples into the data-objects and swap them in the same pass. The scratch
+        //buffer is reused so the trace headers are cleared first.
         for (size_t i = 0; i < sz; i++)
-            std::copy(&buf[i * SEGSz::getDFSz(ns)], &buf[(i+1) * SEGSz::getDFSz(ns)],
-                      dobuf.begin() + i * SEGSz::getDOSz(ns) + SEGSz::getMDSz());
-        obj->writeDO(ns, sz, offset, dobuf.data());
+        {
+            std::fill(&dobuf[i * SEGSz::getDOSz(ns)], &dobuf[i * SEGSz::getDOSz(ns) + SEGSz::getMDSz()], 0U);
+            swap4Bytes(ns, &buf[i * SEGSz::getDFSz(ns)], &dobuf[i * SEGSz::getDOSz(ns) + SEGSz::getMDSz()]);
+        }
+        if (sz)
+            insertParam(sz, prm, dobuf, SEGSz::getDFSz(ns), skip);
+        obj->writeDO(ns, sz, offset, dobuf);
     }
-
-    for (size_t i = 0; i < ns * sz; i++)
-        reverse4Bytes(&buf[i*sizeof(float)]);
+    trimScratch();
 
     state.stalent = true;
     if (sz)
@@ -263,6 +373,7 @@ void WriteSEGY::writeParam(csize_t sz, csize_t * offset, const Param * prm, csiz
     }
     #endif
 
+    flush();
     if (!sz)   //Nothing to be written.
     {
         obj->writeDOMD(0, 0, nullptr, nullptr);
@@ -0,0 +1,89 @@
+#include "datampiiotest.hh"
+
+//The tests every backend shares. Backend specific tests are in the file of each backend.
+template <class O>
+class ReadBackendTest : public BackendTest<O> { };
+
+template <class O>
+class WriteBackendTest : public BackendTest<O> { };
+
+template <class O>
+class EndBackendTest : public BackendTest<O> { };
+
+typedef Types<Data::URing::Opt, Data::MMap::Opt, Data::TwoPhase::Opt, Data::Cache::Opt> ReadBackends;
+typedef Types<Data::URing::Opt, Data::Memory::Opt, Data::Stripe::Opt, Data::TwoPhase::Opt, Data::Cache::Opt,
+              Data::Compress::Opt> WriteBackends;
+//The backends which leave the bytes past the end of the file untouched, as MPI-IO does
+typedef Types<Data::URing::Opt, Data::MMap::Opt, Data::Cache::Opt> EndBackends;
+TYPED_TEST_CASE(ReadBackendTest, ReadBackends);
+TYPED_TEST_CASE(WriteBackendTest, WriteBackends);
+TYPED_TEST_CASE(EndBackendTest, EndBackends);
+
+TYPED_TEST(ReadBackendTest, Constructor)
+{
+    this->makeData(smallFile);
+    this->piol->isErr();
+    EXPECT_EQ(smallSize, this->data->getFileSz());
+
+    this->makeData(zeroFile);
+    this->piol->isErr();
+    EXPECT_EQ(0U, this->data->getFileSz());
+
+    this->makeData(notFile);
+    EXPECT_FALSE(this->piol->log->loglist.empty());
+    this->piol->log->loglist.clear();
+}
+
+TYPED_TEST(ReadBackendTest, ReadContig)
+{
+    this->makeData(smallSEGYFile);
+    this->template readSmallBlocks<false>(400U, 261U);
+    this->template readBigBlocks<false>(100U, 261U);
+    this->template readSmallBlocks<false>(400U, 261U, 200U);
+    this->piol->isErr();
+}
+
+TYPED_TEST(ReadBackendTest, ReadBlocks)
+{
+    this->makeData(smallSEGYFile);
+    this->template readSmallBlocks<true>(400U, 261U);
+    this->template readBigBlocks<true>(100U, 261U);
+    this->template readSmallBlocks<true>(400U, 261U, 300U);
+    this->piol->isErr();
+}
+
+TYPED_TEST(ReadBackendTest, ReadList)
+{
+    this->makeData(smallSEGYFile);
+    auto vec = getRandomVec(200U, 400U, 1337);
+    this->readList(vec.size(), 261U, vec.data());
+    this->piol->isErr();
+}
+
+TYPED_TEST(EndBackendTest, ReadPastEnd)
+{
+    this->makeData(smallSEGYFile);
+    std::vector<uchar> d(10U, 7U);
+    this->data->read(this->data->getFileSz() - 5U, d.size(), d.data());
+    EXPECT_EQ(7U, d[9]);
+    this->piol->isErr();
+}
+
+TYPED_TEST(WriteBackendTest, Constructor)
+{
+    this->template makeData<true>(tempFile);
+    this->piol->isErr();
+    EXPECT_EQ(0U, this->data->getFileSz());
+}
+
+TYPED_TEST(WriteBackendTest, Write)
+{
+    //Processes are not synchronised by the calls so each stage is fenced
+    this->template makeData<true>(tempFile);
+    this->template writeSmallBlocks<false>(100U, 261U);
+    this->piol->comm->barrier();
+    this->template writeBigBlocks<true>(100U, 261U, 20U);
+    this->piol->comm->barrier();
+    this->writeList(200U, 261U);
+    this->piol->isErr();
+}
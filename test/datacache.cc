@@ -0,0 +1,136 @@
+#include "datampiiotest.hh"
+#include "cppfileapi.hh"
+#define private public
+#define protected public
+#include "object/objsegy.hh"
+#include "file/filesegy.hh"
+#undef private
+#undef protected
+
+class CacheTest : public BackendTest<Data::Cache::Opt>
+{
+    protected :
+    Data::Cache::Stats stats(void)
+    {
+        return bdata()->getStats();
+    }
+};
+
+TEST_F(CacheTest, Evict)
+{
+    //A budget much smaller than the file so blocks are evicted as the tests go
+    bopt.budget = 8U*1000U;
+    bopt.block = 1000U;
+    makeData(smallSEGYFile);
+    readSmallBlocks<false>(400U, 261U);
+    readBigBlocks<false>(100U, 261U);
+    readSmallBlocks<true>(400U, 261U);
+    readBigBlocks<true>(100U, 261U);
+    auto vec = getRandomVec(200U, 400U, 1337);
+    readList(vec.size(), 261U, vec.data());
+    EXPECT_LT(0U, stats().evictions);
+    piol->isErr();
+}
+
+TEST_F(CacheTest, Hits)
+{
+    bopt.budget = 2U*1000U;
+    bopt.block = 1000U;
+    makeData(smallFile);
+    std::vector<uchar> d(1500U);
+    data->read(200U, d.size(), d.data());
+    EXPECT_EQ(0U, stats().hits);
+    EXPECT_EQ(2U, stats().misses);
+
+    data->read(900U, 100U, d.data());
+    data->read(1000U, 10U, 1U, 50U, d.data());
+    EXPECT_EQ(2U, stats().hits);
+    EXPECT_EQ(2U, stats().misses);
+
+    //Block 1 is the most recently used so block 0 is evicted
+    data->read(2500U, 10U, d.data());
+    EXPECT_EQ(1U, stats().evictions);
+    data->read(1100U, 10U, d.data());
+    EXPECT_EQ(3U, stats().hits);
+    data->read(100U, 10U, d.data());
+    EXPECT_EQ(4U, stats().misses);
+
+    bdata()->resetStats();
+    EXPECT_EQ(0U, stats().hits);
+    piol->isErr();
+}
+
+TEST_F(CacheTest, Disabled)
+{
+    bopt.budget = 0U;
+    makeData(smallSEGYFile);
+    readSmallBlocks<true>(400U, 261U);
+    auto vec = getRandomVec(200U, 400U, 1337);
+    readList(vec.size(), 261U, vec.data());
+    EXPECT_EQ(0U, stats().misses);
+    piol->isErr();
+}
+
+TEST_F(CacheTest, Write)
+{
+    bopt.block = 512U;
+    makeData<true>(tempFile);
+    //Each process has its own range since the caches are not shared
+    csize_t base = piol->comm->getRank() * 100000U;
+    std::vector<uchar> d(3000U), out(3000U);
+    for (size_t i = 0; i < d.size(); i++)
+        d[i] = getPattern(i);
+    data->write(base, 100U, d.data());
+    data->read(base, 100U, out.data());
+    EXPECT_TRUE(std::equal(d.begin(), d.begin() + 100U, out.begin()));
+
+    //Growing the file past the short block at its end
+    data->write(base + 1000U, 2000U, d.data() + 1000U);
+    data->write(base + 100U, 900U, d.data() + 100U);
+    data->read(base, out.size(), out.data());
+    EXPECT_EQ(d, out);
+    EXPECT_LT(0U, stats().invalidations);
+
+    //Writes drop the blocks they touch
+    std::vector<uchar> blk(128U, 7U);
+    data->write(base + 500U, 64U, 1000U, 2U, blk.data());
+    std::fill(&d[500U], &d[564U], 7U);
+    std::fill(&d[1500U], &d[1564U], 7U);
+    data->read(base, out.size(), out.data());
+    EXPECT_EQ(d, out);
+
+    std::vector<size_t> offset = {base + 10U, base + 2000U};
+    data->write(32U, offset.size(), offset.data(), blk.data());
+    std::fill(&d[2000U], &d[2032U], 7U);
+    std::fill(&d[10U], &d[42U], 7U);
+    data->read(base, out.size(), out.data());
+    EXPECT_EQ(d, out);
+    piol->isErr();
+}
+
+TEST_F(CacheTest, FileLayer)
+{
+    csize_t nt = 400U;
+    csize_t ns = 261U;
+    File::ReadDirect file(piol, smallSEGYFile, File::ReadSEGY::Opt(), Obj::SEGY::Opt(), bopt);
+    piol->isErr();
+    EXPECT_EQ(nt, file.readNt());
+    EXPECT_EQ(ns, file.readNs());
+
+    //A second pass over the same traces is served from the cache
+    auto vec = getRandomVec(50U, nt, 1337);
+    std::vector<trace_t> trc(ns * vec.size());
+    File::Param prm(vec.size());
+    for (size_t pass = 0; pass < 2U; pass++)
+    {
+        file.readTrace(vec.size(), vec.data(), trc.data(), &prm);
+        piol->isErr();
+        for (size_t i = 0; i < vec.size(); i++)
+        {
+            ASSERT_EQ(ilNum(vec[i]), File::getPrm<llint>(i, Meta::il, &prm));
+            ASSERT_EQ(xlNum(vec[i]), File::getPrm<llint>(i, Meta::xl, &prm));
+            for (size_t k = 0; k < ns; k++)
+                ASSERT_EQ(trace_t(vec[i] + k), trc[i*ns + k]) << i << " " << k;
+        }
+    }
+}
@@ -0,0 +1,184 @@
+#include "datampiiotest.hh"
+#include "cppfileapi.hh"
+#define private public
+#define protected public
+#include "object/objsegy.hh"
+#include "file/filesegy.hh"
+#undef private
+#undef protected
+
+class CompressTest : public BackendTest<Data::Compress::Opt>
+{
+    protected :
+    //Copy the small SEG-Y file into the compressed container, the first process writes it all
+    void copySEGY(void)
+    {
+        makeMPIIO(smallSEGYFile);
+        csize_t fsz = data->getFileSz();
+        std::vector<uchar> d(!piol->comm->getRank() ? fsz : 0U);
+        data->read(0U, d.size(), d.data());
+
+        makeData<true>(tempFile);
+        data->write(0U, d.size(), d.data());
+        data->setFileSz(fsz);
+    }
+};
+
+TEST_F(CompressTest, Header)
+{
+    makeData<true>(tempFile);
+    piol->isErr();
+    EXPECT_TRUE(Data::Compress::isCompressed(piol, tempFile));
+    EXPECT_FALSE(Data::Compress::isCompressed(piol, smallSEGYFile));
+
+    makeData(notFile);
+    EXPECT_FALSE(piol->log->loglist.empty());
+    piol->log->loglist.clear();
+}
+
+TEST_F(CompressTest, Write)
+{
+    makeData<true>(tempFile);
+    writeSmallBlocks<false>(100U, 261U);
+    writeBigBlocks<true>(100U, 261U, 20U);
+    writeList(200U, 261U);
+    piol->isErr();
+
+    //Merged chunks are read back after they are stored. The list overwrote the trace data.
+    data->setFileSz(data->getFileSz());
+    readSmallBlocks<false>(100U, 261U);
+    piol->isErr();
+
+    bopt.shuffle = 0U;
+    bopt.budget = 8U*4096U;
+    makeData<true>(tempFile);
+    writeSmallBlocks<true>(100U, 261U);
+    writeBigBlocks<false>(100U, 261U, 20U);
+    writeList(200U, 261U);
+    piol->isErr();
+}
+
+TEST_F(CompressTest, Read)
+{
+    copySEGY();
+    piol->isErr();
+    readSmallBlocks<false>(400U, 261U);
+    readBigBlocks<false>(100U, 261U);
+    readSmallBlocks<true>(400U, 261U);
+    readBigBlocks<true>(100U, 261U);
+    auto vec = getRandomVec(200U, 400U, 1337);
+    readList(vec.size(), 261U, vec.data());
+
+    //The traces compress
+    EXPECT_GT(data->getFileSz(), bdata()->getStoredSz());
+    piol->isErr();
+}
+
+TEST_F(CompressTest, Budget)
+{
+    //Every chunk is written in part so chunks are spilled to stay within the budget
+    bopt.budget = 8U*4096U;
+    makeData<true>(tempFile);
+    csize_t nc = 40U;
+    csize_t bsz = 20U;
+    csize_t sz = nc * 4096U;
+    std::vector<uchar> d(sz / 2U);
+    for (size_t i = 0; i < d.size(); i++)
+        d[i] = getPattern((i / bsz) * 2U * bsz + i % bsz);
+    data->write(0U, bsz, 2U*bsz, d.size() / bsz, d.data());
+    EXPECT_LE(bdata()->held, bopt.budget);
+    EXPECT_FALSE(bdata()->dirty.empty());
+
+    //Reads see the spilled chunks before they are merged
+    std::vector<uchar> out(d.size());
+    data->read(0U, bsz, 2U*bsz, out.size() / bsz, out.data());
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_EQ(d[i], out[i]) << i;
+
+    //Fill the gaps, which reloads the spilled chunks
+    for (size_t i = 0; i < d.size(); i++)
+        d[i] = getPattern((i / bsz) * 2U * bsz + bsz + i % bsz);
+    data->write(bsz, bsz, 2U*bsz, d.size() / bsz, d.data());
+    EXPECT_LE(bdata()->held, bopt.budget);
+    data->setFileSz(sz);
+    EXPECT_TRUE(bdata()->dirty.empty());
+
+    std::vector<uchar> all(sz);
+    data->read(0U, all.size(), all.data());
+    for (size_t i = 0; i < sz; i++)
+        ASSERT_EQ(getPattern(i), all[i]) << i;
+    piol->isErr();
+}
+
+TEST_F(CompressTest, Shared)
+{
+    //Each process writes every third byte so every chunk is merged
+    makeData<true>(tempFile);
+    csize_t rank = piol->comm->getRank();
+    csize_t nrank = piol->comm->getNumRank();
+    csize_t sz = 3U*4096U + 100U;
+    std::vector<size_t> offset;
+    for (size_t i = rank; i < sz; i += nrank)
+        offset.push_back(i);
+    std::vector<uchar> d(offset.size());
+    for (size_t i = 0; i < d.size(); i++)
+        d[i] = getPattern(offset[i]);
+    data->write(1U, offset.size(), offset.data(), d.data());
+    data->setFileSz(sz);
+    EXPECT_EQ(sz, data->getFileSz());
+
+    std::vector<uchar> out(sz);
+    data->read(0U, out.size(), out.data());
+    for (size_t i = 0; i < sz; i++)
+        ASSERT_EQ(getPattern(i), out[i]) << i;
+    piol->isErr();
+}
+
+TEST_F(CompressTest, FileSz)
+{
+    makeData<true>(tempFile);
+    std::vector<uchar> d(10000U);
+    for (size_t i = 0; i < d.size(); i++)
+        d[i] = getPattern(i);
+    data->write(0U, d.size(), d.data());
+
+    //Shrinking clears the end of the last chunk so growing again reads zeros
+    data->setFileSz(5000U);
+    EXPECT_EQ(5000U, data->getFileSz());
+    data->setFileSz(9000U);
+    std::vector<uchar> out(9000U);
+    data->read(0U, out.size(), out.data());
+    EXPECT_TRUE(std::equal(out.begin(), out.begin() + 5000U, d.begin()));
+    for (size_t i = 5000U; i < out.size(); i++)
+        ASSERT_EQ(0U, out[i]) << i;
+    piol->isErr();
+}
+
+TEST_F(CompressTest, FileLayer)
+{
+    csize_t nt = 400U;
+    csize_t ns = 261U;
+    copySEGY();
+    piol->isErr();
+
+    //Readers find the container by its header
+    {
+        File::ReadDirect file(piol, tempFile);
+        piol->isErr();
+        EXPECT_EQ(nt, file.readNt());
+        EXPECT_EQ(ns, file.readNs());
+
+        auto vec = getRandomVec(50U, nt, 1337);
+        std::vector<trace_t> trc(ns * vec.size());
+        File::Param prm(vec.size());
+        file.readTrace(vec.size(), vec.data(), trc.data(), &prm);
+        piol->isErr();
+        for (size_t i = 0; i < vec.size(); i++)
+        {
+            ASSERT_EQ(ilNum(vec[i]), File::getPrm<llint>(i, Meta::il, &prm));
+            ASSERT_EQ(xlNum(vec[i]), File::getPrm<llint>(i, Meta::xl, &prm));
+            for (size_t k = 0; k < ns; k++)
+                ASSERT_EQ(trace_t(vec[i] + k), trc[i*ns + k]) << i << " " << k;
+        }
+    }
+}
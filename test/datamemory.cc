@@ -0,0 +1,239 @@
+#include "datampiiotest.hh"
+#include "cppfileapi.hh"
+#include "set.hh"
+
+typedef BackendTest<Data::Memory::Opt> MemoryTest;
+
+TEST_F(MemoryTest, Names)
+{
+    EXPECT_TRUE(Data::Memory::isMemory("mem:file"));
+    EXPECT_FALSE(Data::Memory::isMemory(tempFile));
+
+    makeData<true>(tempFile);
+    data.reset();
+
+    //Test mode removes the file
+    makeData(tempFile);
+    EXPECT_FALSE(piol->log->loglist.empty());
+    piol->log->loglist.clear();
+}
+
+TEST_F(MemoryTest, FileSz)
+{
+    makeData<true>(tempFile);
+    data->setFileSz(5000U);
+    EXPECT_EQ(5000U, data->getFileSz());
+
+    std::vector<uchar> d(5000U, 3U);
+    data->write(0U, d.size(), d.data());
+    data->setFileSz(100U);
+    EXPECT_EQ(100U, data->getFileSz());
+
+    //The bytes cut off do not come back
+    data->setFileSz(5000U);
+    std::vector<uchar> out(5000U, 7U);
+    data->read(0U, out.size(), out.data());
+    EXPECT_EQ(3U, out[99]);
+    for (size_t i = 100U; i < out.size(); i++)
+        ASSERT_EQ(0U, out[i]) << i;
+
+    //Past the end of the file nothing is read
+    std::vector<uchar> e(10U, 7U);
+    data->read(4995U, e.size(), e.data());
+    EXPECT_EQ(7U, e[9]);
+    piol->isErr();
+}
+
+TEST_F(MemoryTest, Owners)
+{
+    makeData<true>(tempFile);
+    writeSmallBlocks<false>(100U, 261U);
+    writeBigBlocks<true>(100U, 261U, 20U);
+    writeList(200U, 261U);
+
+    //The same after the writes are handed to the owning processes
+    data->setFileSz(data->getFileSz());
+    auto vec = getRandomVec(200U, 1337);
+    readList(vec.size(), 261U, vec.data());
+    readSmallBlocks<false>(20U, 261U);
+    piol->isErr();
+}
+
+TEST_F(MemoryTest, Remote)
+{
+    makeData<true>(tempFile);
+    csize_t rank = piol->comm->getRank();
+    csize_t numRank = piol->comm->getNumRank();
+    csize_t bsz = 777U;
+
+    std::vector<uchar> d(bsz);
+    for (size_t i = 0; i < bsz; i++)
+        d[i] = getPattern(rank * bsz + i);
+    data->write(rank * bsz, bsz, d.data());
+    data->setFileSz(numRank * bsz);
+    EXPECT_EQ(numRank * bsz, data->getFileSz());
+
+    //Every process sees the writes of every other process, wherever the bytes are held
+    std::vector<uchar> out(numRank * bsz);
+    data->read(0U, out.size(), out.data());
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_EQ(getPattern(i), out[i]) << i;
+
+    //Strided writes within the memory of the processes go straight to the owners
+    std::vector<uchar> s(10U);
+    for (size_t i = 0; i < s.size(); i++)
+        s[i] = uchar(rank + i);
+    data->write(rank, 1U, numRank, s.size(), s.data());
+    data->setFileSz(numRank * bsz);
+    data->read(0U, numRank, numRank, s.size(), out.data());
+    for (size_t i = 0; i < numRank * s.size(); i++)
+        ASSERT_EQ(uchar(i % numRank + i / numRank), out[i]) << i;
+    piol->isErr();
+}
+
+TEST_F(MemoryTest, Persist)
+{
+    csize_t nt = 100U;
+    csize_t ns = 261U;
+    std::string name = "mem:persist";
+    //Write the file with the plain MPIIOTest helpers and then close it.
+    data = std::make_shared<Data::Memory>(piol, name, bopt, FileMode::Write);
+    writeSmallBlocks<true>(nt, ns);
+    writeBigBlocks<true>(nt, ns);
+    data.reset();
+
+    //The file is found again by name
+    data = std::make_shared<Data::Memory>(piol, name, bopt, FileMode::Read);
+    piol->isErr();
+    EXPECT_EQ(SEGSz::getDOLoc<float>(nt, ns), data->getFileSz());
+    readSmallBlocks<true>(nt, ns);
+    readBigBlocks<true>(nt, ns);
+    data.reset();
+
+    Data::Memory::erase(name);
+    data = std::make_shared<Data::Memory>(piol, name, bopt, FileMode::Read);
+    EXPECT_FALSE(piol->log->loglist.empty());
+    piol->log->loglist.clear();
+}
+
+TEST_F(MemoryTest, Pipeline)
+{
+    csize_t nt = 200U;
+    csize_t ns = 50U;
+    csize_t rank = piol->comm->getRank();
+    csize_t numRank = piol->comm->getNumRank();
+    csize_t offset = nt * rank / numRank;
+    csize_t lnt = nt * (rank + 1U) / numRank - offset;
+
+    std::string name = "mem:pipeline";
+    {
+        File::WriteDirect out(piol, name);
+        out.writeNs(ns);
+        out.writeNt(nt);
+        out.writeInc(geom_t(0.01));
+        std::vector<trace_t> trc(lnt * ns);
+        for (size_t i = 0; i < lnt; i++)
+            for (size_t k = 0; k < ns; k++)
+                trc[i*ns + k] = trace_t(offset + i + k);
+        out.writeTrace(offset, lnt, trc.data());
+    }
+    piol->isErr();
+
+    File::ReadDirect in(piol, name);
+    piol->isErr();
+    ASSERT_EQ(nt, in.readNt());
+    ASSERT_EQ(ns, in.readNs());
+
+    //Read the traces written by the next process around
+    csize_t roffset = nt * ((rank + 1U) % numRank) / numRank;
+    csize_t rnt = nt * ((rank + 1U) % numRank + 1U) / numRank - roffset;
+    std::vector<trace_t> trc(rnt * ns);
+    in.readTrace(roffset, rnt, trc.data());
+    piol->isErr();
+    for (size_t i = 0; i < rnt; i++)
+        for (size_t k = 0; k < ns; k++)
+            ASSERT_EQ(trace_t(roffset + i + k), trc[i*ns + k]);
+    Data::Memory::erase(name);
+}
+
+TEST_F(MemoryTest, SetPipeline)
+{
+    csize_t nt = 400U;
+    csize_t ns = 261U;
+    //The first stage writes an in-memory file which the second stage finds by name
+    {
+        Set set(piol);
+        set.add(smallSEGYFile);
+        auto names = set.output("mem:stage1");
+        ASSERT_EQ(1U, names.size());
+        EXPECT_EQ("mem:stage1.segy", names[0]);
+    }
+    piol->isErr();
+    {
+        Set set(piol, "mem:stage1.segy", "mem:stage2");
+        EXPECT_EQ(nt, set.getInNt());
+    }
+    piol->isErr();
+
+    //Neither stage touched storage
+    struct stat info;
+    EXPECT_NE(0, stat("mem:stage1.segy", &info));
+    EXPECT_NE(0, stat("mem:stage2.segy", &info));
+
+    File::ReadDirect in(piol, "mem:stage2.segy");
+    piol->isErr();
+    ASSERT_EQ(nt, in.readNt());
+    ASSERT_EQ(ns, in.readNs());
+    auto vec = getRandomVec(50U, nt, 1337);
+    std::vector<trace_t> trc(ns * vec.size());
+    File::Param prm(vec.size());
+    in.readTrace(vec.size(), vec.data(), trc.data(), &prm);
+    piol->isErr();
+    for (size_t i = 0; i < vec.size(); i++)
+    {
+        ASSERT_EQ(ilNum(vec[i]), File::getPrm<llint>(i, Meta::il, &prm));
+        ASSERT_EQ(xlNum(vec[i]), File::getPrm<llint>(i, Meta::xl, &prm));
+        for (size_t k = 0; k < ns; k++)
+            ASSERT_EQ(trace_t(vec[i] + k), trc[i*ns + k]) << i << " " << k;
+    }
+    Data::Memory::erase("mem:stage1.segy");
+    Data::Memory::erase("mem:stage2.segy");
+}
+
+TEST_F(MemoryTest, SetShuffle)
+{
+    //Cross-lines in reverse order scatter each input block over the output
+    auto comp = [] (const File::Param & a, const File::Param & b) -> bool
+    {
+        llint axl = File::getPrm<llint>(0U, Meta::xl, &a);
+        llint bxl = File::getPrm<llint>(0U, Meta::xl, &b);
+        if (axl != bxl)
+            return axl > bxl;
+        return File::getPrm<size_t>(0U, Meta::gtn, &a) < File::getPrm<size_t>(0U, Meta::gtn, &b);
+    };
+    std::vector<std::string> names = {"mem:list", "mem:shuffle"};
+    std::vector<OutMode> modes = {OutMode::List, OutMode::Shuffle};
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        Set set(piol);
+        set.add(smallSEGYFile);
+        set.sort(comp);
+        set.outMode(modes[i]);
+        set.output(names[i]);
+        piol->isErr();
+    }
+
+    //Both modes write the same file
+    Data::Memory list(piol, "mem:list.segy");
+    Data::Memory shuffle(piol, "mem:shuffle.segy");
+    piol->isErr();
+    ASSERT_EQ(list.getFileSz(), shuffle.getFileSz());
+    std::vector<uchar> ld(list.getFileSz()), sd(shuffle.getFileSz());
+    list.read(0U, ld.size(), ld.data());
+    shuffle.read(0U, sd.size(), sd.data());
+    piol->isErr();
+    for (size_t i = 0; i < ld.size(); i++)
+        ASSERT_EQ(ld[i], sd[i]) << i;
+    Data::Memory::erase("mem:list.segy");
+    Data::Memory::erase("mem:shuffle.segy");
+}
@@ -0,0 +1,90 @@
+#include "datampiiotest.hh"
+#define private public
+#define protected public
+#include "object/objsegy.hh"
+#include "file/filesegy.hh"
+#undef private
+#undef protected
+
+typedef BackendTest<Data::MMap::Opt> MMapTest;
+
+TEST_F(MMapTest, ReadOnly)
+{
+    makeData(smallFile);
+    data->setFileSz(smallSize);
+    piol->isErr();
+
+    std::vector<uchar> d(10U);
+    data->write(0U, d.size(), d.data());
+    EXPECT_EXIT(piol->isErr(), ExitedWithCode(EXIT_FAILURE), ".*8 3 Fatal Error in PIOL. . Dumping Log 0");
+}
+
+TEST_F(MMapTest, ReadOnlyOpen)
+{
+    data = std::make_shared<Data::MMap>(piol, tempFile, bopt, FileMode::Write);
+    EXPECT_EXIT(piol->isErr(), ExitedWithCode(EXIT_FAILURE), ".*8 3 Fatal Error in PIOL. . Dumping Log 0");
+}
+
+TEST_F(MMapTest, ReadAdvice)
+{
+    for (auto adv : {Data::Advice::Normal, Data::Advice::Sequential, Data::Advice::Random})
+    {
+        bopt.advice = adv;
+        makeData(smallSEGYFile);
+        readBigBlocks<true>(100U, 261U);
+        auto vec = getRandomVec(100U, 400U, 1337);
+        readList(vec.size(), 261U, vec.data());
+    }
+    //Every read asks for its pages in advance
+    bopt.advice = Data::Advice::Auto;
+    bopt.willSz = 1U;
+    makeData(smallSEGYFile);
+    readSmallBlocks<false>(400U, 261U);
+    readBigBlocks<true>(100U, 261U);
+    piol->isErr();
+}
+
+TEST_F(MMapTest, ReadExtents)
+{
+    makeData(smallSEGYFile);
+    csize_t ns = 261U;
+    csize_t bsz = SEGSz::getDFSz(ns);
+    std::vector<Data::Extent> ext = {{SEGSz::getDODFLoc<float>(10U, ns), 5U, SEGSz::getDOSz(ns)},
+                                     {SEGSz::getDODFLoc<float>(100U, ns), 20U, 2U*SEGSz::getDOSz(ns)}};
+    std::vector<uchar> d(25U * bsz);
+    data->read(bsz, ext, d.data());
+    piol->isErr();
+
+    std::vector<size_t> offset;
+    for (size_t i = 0; i < 5U; i++)
+        offset.push_back(10U + i);
+    for (size_t i = 0; i < 20U; i++)
+        offset.push_back(100U + 2U*i);
+    readList(offset.size(), ns, offset.data());
+
+    std::vector<uchar> d2(d.size());
+    std::vector<size_t> boffset(offset.size());
+    for (size_t i = 0; i < offset.size(); i++)
+        boffset[i] = SEGSz::getDODFLoc<float>(offset[i], ns);
+    data->read(bsz, boffset.size(), boffset.data(), d2.data());
+    EXPECT_EQ(d2, d);
+}
+
+TEST_F(MMapTest, FileLayer)
+{
+    //The Object and File layers work unchanged on top
+    auto mdata = std::make_shared<Data::MMap>(piol, smallSEGYFile, bopt, FileMode::Read);
+    auto obj = std::make_shared<Obj::SEGY>(piol, smallSEGYFile, mdata, FileMode::Read);
+    File::ReadSEGY file(piol, smallSEGYFile, obj);
+    piol->isErr();
+    EXPECT_EQ(400U, file.readNt());
+    EXPECT_EQ(261U, file.readNs());
+
+    auto vec = getRandomVec(20U, 400U, 1337);
+    std::vector<trace_t> trc(261U * vec.size());
+    file.readTrace(vec.size(), vec.data(), trc.data(), const_cast<File::Param *>(File::PARAM_NULL), 0U);
+    piol->isErr();
+    for (size_t i = 0; i < vec.size(); i++)
+        for (size_t k = 0; k < 261U; k++)
+            ASSERT_EQ(trace_t(vec[i] + k), trc[i*261U + k]) << i << " " << k;
+}
@@ -287,12 +287,187 @@ TEST_F(MPIIOTest, FarmReadBlocksMLL)
     piol->isErr();
 }
 
+TEST_F(MPIIOTest, ReadBlocksPersistView)
+{
+    ioopt.mode = Data::IOMode::Collective;
+    ioopt.persistView = true;
+    ioopt.typeCache = 2U;
+    makeMPIIO(smallSEGYFile);
+    csize_t nt = 100;
+    csize_t ns = 261;
+
+    //The same shape and alignment reuse the view, other shapes replace it
+    readSmallBlocks<true>(nt, ns);
+    readSmallBlocks<true>(nt, ns, 200);
+    readBigBlocks<true>(nt, ns);
+    readSmallBlocks<true>(nt, ns, 300);
+    piol->isErr();
+
+    auto mio = std::dynamic_pointer_cast<Data::MPIIO>(data);
+    EXPECT_TRUE(mio->view.active);
+    EXPECT_EQ(2U, mio->types.size());
+
+    //Contiguous I/O resets the view
+    readSmallBlocks<false>(nt, ns, 50);
+    EXPECT_FALSE(mio->view.active);
+    readSmallBlocks<true>(nt, ns, 50);
+    piol->isErr();
+}
+
 ///////Lists//////////
 csize_t largens = 1000U;
 csize_t largent = 2000000U;
 csize_t smallns = 261U;
 csize_t smallnt = 400U;
 
+TEST_F(MPIIOTest, ReadBlocksBound)
+{
+    makeMPIIO(smallSEGYFile);
+    csize_t nt = 100;
+    csize_t ns = 261;
+
+    //With a bound the padding calls are found without communication
+    data->setBound(nt * SEGSz::getDOSz(ns));
+    readSmallBlocks<true>(nt, ns, 100);
+    readSmallBlocks<false>(nt, ns, 100);
+    auto vec = getRandomVec(nt, smallnt, 1337);
+    readList(nt, smallns, vec.data());
+    data->setBound(0U);
+    piol->isErr();
+}
+
+TEST_F(MPIIOTest, ReadIndependent)
+{
+    ioopt.mode = Data::IOMode::Independent;
+    makeMPIIO(smallSEGYFile);
+    csize_t nt = 100;
+    csize_t ns = 261;
+
+    //Independent I/O needs no matching calls so one process reads alone
+    if (!piol->comm->getRank())
+    {
+        readSmallBlocks<true>(nt, ns, 100);
+        readSmallBlocks<false>(nt, ns, 200);
+        auto vec = getRandomVec(nt, smallnt, 1337);
+        readList(nt, smallns, vec.data());
+    }
+    piol->isErr();
+    auto mio = std::dynamic_pointer_cast<Data::MPIIO>(data);
+    EXPECT_EQ(!piol->comm->getRank(), mio->ifile != MPI_FILE_NULL);
+}
+
+TEST_F(MPIIOTest, ReadAuto)
+{
+    ioopt.mode = Data::IOMode::Auto;
+    ioopt.autoSz = SEGSz::getDOSz(smallns) * 50U;
+    makeMPIIO(smallSEGYFile);
+    auto mio = std::dynamic_pointer_cast<Data::MPIIO>(data);
+    size_t remCall = 1U;
+    csize_t rank = piol->comm->getRank();
+    csize_t numRank = piol->comm->getNumRank();
+
+    //Small requests are independent, large balanced requests collective
+    EXPECT_TRUE(mio->choose(10U, SEGSz::getDOSz(smallns), 1000U, &remCall));
+    EXPECT_EQ(0U, remCall);
+    EXPECT_FALSE(mio->choose(100U + rank, SEGSz::getDOSz(smallns), 10U, &remCall));
+    auto calls = [] (csize_t n) { return n / 10U + (n % 10U > 0); };
+    EXPECT_EQ(calls(100U + numRank - 1U) - calls(100U + rank), remCall);
+
+    //Requests where few processes take part are independent
+    if (numRank >= 4U)
+        EXPECT_TRUE(mio->choose((rank ? 0U : 1000U), SEGSz::getDOSz(smallns), 10U, &remCall));
+
+    readSmallBlocks<true>(100U, smallns, 100);
+    readBigBlocks<false>(100U, smallns);
+    auto vec = getRandomVec(100U, smallnt, 1337);
+    readList(100U, smallns, vec.data());
+    piol->isErr();
+}
+
+TEST_F(MPIIOTest, ReadAhead)
+{
+    makeMPIIO(smallSEGYFile);
+    auto mio = std::dynamic_pointer_cast<Data::MPIIO>(data);
+    csize_t rank = piol->comm->getRank();
+    csize_t numRank = piol->comm->getNumRank();
+    csize_t dosz = SEGSz::getDOSz(smallns);
+    csize_t dfsz = SEGSz::getDFSz(smallns);
+    auto check = [] (const uchar * d, csize_t t, csize_t k)
+    {
+        union { float f; uint32_t i; } n;
+        n.f = t + k;
+        ASSERT_EQ(d[4*k], n.i >> 24 & 0xFF) << t << " " << k;
+        ASSERT_EQ(d[4*k + 3], n.i & 0xFF) << t << " " << k;
+    };
+
+    //Every process reads ahead, the last of several processes an empty range
+    csize_t nt = (rank + 1U < numRank || numRank == 1U ? 50U : 0U);
+    csize_t first = rank * 50U;
+    data->prefetch(SEGSz::getDOLoc<float>(first, smallns), nt * dosz);
+    EXPECT_EQ(1U, mio->ahead.size());
+
+    //Whole data-objects and the data-fields inside them are copies of the range. A range is
+    //dropped once it has served a read.
+    std::vector<uchar> d(nt * dosz);
+    data->usePrefetch();
+    data->read(SEGSz::getDOLoc<float>(first, smallns), d.size(), d.data());
+    EXPECT_TRUE(mio->ahead.empty());
+    for (size_t i = 0; i < nt; i++)
+        for (size_t k = 0; k < smallns; k++)
+            check(&d[i*dosz + SEGSz::getMDSz()], first + i, k);
+    data->prefetch(SEGSz::getDOLoc<float>(first, smallns), nt * dosz);
+    data->usePrefetch();
+    data->read(SEGSz::getDODFLoc<float>(first + 10U, smallns), dfsz, dosz, nt / 2U, d.data());
+    EXPECT_TRUE(mio->ahead.empty());
+    for (size_t i = 0; i < nt / 2U; i++)
+        for (size_t k = 0; k < smallns; k++)
+            check(&d[i*dfsz], first + 10U + i, k);
+
+    //A read outside the range after usePrefetch is made alone and leaves the range
+    data->prefetch(SEGSz::getDOLoc<float>(first, smallns), nt * dosz);
+    data->usePrefetch();
+    std::vector<uchar> far(5U * dfsz);
+    data->read(SEGSz::getDODFLoc<float>(300U + rank, smallns), dfsz, dosz, 5U, far.data());
+    EXPECT_EQ(1U, mio->ahead.size());
+    EXPECT_FALSE(mio->aheadNext);
+    for (size_t i = 0; i < 5U; i++)
+        for (size_t k = 0; k < smallns; k++)
+            check(&far[i*dfsz], 300U + rank + i, k);
+    data->dropPrefetch();
+
+    //Reads outside the ranges go to the file
+    readSmallBlocks<true>(20U, smallns, 300U);
+    readBigBlocks<false>(20U, smallns);
+
+    //The oldest range is dropped for a new one
+    data->prefetch(0U, 0U);
+    data->prefetch(0U, 0U);
+    EXPECT_EQ(ioopt.ahead, mio->ahead.size());
+    EXPECT_TRUE(mio->ahead.front().d.empty());
+    piol->isErr();
+}
+
+TEST_F(MPIIOTest, ReadAheadIndependent)
+{
+    ioopt.mode = Data::IOMode::Independent;
+    ioopt.ahead = 1U;
+    makeMPIIO(smallSEGYFile);
+    auto mio = std::dynamic_pointer_cast<Data::MPIIO>(data);
+
+    //Only one process reads ahead and it does not need to read all of the range
+    if (!piol->comm->getRank())
+    {
+        csize_t dosz = SEGSz::getDOSz(smallns);
+        data->prefetch(SEGSz::getDOLoc<float>(100U, smallns), 100U * dosz);
+        std::vector<uchar> md(SEGSz::getMDSz() * 50U);
+        data->read(SEGSz::getDOLoc<float>(120U, smallns), SEGSz::getMDSz(), dosz, 50U, md.data());
+        EXPECT_TRUE(mio->ahead.empty());
+        for (size_t i = 0; i < 50U; i++)
+            ASSERT_EQ(ilNum(120U + i), getHost<int32_t>(&md[i * SEGSz::getMDSz() + 188U])) << i;
+    }
+    piol->isErr();
+}
+
 TEST_F(MPIIOTest, ReadListZero)
 {
     makeMPIIO(smallSEGYFile);
@@ -309,6 +484,58 @@ TEST_F(MPIIOTest, ReadListSmall)
 }
 
 
+TEST_F(MPIIOTest, ReadListSieve)
+{
+    ioopt.sieveGap = 2U*SEGSz::getDOSz(smallns);
+    makeMPIIO(smallSEGYFile);
+
+    //Every second trace is read as one extent, then a mix of merged and separate blocks
+    std::vector<size_t> vec(smallnt/2);
+    for (size_t i = 0; i < vec.size(); i++)
+        vec[i] = 2U*i;
+    readList(vec.size(), smallns, vec.data());
+    for (size_t i = 0; i < vec.size(); i++)
+        vec[i] = i + i / 4U * 8U;
+    readList(vec.size()/8U, smallns, vec.data());
+}
+
+TEST_F(MPIIOTest, ReadExtents)
+{
+    size_t bsz = SEGSz::getDFSz(smallns);
+    csize_t step = SEGSz::getDOSz(smallns);
+
+    //A run split over several calls, a strided run and a single block
+    ioopt.maxSize = 20U * (bsz + ioopt.sieveGap) * 2U;
+    makeMPIIO(smallSEGYFile);
+    std::vector<Data::Extent> ext = {{SEGSz::getDODFLoc<float>(0U, smallns), 50U, step},
+                                     {SEGSz::getDODFLoc<float>(60U, smallns), 20U, 3U*step},
+                                     {SEGSz::getDODFLoc<float>(200U, smallns), 1U, step},
+                                     {SEGSz::getDODFLoc<float>(201U, smallns), 0U, step}};
+    std::vector<size_t> vec;
+    for (size_t i = 0; i < 50U; i++)
+        vec.push_back(i);
+    for (size_t i = 0; i < 20U; i++)
+        vec.push_back(60U + 3U*i);
+    vec.push_back(200U);
+
+    std::vector<uchar> d(bsz * vec.size());
+    data->read(bsz, ext, d.data());
+    piol->isErr();
+    for (size_t i = 0; i < vec.size(); i++)
+        for (size_t k = 0; k < smallns; k++)
+        {
+            union { float f; uint32_t i; } n;
+            n.f = vec[i] + k;
+            ASSERT_EQ(d[i*bsz + 4*k], n.i >> 24 & 0xFF) << i << " " << k;
+            ASSERT_EQ(d[i*bsz + 4*k + 3], n.i & 0xFF) << i << " " << k;
+        }
+
+    //No runs only makes the matching calls
+    std::vector<Data::Extent> none;
+    data->read(bsz, none, nullptr);
+    piol->isErr();
+}
+
 TEST_F(MPIIOTest, FarmReadListLarge)
 {
     makeMPIIO(largeSEGYFile);
@@ -12,6 +12,13 @@
 #include "share/segy.hh"
 #include "share/datatype.hh"
 #include "data/datampiio.hh"
+#include "data/datauring.hh"
+#include "data/datammap.hh"
+#include "data/datamemory.hh"
+#include "data/datastripe.hh"
+#include "data/datatwophase.hh"
+#include "data/datacache.hh"
+#include "data/datacompress.hh"
 #undef private
 #undef protected
 
@@ -44,7 +51,7 @@ class MPIIOTest : public Test
         if (data != nullptr)
             data.reset();
         FileMode mode = (WRITE ? FileMode::Test : FileMode::Read);
-        data = std::make_shared<Data::MPIIO>(piol, name, mode);
+        data = std::make_shared<Data::MPIIO>(piol, name, ioopt, mode);
     }
 
     void makeTestSz(csize_t sz)
@@ -206,3 +213,72 @@ class MPIIOTest : public Test
         }
     }
 };
+
+/*! Set the options of a backend so the small test files exercise it. By default the options
+ *  are left as they are.
+ *  \param[in, out] opt The options
+ */
+template <class O>
+void smallOpt(O & opt)
+{
+    (void)opt;
+}
+
+//! \copydoc smallOpt
+inline void smallOpt(Data::Memory::Opt & opt)
+{
+    //Small chunks so every process owns part of a small file
+    opt.chunk = 1000U;
+}
+
+//! \copydoc smallOpt
+inline void smallOpt(Data::Stripe::Opt & opt)
+{
+    //A small unit so small files touch every part
+    opt.nparts = 3U;
+    opt.unit = 1000U;
+}
+
+//! \copydoc smallOpt
+inline void smallOpt(Data::TwoPhase::Opt & opt)
+{
+    //Small domains so small files are spread over every aggregator
+    opt.stripe = 512U;
+}
+
+//! \copydoc smallOpt
+inline void smallOpt(Data::Compress::Opt & opt)
+{
+    //Small chunks so small files have many of them
+    opt.chunk = 4096U;
+}
+
+/*! The test fixture of a Data backend. It is parameterised on the options structure of the
+ *  backend, the backend itself is O::Type.
+ */
+template <class O>
+class BackendTest : public MPIIOTest
+{
+    protected :
+    typedef typename O::Type Backend;   //!< The backend
+    O bopt;                             //!< The options of the backend
+
+    BackendTest()
+    {
+        smallOpt(bopt);
+    }
+
+    template <bool WRITE = false>
+    void makeData(std::string name)
+    {
+        if (data != nullptr)
+            data.reset();
+        FileMode mode = (WRITE ? FileMode::Test : FileMode::Read);
+        data = std::make_shared<Backend>(piol, name, bopt, mode);
+    }
+
+    std::shared_ptr<Backend> bdata(void)
+    {
+        return std::dynamic_pointer_cast<Backend>(data);
+    }
+};
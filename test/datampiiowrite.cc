@@ -97,6 +97,57 @@ TEST_F(MPIIOTest, WriteBlocksSSS)
     piol->isErr();
 }
 
+TEST_F(MPIIOTest, WriteBlocksPersistView)
+{
+    ioopt.mode = Data::IOMode::Collective;
+    ioopt.persistView = true;
+    makeMPIIO<true>(tempFile);
+    csize_t nt = 200;
+    csize_t ns = 261;
+    writeSmallBlocks<true>(nt, ns);
+    writeSmallBlocks<true>(nt, ns, 200);
+    writeBigBlocks<true>(nt, ns);
+    readSmallBlocks<true>(2U*nt, ns);
+    piol->isErr();
+}
+
+TEST_F(MPIIOTest, WriteAuto)
+{
+    //Large writes are collective and small reads independent, so the handles must be synced
+    ioopt.mode = Data::IOMode::Auto;
+    ioopt.autoSz = 1000U;
+    makeMPIIO<true>(tempFile);
+    auto mio = std::dynamic_pointer_cast<Data::MPIIO>(data);
+    csize_t sz = 100000U;
+    std::vector<uchar> d(sz);
+    for (size_t i = 0; i < sz; i++)
+        d[i] = getPattern(i);
+    csize_t rank = piol->comm->getRank();
+    csize_t numRank = piol->comm->getNumRank();
+    csize_t lo = rank * sz / numRank;
+    data->write(lo, (rank + 1U) * sz / numRank - lo, &d[lo]);
+    EXPECT_TRUE(mio->cwrote);
+
+    std::vector<uchar> out(10U);
+    data->read(500U, out.size(), out.data());
+    EXPECT_FALSE(mio->cwrote);
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_EQ(getPattern(500U + i), out[i]) << i;
+
+    //A small write is independent and seen by the next collective read
+    std::vector<uchar> one(1U, uchar(~getPattern(7U)));
+    data->write(7U, (!rank ? one.size() : 0U), one.data());
+    EXPECT_EQ(!rank, mio->iwrote);
+    d[7U] = one[0];
+
+    out.resize(sz);
+    data->read(0U, out.size(), out.data());
+    EXPECT_FALSE(mio->iwrote);
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_EQ(d[i], out[i]) << i;
+    piol->isErr();
+}
+
 TEST_F(MPIIOTest, WriteBlocksSLS)
 {
     makeMPIIO<true>(tempFile);
@@ -162,6 +213,47 @@ TEST_F(MPIIOTest, WriteListSmall)
     piol->isErr();
 }
 
+TEST_F(MPIIOTest, WriteListSieve)
+{
+    ioopt.sieveGap = 2U*SEGSz::getDOSz(261U);
+    ioopt.sieveWrite = true;
+    makeMPIIO<true>(tempFile);
+    csize_t nt = 400;
+    csize_t ns = 261;
+    writeBigBlocks<false>(nt, ns);
+
+    //Each process rewrites every second trace of its own range with the value of the trace after it
+    csize_t numRank = piol->comm->getNumRank();
+    csize_t rank = piol->comm->getRank();
+    csize_t per = nt / 2U / numRank;
+    std::pair<size_t, size_t> dec = {rank * per, (rank == numRank-1U ? nt/2U - rank * per : per)};
+    size_t bsz = SEGSz::getDFSz(ns);
+    std::vector<size_t> boffset(dec.second), roffset(dec.second);
+    std::vector<uchar> d(bsz * dec.second);
+    for (size_t i = 0; i < dec.second; i++)
+    {
+        boffset[i] = SEGSz::getDODFLoc<float>(2U*(dec.first+i), ns);
+        roffset[i] = SEGSz::getDODFLoc<float>(2U*(dec.first+i)+1U, ns);
+    }
+    data->read(bsz, dec.second, roffset.data(), d.data());
+    data->write(bsz, dec.second, boffset.data(), d.data());
+    piol->isErr();
+
+    std::vector<uchar> out(bsz);
+    for (size_t i = 0; i < nt; i++)
+    {
+        data->read(SEGSz::getDODFLoc<float>(i, ns), bsz, out.data());
+        for (size_t k = 0; k < ns; k++)
+        {
+            union { float f; uint32_t i; } n;
+            n.f = (i % 2U ? i : i + 1U) + k;
+            ASSERT_EQ(out[4*k], n.i >> 24 & 0xFF) << i << " " << k;
+            ASSERT_EQ(out[4*k + 3], n.i & 0xFF) << i << " " << k;
+        }
+    }
+    piol->isErr();
+}
+
 TEST_F(MPIIOTest, FarmWriteListLarge)
 {
     makeMPIIO<true>(tempFile);
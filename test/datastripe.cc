@@ -0,0 +1,140 @@
+#include "datampiiotest.hh"
+#include "cppfileapi.hh"
+
+typedef BackendTest<Data::Stripe::Opt> StripeTest;
+
+TEST_F(StripeTest, Manifest)
+{
+    EXPECT_FALSE(Data::Stripe::isStriped(piol, tempFile));
+    makeData<true>(tempFile);
+    piol->isErr();
+    EXPECT_TRUE(Data::Stripe::isStriped(piol, tempFile));
+    EXPECT_EQ(3U, bdata()->parts.size());
+    data.reset();
+    piol->comm->barrier();
+    EXPECT_FALSE(Data::Stripe::isStriped(piol, tempFile));
+
+    makeData(notFile);
+    EXPECT_FALSE(piol->log->loglist.empty());
+    piol->log->loglist.clear();
+}
+
+TEST_F(StripeTest, FileSz)
+{
+    makeData<true>(tempFile);
+    auto & parts = bdata()->parts;
+    for (size_t sz : {0U, 1U, 999U, 1000U, 2500U, 3000U, 3001U, 7777U})
+    {
+        data->setFileSz(sz);
+        EXPECT_EQ(sz, data->getFileSz());
+        size_t total = 0U;
+        for (auto & p : parts)
+            total += p->getFileSz();
+        EXPECT_EQ(sz, total);
+    }
+    data->setFileSz(7777U);
+    EXPECT_EQ(3000U, parts[0]->getFileSz());
+    EXPECT_EQ(2777U, parts[1]->getFileSz());
+    EXPECT_EQ(2000U, parts[2]->getFileSz());
+    piol->isErr();
+}
+
+TEST_F(StripeTest, Layout)
+{
+    makeData<true>(tempFile);
+    auto & parts = bdata()->parts;
+    std::vector<uchar> d(5000U);
+    for (size_t i = 0; i < d.size(); i++)
+        d[i] = getPattern(i);
+    if (!piol->comm->getRank())
+        data->write(0U, d.size(), d.data());
+    piol->comm->barrier();
+
+    //Stripe units are dealt out to the parts in turn
+    std::vector<uchar> pd(1000U);
+    parts[1]->read(1000U, pd.size(), pd.data());
+    EXPECT_TRUE(std::equal(pd.begin(), pd.end(), d.begin() + 4000U));
+
+    std::vector<uchar> out(5000U);
+    data->read(0U, out.size(), out.data());
+    EXPECT_EQ(d, out);
+
+    //Blocks which straddle stripe units
+    std::vector<uchar> blk(600U * 5U);
+    data->read(700U, 600U, 900U, 5U, blk.data());
+    for (size_t i = 0; i < 5U; i++)
+        for (size_t j = 0; j < 600U; j++)
+            ASSERT_EQ(getPattern(700U + i * 900U + j), blk[i*600U + j]) << i << " " << j;
+
+    std::vector<size_t> offset = {4200U, 10U, 2990U, 1500U};
+    data->read(500U, offset.size(), offset.data(), blk.data());
+    for (size_t i = 0; i < offset.size(); i++)
+        for (size_t j = 0; j < 500U; j++)
+            ASSERT_EQ(getPattern(offset[i] + j), blk[i*500U + j]) << i << " " << j;
+    piol->isErr();
+}
+
+TEST_F(StripeTest, LargeUnit)
+{
+    //Units past the MPI-IO packet size are still read straight into the blocks
+    bopt.nparts = 2U;
+    bopt.unit = 5U*1024U*1024U;
+    makeData<true>(tempFile);
+    std::vector<uchar> d(12U*1024U*1024U);
+    for (size_t i = 0; i < d.size(); i++)
+        d[i] = getPattern(i);
+    if (!piol->comm->getRank())
+        data->write(0U, d.size(), d.data());
+    piol->comm->barrier();
+
+    csize_t bsz = 6U*1024U*1024U;
+    std::vector<size_t> offset = {5U*1024U*1024U + 100U, 0U};
+    std::vector<uchar> blk(bsz * offset.size());
+    data->read(bsz, offset.size(), offset.data(), blk.data());
+    for (size_t i = 0; i < offset.size(); i++)
+        for (size_t j = 0; j < bsz; j++)
+            ASSERT_EQ(d[offset[i] + j], blk[i*bsz + j]) << i << " " << j;
+
+    std::vector<uchar> out(d.size());
+    data->read(0U, out.size(), out.data());
+    EXPECT_EQ(d, out);
+    piol->isErr();
+}
+
+TEST_F(StripeTest, FileLayer)
+{
+    csize_t nt = 400U;
+    csize_t ns = 261U;
+    //Copy the small SEG-Y file into a striped set
+    makeMPIIO(smallSEGYFile);
+    csize_t fsz = data->getFileSz();
+    std::vector<uchar> d(!piol->comm->getRank() ? fsz : 0U);
+    data->read(0U, d.size(), d.data());
+
+    bopt.unit = 4096U;
+    makeData<true>(tempFile);
+    data->write(0U, d.size(), d.data());
+    piol->comm->barrier();
+    EXPECT_EQ(fsz, data->getFileSz());
+
+    //Readers find the striped set by its manifest
+    {
+        File::ReadDirect file(piol, tempFile);
+        piol->isErr();
+        EXPECT_EQ(nt, file.readNt());
+        EXPECT_EQ(ns, file.readNs());
+
+        auto vec = getRandomVec(50U, nt, 1337);
+        std::vector<trace_t> trc(ns * vec.size());
+        File::Param prm(vec.size());
+        file.readTrace(vec.size(), vec.data(), trc.data(), &prm);
+        piol->isErr();
+        for (size_t i = 0; i < vec.size(); i++)
+        {
+            ASSERT_EQ(ilNum(vec[i]), File::getPrm<llint>(i, Meta::il, &prm));
+            ASSERT_EQ(xlNum(vec[i]), File::getPrm<llint>(i, Meta::xl, &prm));
+            for (size_t k = 0; k < ns; k++)
+                ASSERT_EQ(trace_t(vec[i] + k), trc[i*ns + k]) << i << " " << k;
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#include "datampiiotest.hh"
+#include "cppfileapi.hh"
+#define private public
+#define protected public
+#include "object/objsegy.hh"
+#include "file/filesegy.hh"
+#undef private
+#undef protected
+
+typedef BackendTest<Data::TwoPhase::Opt> TwoPhaseTest;
+
+TEST_F(TwoPhaseTest, Aggregators)
+{
+    //The first process of each node aggregates
+    makeData(smallFile);
+    piol->isErr();
+    auto tp = bdata();
+    size_t nagg = piol->comm->sum(size_t(tp->isAggregator()));
+    EXPECT_LE(1U, nagg);
+    if (!piol->comm->getRank())
+        EXPECT_TRUE(tp->isAggregator());
+
+    bopt.aggPerNode = 2U;
+    makeData(smallFile);
+    tp = bdata();
+    EXPECT_EQ(std::min(size_t(2U), piol->comm->getNumRank()), piol->comm->sum(size_t(tp->isAggregator())));
+}
+
+TEST_F(TwoPhaseTest, ReadRounds)
+{
+    //Many unequal rounds and two aggregators per node
+    bopt.aggPerNode = 2U;
+    bopt.round = 1000U;
+    bopt.gap = 0U;
+    makeData(smallSEGYFile);
+    readSmallBlocks<true>(400U, 261U);
+    readBigBlocks<false>(100U, 261U);
+    auto vec = getRandomVec(200U, 400U, 1337);
+    readList(vec.size(), 261U, vec.data());
+    piol->isErr();
+}
+
+TEST_F(TwoPhaseTest, WriteRounds)
+{
+    bopt.aggPerNode = 2U;
+    bopt.round = 1000U;
+    makeData<true>(tempFile);
+    writeSmallBlocks<true>(100U, 261U);
+    writeBigBlocks<false>(100U, 261U, 20U);
+    writeList(200U, 261U);
+    piol->isErr();
+}
+
+TEST_F(TwoPhaseTest, Uneven)
+{
+    //Only the first process has data but every process takes part
+    makeData<true>(tempFile);
+    std::vector<uchar> d(!piol->comm->getRank() ? 5000U : 0U);
+    for (size_t i = 0; i < d.size(); i++)
+        d[i] = getPattern(i);
+    data->write(0U, d.size(), d.data());
+    //Aggregators may still be writing when the other processes return
+    piol->comm->barrier();
+    EXPECT_EQ(5000U, data->getFileSz());
+
+    std::vector<uchar> out(d.size());
+    data->read(0U, out.size(), out.data());
+    EXPECT_EQ(d, out);
+
+    std::vector<size_t> offset = {4200U, 10U, 2990U, 1500U};
+    std::vector<uchar> blk(500U * offset.size());
+    data->read(500U, (!piol->comm->getRank() ? offset.size() : 0U), offset.data(), blk.data());
+    if (!piol->comm->getRank())
+        for (size_t i = 0; i < offset.size(); i++)
+            for (size_t j = 0; j < 500U; j++)
+                ASSERT_EQ(getPattern(offset[i] + j), blk[i*500U + j]) << i << " " << j;
+    piol->isErr();
+}
+
+TEST_F(TwoPhaseTest, FileLayer)
+{
+    csize_t nt = 400U;
+    csize_t ns = 261U;
+    File::ReadDirect file(piol, smallSEGYFile, File::ReadSEGY::Opt(), Obj::SEGY::Opt(), bopt);
+    piol->isErr();
+    EXPECT_EQ(nt, file.readNt());
+    EXPECT_EQ(ns, file.readNs());
+
+    auto vec = getRandomVec(50U, nt, 1337);
+    std::vector<trace_t> trc(ns * vec.size());
+    File::Param prm(vec.size());
+    file.readTrace(vec.size(), vec.data(), trc.data(), &prm);
+    piol->isErr();
+    for (size_t i = 0; i < vec.size(); i++)
+    {
+        ASSERT_EQ(ilNum(vec[i]), File::getPrm<llint>(i, Meta::il, &prm));
+        ASSERT_EQ(xlNum(vec[i]), File::getPrm<llint>(i, Meta::xl, &prm));
+        for (size_t k = 0; k < ns; k++)
+            ASSERT_EQ(trace_t(vec[i] + k), trc[i*ns + k]) << i << " " << k;
+    }
+}
@@ -57,3 +57,93 @@ TEST(Datatype, IBMToIEEE)
             << "them " << printBinary(*reinterpret_cast<uint32_t *>(&tktraces[i]));
     }
 }
+
+/*! Convert the reference data with the batch kernel of the given instruction set and
+ *  compare against the reference and the single float conversion.
+ *  \param[in] isa The instruction set
+ */
+void testBatchIBMToIEEE(Isa isa)
+{
+    if (isa > getIsa())
+        return;
+
+    ASSERT_EQ(rawTraces.size(), tktraces.size());
+    //Also convert the data unaligned with an odd length to exercise the remainder loop
+    for (size_t off : {0U, 1U})
+    {
+        size_t sz = rawTraces.size() - off;
+        std::vector<float> trc(sz);
+        for (size_t i = 0; i < sz; i++)
+            trc[i] = tofloat(rawTraces[off + i]);
+        convertIBMtoIEEE(isa, sz, trc.data(), true);
+        for (size_t i = 0; i < sz; i++)
+            ASSERT_EQ(toint(tktraces[off + i]), toint(trc[i])) << "float number " << off + i;
+    }
+
+    //Bit patterns outside the reference data (zeros with a sign, unnormalised fractions,
+    //extreme exponents) must still match the single float conversion exactly
+    std::vector<uint32_t> raw;
+    uint32_t x = 0x12345678U;
+    for (size_t i = 0; i < 4099U; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        raw.push_back(i % 7U ? x >> (i % 5U) * 2U : x & 0xFF000000U);
+    }
+    for (bool bigEndian : {true, false})
+    {
+        std::vector<float> trc(raw.size());
+        for (size_t i = 0; i < raw.size(); i++)
+            trc[i] = tofloat(raw[i]);
+        convertIBMtoIEEE(isa, trc.size(), trc.data(), bigEndian);
+        for (size_t i = 0; i < raw.size(); i++)
+            ASSERT_EQ(toint(convertIBMtoIEEE(tofloat(raw[i]), bigEndian)), toint(trc[i]))
+                << "float number " << i << "\n raw " << printBinary(raw[i]);
+    }
+}
+
+TEST(Datatype, IBMToIEEEBatchScalar)
+{
+    testBatchIBMToIEEE(Isa::Scalar);
+}
+
+TEST(Datatype, IBMToIEEEBatchSSE4)
+{
+    testBatchIBMToIEEE(Isa::SSE4);
+}
+
+TEST(Datatype, IBMToIEEEBatchAVX2)
+{
+    testBatchIBMToIEEE(Isa::AVX2);
+}
+
+TEST(Datatype, IBMToIEEEBatchAVX512)
+{
+    testBatchIBMToIEEE(Isa::AVX512);
+}
+
+TEST(Datatype, swap4Bytes)
+{
+    std::vector<uchar> src(4U * 1027U);
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = uchar(i * 7U + 3U);
+    std::vector<uchar> ref = src;
+    for (size_t i = 0; i < ref.size(); i += 4U)
+        reverse4Bytes(&ref[i]);
+
+    for (Isa isa : {Isa::Scalar, Isa::SSE4, Isa::AVX2, Isa::AVX512})
+        if (isa <= getIsa())
+        {
+            //Out of place, including an unaligned source
+            std::vector<uchar> dst(src.size() - 4U);
+            swap4Bytes(isa, dst.size() / 4U, src.data() + 4U, dst.data());
+            for (size_t i = 0; i < dst.size(); i++)
+                ASSERT_EQ(ref[i + 4U], dst[i]) << "byte " << i << " isa " << size_t(isa);
+
+            //In place
+            dst = src;
+            swap4Bytes(isa, dst.size() / 4U, dst.data(), dst.data());
+            ASSERT_EQ(ref, dst) << "isa " << size_t(isa);
+        }
+}
@@ -0,0 +1,140 @@
+#include "datampiiotest.hh"
+#include "cppfileapi.hh"
+#define private public
+#define protected public
+#include "object/objsegy.hh"
+#include "file/filesegy.hh"
+#undef private
+#undef protected
+
+typedef BackendTest<Data::URing::Opt> URingTest;
+
+TEST_F(URingTest, ReadSplit)
+{
+    //Requests are split over small buffers and a shallow queue
+    bopt.depth = 3U;
+    bopt.bufSz = 100U;
+    makeData(smallSEGYFile);
+    readSmallBlocks<false>(400U, 261U);
+    readBigBlocks<true>(100U, 261U);
+    auto vec = getRandomVec(200U, 400U, 1337);
+    readList(vec.size(), 261U, vec.data());
+    piol->isErr();
+}
+
+TEST_F(URingTest, ReadDirect)
+{
+    bopt.direct = true;
+    bopt.align = 512U;
+    makeData(smallSEGYFile);
+    readSmallBlocks<true>(400U, 261U);
+    readBigBlocks<false>(100U, 261U);
+    auto vec = getRandomVec(200U, 400U, 1337);
+    readList(vec.size(), 261U, vec.data());
+    piol->isErr();
+}
+
+TEST_F(URingTest, ReadSync)
+{
+    bopt.depth = 0U;
+    makeData(smallSEGYFile);
+    EXPECT_FALSE(bdata()->isRing());
+    readSmallBlocks<true>(400U, 261U);
+    auto vec = getRandomVec(200U, 400U, 1337);
+    readList(vec.size(), 261U, vec.data());
+    piol->isErr();
+}
+
+TEST_F(URingTest, WriteDirect)
+{
+    bopt.direct = true;
+    bopt.align = 512U;
+    bopt.bufSz = 2048U;
+    makeData<true>(tempFile);
+    data->setFileSz(SEGSz::getDOLoc<float>(400U, 261U));
+    piol->comm->barrier();
+    writeSmallBlocks<true>(100U, 261U);
+    piol->comm->barrier();
+    writeBigBlocks<false>(100U, 261U, 20U);
+
+    //Aligned requests go through O_DIRECT
+    piol->comm->barrier();
+    std::vector<uchar> d(4096U), out(4096U);
+    for (size_t i = 0; i < d.size(); i++)
+        d[i] = uchar(i * 7U);
+    data->write(8192U, d.size(), d.data());
+    data->read(8192U, out.size(), out.data());
+    EXPECT_EQ(d, out);
+    piol->isErr();
+}
+
+TEST_F(URingTest, Placed)
+{
+    bopt.direct = true;
+    bopt.align = 512U;
+    bopt.bufSz = 2048U;
+    makeData<true>(tempFile);
+    auto udata = bdata();
+
+    //Placed memory has the alignment of the file offset
+    std::vector<uchar> buf;
+    csize_t offset = 3600U + piol->comm->getRank() * 20000U;
+    uchar * d = data->place(offset, 10000U, buf);
+    if (udata->dfd >= 0)
+        EXPECT_EQ(offset % bopt.align, uintptr_t(d) % bopt.align);
+    ASSERT_LE(d + 10000U, buf.data() + buf.size());
+
+    //The head and tail are not aligned, the middle is moved without a copy
+    for (size_t i = 0; i < 10000U; i++)
+        d[i] = getPattern(offset + i);
+    data->write(offset, 10000U, d);
+    std::vector<uchar> out(10000U);
+    data->read(offset, out.size(), out.data());
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_EQ(getPattern(offset + i), out[i]) << i;
+
+    std::vector<uchar> buf2;
+    uchar * d2 = data->place(offset + 1U, 9000U, buf2);
+    data->read(offset + 1U, 9000U, d2);
+    for (size_t i = 0; i < 9000U; i++)
+        ASSERT_EQ(getPattern(offset + 1U + i), d2[i]) << i;
+    piol->isErr();
+}
+
+TEST_F(URingTest, FileLayerDirect)
+{
+    bopt.direct = true;
+    bopt.align = 512U;
+    File::ReadDirect file(piol, smallSEGYFile, File::ReadSEGY::Opt(), Obj::SEGY::Opt(), bopt);
+    piol->isErr();
+    ASSERT_EQ(400U, file.readNt());
+
+    std::vector<trace_t> trc(261U * 50U);
+    File::Param prm(50U);
+    file.readTrace(30U, 50U, trc.data(), &prm);
+    piol->isErr();
+    for (size_t i = 0; i < 50U; i++)
+    {
+        ASSERT_EQ(ilNum(30U + i), File::getPrm<llint>(i, Meta::il, &prm));
+        for (size_t k = 0; k < 261U; k++)
+            ASSERT_EQ(trace_t(30U + i + k), trc[i*261U + k]) << i << " " << k;
+    }
+}
+
+TEST_F(URingTest, FileLayer)
+{
+    //The Object and File layers work unchanged on top
+    auto udata = std::make_shared<Data::URing>(piol, smallSEGYFile, bopt, FileMode::Read);
+    auto obj = std::make_shared<Obj::SEGY>(piol, smallSEGYFile, udata, FileMode::Read);
+    File::ReadSEGY file(piol, smallSEGYFile, obj);
+    piol->isErr();
+    EXPECT_EQ(400U, file.readNt());
+    EXPECT_EQ(261U, file.readNs());
+
+    std::vector<trace_t> trc(261U * 10U);
+    file.readTrace(20U, 10U, trc.data(), const_cast<File::Param *>(File::PARAM_NULL), 0U);
+    piol->isErr();
+    for (size_t i = 0; i < 10U; i++)
+        for (size_t k = 0; k < 261U; k++)
+            ASSERT_EQ(trace_t(20U + i + k), trc[i*261U + k]) << i << " " << k;
+}
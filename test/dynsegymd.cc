@@ -71,6 +71,91 @@ TEST_F(RuleFixEmpty, Extent)
     ASSERT_EQ(rule->extent(), size_t(Tr::SrcMeas) + 4U - size_t(Tr::ScaleCoord));
 }
 
+TEST(Rule, Program)
+{
+    auto rule = std::make_shared<Rule>(true, false);
+    rule->addLong(Meta::xl, Tr::xl);
+    rule->addLong(Meta::il, Tr::il);
+    rule->addShort(Meta::Tic, Tr::TIC);
+    rule->addSEGYFloat(Meta::yRcv, Tr::yRcv, Tr::ScaleCoord);
+    rule->addSEGYFloat(Meta::xSrc, Tr::xSrc, Tr::ScaleCoord);
+
+    //Locations are byte offsets into the header
+    auto & prog = rule->program();
+    ASSERT_EQ(2U, prog.lng.size());
+    EXPECT_EQ(size_t(Tr::il) - 1U, prog.lng[0].loc);
+    EXPECT_EQ(size_t(Tr::xl) - 1U, prog.lng[1].loc);
+    EXPECT_EQ(rule->getEntry(Meta::il)->num, prog.lng[0].num);
+    ASSERT_EQ(1U, prog.shrt.size());
+    EXPECT_EQ(size_t(Tr::TIC) - 1U, prog.shrt[0].loc);
+    ASSERT_EQ(2U, prog.flt.size());
+    EXPECT_EQ(size_t(Tr::xSrc) - 1U, prog.flt[0].loc);
+    EXPECT_EQ(size_t(Tr::yRcv) - 1U, prog.flt[1].loc);
+
+    //Both floats share the one scaler
+    ASSERT_EQ(1U, prog.scal.size());
+    EXPECT_EQ(size_t(Tr::ScaleCoord) - 1U, prog.scal[0]);
+    EXPECT_EQ(0U, prog.flt[0].scal);
+    EXPECT_EQ(0U, prog.flt[1].scal);
+
+    //Changing the rules recompiles the program
+    rule->addLong(Meta::Offset, Tr::CDist);
+    auto & prog2 = rule->program();
+    ASSERT_EQ(3U, prog2.lng.size());
+    EXPECT_EQ(size_t(Tr::CDist) - 1U, prog2.lng[0].loc);
+}
+
+TEST(StaticRule, Layout)
+{
+    typedef StaticRule<Meta::xSrc, Meta::il, Meta::yRcv, Meta::xl> R;
+    static_assert(R::numFloat == 2U && R::numLong == 2U && R::numShort == 0U, "Unexpected StaticRule counts");
+    static_assert(R::index<Meta::xSrc>() == 0U && R::index<Meta::yRcv>() == 1U, "Unexpected float index");
+    static_assert(R::index<Meta::il>() == 0U && R::index<Meta::xl>() == 1U, "Unexpected long index");
+    static_assert(R::contains<Meta::il>() && !R::contains<Meta::Offset>(), "Unexpected contains");
+    EXPECT_EQ(2U*sizeof(geom_t) + 2U*sizeof(llint), R::paramMem());
+}
+
+TEST(StaticRule, Extract)
+{
+    typedef StaticRule<Meta::xSrc, Meta::ySrc, Meta::xRcv, Meta::yRcv, Meta::il, Meta::xl, Meta::tn> R;
+    csize_t sz = 100U;
+    csize_t skip = 3U;
+    std::vector<uchar> buf(sz * SEGSz::getMDSz());
+    for (size_t i = 0; i < sz; i++)
+    {
+        uchar * md = &buf[i * SEGSz::getMDSz()];
+        int16_t scal = (i % 3 == 0 ? 0 : (i % 3 == 1 ? 10 : -100));
+        getBigEndian(scal, &md[size_t(Tr::ScaleCoord)-1U]);
+        getBigEndian(int32_t(i + 1), &md[size_t(Tr::xSrc)-1U]);
+        getBigEndian(int32_t(i + 2), &md[size_t(Tr::ySrc)-1U]);
+        getBigEndian(int32_t(i + 3), &md[size_t(Tr::xRcv)-1U]);
+        getBigEndian(int32_t(i + 4), &md[size_t(Tr::yRcv)-1U]);
+        getBigEndian(int32_t(2*i), &md[size_t(Tr::il)-1U]);
+        getBigEndian(int32_t(3*i), &md[size_t(Tr::xl)-1U]);
+        getBigEndian(int32_t(5*i), &md[size_t(Tr::SeqFNum)-1U]);
+    }
+
+    auto rule = std::make_shared<Rule>(std::initializer_list<Meta>{Meta::xSrc, Meta::ySrc, Meta::xRcv, Meta::yRcv,
+                                                                    Meta::il, Meta::xl, Meta::tn}, true);
+    Param prm(rule, sz);
+    File::extractParam(sz, buf.data(), &prm, 0U, 0U);
+
+    StaticParam<R> sprm(sz + skip);
+    ASSERT_EQ(sz + skip, sprm.size());
+    File::extractParam(sz, buf.data(), &sprm, 0U, skip);
+
+    for (size_t i = 0; i < sz; i++)
+    {
+        ASSERT_EQ(getPrm<geom_t>(i, Meta::xSrc, &prm), sprm.get<Meta::xSrc>(i + skip)) << i;
+        ASSERT_EQ(getPrm<geom_t>(i, Meta::ySrc, &prm), sprm.get<Meta::ySrc>(i + skip)) << i;
+        ASSERT_EQ(getPrm<geom_t>(i, Meta::xRcv, &prm), sprm.get<Meta::xRcv>(i + skip)) << i;
+        ASSERT_EQ(getPrm<geom_t>(i, Meta::yRcv, &prm), sprm.get<Meta::yRcv>(i + skip)) << i;
+        ASSERT_EQ(getPrm<llint>(i, Meta::il, &prm), sprm.get<Meta::il>(i + skip)) << i;
+        ASSERT_EQ(getPrm<llint>(i, Meta::xl, &prm), sprm.get<Meta::xl>(i + skip)) << i;
+        ASSERT_EQ(getPrm<llint>(i, Meta::tn, &prm), sprm.get<Meta::tn>(i + skip)) << i;
+    }
+}
+
 TEST_F(RuleFixList, setPrm)
 {
     rule->addLong(Meta::dsdr, Tr::SrcMeas);
@@ -106,6 +191,35 @@ TEST_F(RuleFixList, setPrm)
     }
 }
 
+TEST_F(RuleFixList, ParamCol)
+{
+    rule->addLong(Meta::dsdr, Tr::SrcMeas);
+    rule->addShort(Meta::il, Tr::ScaleElev);
+    Param prm(rule, 100);
+    for (size_t i = 0; i < 100; i++)
+    {
+        setPrm(i, Meta::xSrc, geom_t(i) + 1., &prm);
+        setPrm(i, Meta::yRcv, geom_t(i) + 4., &prm);
+        setPrm(i, Meta::dsdr, llint(i + 1), &prm);
+        setPrm(i, Meta::il, short(i + 2), &prm);
+    }
+    ParamCol<geom_t> xSrc(Meta::xSrc, &prm);
+    ParamCol<geom_t> yRcv(Meta::yRcv, &prm);
+    ParamCol<llint> dsdr(Meta::dsdr, &prm);
+    ParamCol<llint> il(Meta::il, &prm);
+    ParamCol<llint> xl(Meta::xl, &prm);
+    ASSERT_EQ(prm.size(), xSrc.size());
+    for (size_t i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(getPrm<geom_t>(i, Meta::xSrc, &prm), xSrc[i]);
+        ASSERT_EQ(getPrm<geom_t>(i, Meta::yRcv, &prm), yRcv[i]);
+        ASSERT_EQ(llint(i + 1), dsdr[i]);
+        ASSERT_EQ(llint(i + 2), il[i]);
+        ASSERT_EQ(0, xl[i]);
+    }
+    ASSERT_EQ(rule->translate.end(), rule->translate.find(Meta::xl));
+}
+
 TEST_F(RuleFixDefault, Constructor)
 {
         ASSERT_EQ(rule->translate.size(), 12);
@@ -1,5 +1,8 @@
 #include <memory>
 #include "file/dynsegymd.hh"
+#include "file/segymd.hh"
+#include "file/staticrule.hh"
+#include "share/datatype.hh"
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 using namespace testing;
@@ -2,17 +2,21 @@
 #include "gmock/gmock.h"
 #include "tglobal.hh"
 #include "anc/mpi.hh"
-#include "data/datampiio.hh"
-#include "object/objsegy.hh"
 #define private public
 #define protected public
+#include "data/datampiio.hh"
+#include "object/objsegy.hh"
 #include "cppfileapi.hh"
 #include "file/file.hh"
+#include "file/ioplan.hh"
 #undef private
 #undef protected
 
 using namespace testing;
 using namespace PIOL;
+namespace PIOL {
+extern std::pair<size_t, size_t> decompose(size_t sz, size_t numRank, size_t rank);
+}
 
 class FileTest : public Test
 {
@@ -71,10 +75,10 @@ struct FakeWriteFile : public File::WriteInterface
     void writeNs(csize_t ns_) {}
     void writeNt(csize_t nt_) {}
     void writeInc(const geom_t inc_) {}
-    void writeTrace(csize_t offset, csize_t sz, trace_t * trace, const File::Param * prm, size_t skip) {}
+    void writeTrace(csize_t offset, csize_t sz, const trace_t * trace, const File::Param * prm, size_t skip) {}
     void writeParam(csize_t offset, csize_t sz, const File::Param * prm, size_t skip) {}
 
-    void writeTrace(csize_t sz, csize_t * offset, trace_t * trace, const File::Param * prm, size_t skip) {}
+    void writeTrace(csize_t sz, csize_t * offset, const trace_t * trace, const File::Param * prm, size_t skip) {}
     void writeParam(csize_t sz, csize_t * offset, const File::Param * prm, size_t skip) {}
 };
 
@@ -107,3 +111,57 @@ TEST_F(FileDeathTest, BadNameConstructor)
     EXPECT_EQ(notFile, file->name);
     EXPECT_EXIT(piol->isErr(), ExitedWithCode(EXIT_FAILURE), ".*8 3 Fatal Error in PIOL. . Dumping Log 0");
 }
+
+TEST_F(FileTest, IOPlan)
+{
+    csize_t lnt = 10U + piol->comm->getRank();
+    File::IOPlan plan(piol.get(), lnt, 3U);
+    auto fake = std::make_unique<FakeReadFile>(piol, notFile, nullptr);
+    plan.add(fake.get(), 240U);
+
+    csize_t biggest = 10U + piol->comm->getNumRank() - 1U;
+    EXPECT_EQ(biggest / 3U + (biggest % 3U > 0), plan.rounds());
+
+    size_t n = 0U, total = 0U;
+    plan.run([&] (size_t i, size_t sz)
+        {
+            EXPECT_EQ(std::min(3U*n, lnt), i);
+            EXPECT_LE(sz, 3U);
+            total += sz;
+            n++;
+        });
+    EXPECT_EQ(plan.rounds(), n);
+    EXPECT_EQ(lnt, total);
+}
+
+TEST_F(FileTest, IOPlanReadAhead)
+{
+    File::ReadDirect direct(piol, smallSEGYFile);
+    piol->isErr();
+    File::ReadInterface & file = *direct.operator->();
+    csize_t ns = file.readNs();
+    auto dec = decompose(file.readNt(), piol->comm->getNumRank(), piol->comm->getRank());
+
+    //Each round is read ahead while the round before it is processed
+    File::IOPlan plan(piol.get(), dec.second, 30U);
+    plan.add(&file, SEGSz::getDOSz(ns));
+    plan.readAhead(&file, dec.first);
+    std::vector<trace_t> trc(30U * ns);
+    File::Param prm(30U);
+    plan.run([&] (size_t i, size_t sz)
+        {
+            file.readTrace(dec.first + i, sz, trc.data(), &prm);
+            for (size_t j = 0; j < sz; j++)
+            {
+                ASSERT_EQ(ilNum(dec.first + i + j), File::getPrm<llint>(j, Meta::il, &prm));
+                for (size_t k = 0; k < ns; k++)
+                    ASSERT_EQ(trace_t(dec.first + i + j + k), trc[j*ns + k]);
+            }
+        });
+
+    //Nothing read ahead is held once the plan has run
+    auto mio = std::dynamic_pointer_cast<Data::MPIIO>(file.obj->data);
+    ASSERT_NE(nullptr, mio);
+    EXPECT_TRUE(mio->ahead.empty());
+    piol->isErr();
+}
@@ -122,6 +122,47 @@ TEST_F(FileSEGYIntegWrite, FileWriteRandomTraceWPrmNormalOpt)
     writeRandomTraceTest<true, false>(size, offsets);
 }
 
+TEST_F(FileSEGYIntegWrite, FileWriteTraceWPrmBehind)
+{
+    nt = 100;
+    ns = 300;
+    wopt.behindMax = nt * SEGSz::getDOSz(ns);
+    wopt.behindCalls = 3U;
+    makeSEGY(tempFile);
+    writeTraceTest<true, false>(0, nt, 7U);
+}
+
+TEST_F(FileSEGYIntegWrite, FileWriteTraceBehindOneCall)
+{
+    nt = 100;
+    ns = 300;
+    //Each call is held until the next one
+    wopt.behindMax = nt * SEGSz::getDFSz(ns);
+    wopt.behindCalls = 1U;
+    makeSEGY(tempFile);
+    writeTraceTest<false, false>(0, nt, 30U);
+}
+
+TEST_F(FileSEGYIntegWrite, FileWriteTraceBehindCap)
+{
+    nt = 100;
+    ns = 300;
+    //Two calls of seven traces fit under the cap
+    wopt.behindMax = 20U * SEGSz::getDFSz(ns);
+    makeSEGY(tempFile);
+    writeTraceTest<false, false>(0, nt, 7U);
+}
+
+TEST_F(FileSEGYIntegWrite, FileWriteTraceBehindOverCap)
+{
+    nt = 100;
+    ns = 300;
+    //A call larger than the cap is written directly
+    wopt.behindMax = 5U * SEGSz::getDOSz(ns);
+    makeSEGY(tempFile);
+    writeTraceTest<true, false>(0, nt, 7U);
+}
+
 TEST_F(FileSEGYIntegWrite, FileWriteTraceBigNs)
 {
     nt = 100;
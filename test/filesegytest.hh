@@ -16,6 +16,7 @@
 #define protected public
 #include "cppfileapi.hh"
 #include "file/filesegy.hh"
+#include "file/rawparam.hh"
 #include "segymdextra.hh"
 #undef private
 #undef protected
@@ -264,6 +265,42 @@ struct FileReadSEGYTest : public Test
         ASSERT_THAT(prm.c, ContainerEq(tr));
     }
 
+    void initReadRawHdrsMock(size_t ns, size_t tn)
+    {
+        EXPECT_CALL(*mock.get(), readDOMD(0, ns, tn, _))
+                    .Times(Exactly(1))
+                    .WillRepeatedly(SetArrayArgument<3>(tr.begin(), tr.end()));
+
+        auto rule = std::make_shared<File::Rule>(std::initializer_list<Meta>{Meta::il, Meta::xl, Meta::xSrc, Meta::ySrc});
+        File::RawParamView prm(rule, tn);
+        file->file->readParam(0, tn, &prm);
+
+        //The headers are stored untouched
+        ASSERT_TRUE(tr.size());
+        ASSERT_THAT(prm.md, ContainerEq(tr));
+
+        File::RawParamCol<llint> il(Meta::il, &prm);
+        File::RawParamCol<geom_t> x(Meta::xSrc, &prm);
+        std::vector<geom_t> y(tn);
+        File::RawParamCol<geom_t>(Meta::ySrc, &prm).decode(0U, tn, y.data());
+        for (size_t i = 0; i < tn; i++)
+        {
+            ASSERT_EQ(ilNum(i), il[i]);
+            ASSERT_EQ(xlNum(i), File::getPrm<llint>(i, Meta::xl, &prm));
+
+            if (sizeof(geom_t) == sizeof(double))
+            {
+                ASSERT_DOUBLE_EQ(xNum(i), x[i]);
+                ASSERT_DOUBLE_EQ(yNum(i), y[i]);
+            }
+            else
+            {
+                ASSERT_FLOAT_EQ(xNum(i), x[i]);
+                ASSERT_FLOAT_EQ(yNum(i), y[i]);
+            }
+        }
+    }
+
     template <bool readPrm = false, bool MOCK = true>
     void readTraceTest(csize_t offset, size_t tn)
     {
@@ -398,6 +435,7 @@ struct FileWriteSEGYTest : public Test
     std::string testString = {"This is a string for testing EBCDIC conversion etc."};
     std::unique_ptr<File::WriteDirect> file;
     std::unique_ptr<File::ReadDirect> readfile;
+    File::WriteSEGY::Opt wopt;
     std::vector<uchar> tr;
     size_t nt = 40U;
     size_t ns = 200U;
@@ -434,14 +472,13 @@ struct FileWriteSEGYTest : public Test
 
         delete file.release();*/
 
-        File::WriteSEGY::Opt f;
         File::ReadSEGY::Opt rf;
         Obj::SEGY::Opt o;
         Data::MPIIO::Opt d;
         auto data = std::make_shared<Data::MPIIO>(piol, name, d, FileMode::Test);
         auto obj = std::make_shared<Obj::SEGY>(piol, name, o, data, FileMode::Test);
 
-        auto fi = std::make_shared<File::WriteSEGY>(piol, name, f, obj);
+        auto fi = std::make_shared<File::WriteSEGY>(piol, name, wopt, obj);
         file = std::make_unique<File::WriteDirect>();
         file->file = std::move(fi);
 
@@ -468,7 +505,7 @@ struct FileWriteSEGYTest : public Test
         piol->isErr();
         Mock::AllowLeak(mock.get());
 
-        auto sfile = std::make_shared<File::WriteSEGY>(piol, notFile, mock);
+        auto sfile = std::make_shared<File::WriteSEGY>(piol, notFile, wopt, mock);
         file = std::make_unique<File::WriteDirect>();
         file->file = std::move(sfile);
 
@@ -593,7 +630,7 @@ struct FileWriteSEGYTest : public Test
     }
 
     template <bool writePrm = false, bool MOCK = true>
-    void writeTraceTest(csize_t offset, csize_t tn)
+    void writeTraceTest(csize_t offset, csize_t tn, csize_t step = 0U)
     {
         std::vector<uchar> buf;
         if (MOCK)
@@ -626,6 +663,8 @@ struct FileWriteSEGYTest : public Test
                                 .Times(Exactly(1)).WillOnce(check3(buf.data(), buf.size()));
         }
         std::vector<float> bufnew(tn * ns);
+        //Write the traces step at a time if asked to, otherwise in one call
+        csize_t inc = (step ? step : std::max(tn, size_t(1U)));
         if (writePrm)
         {
             File::Param prm(tn);
@@ -644,15 +683,23 @@ struct FileWriteSEGYTest : public Test
                     bufnew[i*ns + j] = float(offset + i + j);
             }
 
-            file->writeTrace(offset, tn, bufnew.data(), &prm);
+            for (size_t i = 0U; i < std::max(tn, size_t(1U)); i += inc)
+                (*file)->writeTrace(offset + i, std::min(inc, tn - i), bufnew.data() + i*ns, &prm, i);
         }
         else
         {
             for (size_t i = 0U; i < tn; i++)
                 for (size_t j = 0U; j < ns; j++)
                     bufnew[i*ns + j] = float(offset + i + j);
-            file->writeTrace(offset, tn, bufnew.data());
+            for (size_t i = 0U; i < std::max(tn, size_t(1U)); i += inc)
+                (*file)->writeTrace(offset + i, std::min(inc, tn - i), bufnew.data() + i*ns);
         }
+        file->flush();
+
+        //The caller's traces must not be modified by the write
+        for (size_t i = 0U; i < tn; i++)
+            for (size_t j = 0U; j < ns; j++)
+                ASSERT_EQ(float(offset + i + j), bufnew[i*ns + j]);
 
         if (MOCK == false)
         {
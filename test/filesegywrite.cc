@@ -90,6 +90,43 @@ TEST_F(FileSEGYWrite, FileWriteTraceWPrmNormal)
     writeTraceTest<true>(0U, nt);
 }
 
+TEST_F(FileSEGYWrite, FileWriteTraceBehind)
+{
+    nt = 100;
+    ns = 300;
+    wopt.behindMax = nt * SEGSz::getDOSz(ns);
+    makeMockSEGY<false>();
+    //The small writes reach the object layer as one write
+    writeTraceTest<true>(0U, nt, 7U);
+}
+
+TEST_F(FileSEGYWrite, FileWriteTraceBehindDF)
+{
+    nt = 100;
+    ns = 300;
+    wopt.behindMax = nt * SEGSz::getDOSz(ns);
+    makeMockSEGY<false>();
+    writeTraceTest<false>(10U, nt, 7U);
+}
+
+TEST_F(FileSEGYWrite, FileWriteParamBehind)
+{
+    nt = 100;
+    wopt.behindMax = nt * SEGSz::getDOSz(ns);
+    makeMockSEGY<false>();
+    EXPECT_CALL(*mock, writeHO(_)).Times(Exactly(1));
+    EXPECT_CALL(*mock, setFileSz(_)).Times(Exactly(1));
+    EXPECT_CALL(*mock, writeDOMD(5U, ns, 4U, _)).Times(Exactly(1));
+    EXPECT_CALL(*mock, writeDOMD(20U, ns, 1U, _)).Times(Exactly(1));
+
+    File::Param prm(4U);
+    for (size_t i = 0; i < prm.size(); i++)
+        (*file)->writeParam(5U + i, 1U, &prm, i);
+    //A write which does not follow on starts a new run
+    (*file)->writeParam(20U, 1U, &prm);
+    file->flush();
+}
+
 TEST_F(FileSEGYWrite, FileWriteRandomTraceNormal)
 {
     nt = 100;
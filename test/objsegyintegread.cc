@@ -111,6 +111,23 @@ TEST_F(ObjIntegTest, SEGYRandomRead)
     readRandomTest<Block::DO, false>(2000U, vec);
 }
 
+TEST_F(ObjIntegTest, SEGYRunRead)
+{
+    makeRealSEGY<false>(plargeFile);
+    //Consecutive and strided runs mixed with lone data-objects
+    std::vector<size_t> vec;
+    for (size_t i = 0; i < 50U; i++)
+        vec.push_back(i);
+    for (size_t i = 0; i < 20U; i++)
+        vec.push_back(60U + 3U*i);
+    vec.push_back(200U);
+    for (size_t i = 300U; i < 350U; i++)
+        vec.push_back(i);
+    readRandomTest<Block::DOMD, false>(2000U, vec);
+    readRandomTest<Block::DODF, false>(2000U, vec);
+    readRandomTest<Block::DO, false>(2000U, vec);
+}
+
 TEST_F(ObjIntegTest, FarmSEGYRandomBigRead)
 {
     makeRealSEGY<false>(plargeFile);
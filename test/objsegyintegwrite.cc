@@ -111,6 +111,23 @@ TEST_F(ObjIntegTest, SEGYRandomWrite)
     writeRandomTest<Block::DO, false>(2000, vec);
 }
 
+TEST_F(ObjIntegTest, SEGYRunWrite)
+{
+    makeRealSEGY<true>(tempFile);
+    //Consecutive and strided runs mixed with lone data-objects
+    std::vector<size_t> vec;
+    for (size_t i = 0; i < 50U; i++)
+        vec.push_back(i);
+    for (size_t i = 0; i < 20U; i++)
+        vec.push_back(60U + 3U*i);
+    vec.push_back(200U);
+    for (size_t i = 300U; i < 350U; i++)
+        vec.push_back(i);
+    writeRandomTest<Block::DOMD, false>(2000, vec);
+    writeRandomTest<Block::DODF, false>(2000, vec);
+    writeRandomTest<Block::DO, false>(2000, vec);
+}
+
 TEST_F(ObjIntegTest, FarmSEGYRandomBigWrite)
 {
     makeRealSEGY<true>(tempFile);
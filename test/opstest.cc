@@ -206,3 +206,148 @@ TEST_F(OpsTest, SortSrcRcvRand)
 }
 
 
+TEST_F(OpsTest, SortDistributed)
+{
+    ExSeisPIOL * epiol = piol;
+    size_t rank = epiol->comm->getRank();
+    size_t numRank = epiol->comm->getNumRank();
+    auto szall = epiol->comm->gather(std::vector<size_t>{50U + 13U*rank});
+    size_t nt = 0U, offset = 0U;
+    for (size_t i = 0; i < numRank; i++)
+    {
+        offset += (i < rank ? szall[i] : 0U);
+        nt += szall[i];
+    }
+    auto key = [] (size_t gtn) -> geom_t { return geom_t((gtn * 7919U) % 101U); };
+
+    Param prm(szall[rank]);
+    for (size_t i = 0; i < prm.size(); i++)
+    {
+        setPrm(i, Meta::xSrc, key(offset + i), &prm);
+        setPrm(i, Meta::gtn, offset + i, &prm);
+    }
+    auto comp = [] (const Param & a, const Param & b) -> bool
+    {
+        auto ka = getPrm<geom_t>(0U, Meta::xSrc, &a);
+        auto kb = getPrm<geom_t>(0U, Meta::xSrc, &b);
+        return ka < kb || (ka == kb && getPrm<size_t>(0U, Meta::gtn, &a) < getPrm<size_t>(0U, Meta::gtn, &b));
+    };
+
+    std::vector<size_t> order(nt);
+    for (size_t i = 0; i < nt; i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [key] (size_t a, size_t b) -> bool
+        { return key(a) < key(b) || (key(a) == key(b) && a < b); });
+    std::vector<size_t> pos(nt);
+    for (size_t i = 0; i < nt; i++)
+        pos[order[i]] = i;
+
+    auto list = File::sort(piol, &prm, comp, false);
+    ASSERT_EQ(prm.size(), list.size());
+    for (size_t i = 0; i < list.size(); i++)
+        ASSERT_EQ(order[offset + i], list[i]) << " i " << i;
+
+    list = File::sort(piol, &prm, comp, true);
+    ASSERT_EQ(prm.size(), list.size());
+    for (size_t i = 0; i < list.size(); i++)
+        ASSERT_EQ(pos[offset + i], list[i]) << " i " << i;
+}
+
+TEST_F(OpsTest, SortKeyTypes)
+{
+    ExSeisPIOL * epiol = piol;
+    size_t rank = epiol->comm->getRank();
+    size_t numRank = epiol->comm->getNumRank();
+    size_t nt = 1000U;
+    size_t offset = nt * rank / numRank;
+    size_t lnt = nt * (rank + 1U) / numRank - offset;
+
+    //Small ranges of negative and positive values to test the key encoding and ties
+    Param prm(nt);
+    for (size_t i = 0; i < nt; i++)
+    {
+        setPrm(i, Meta::xSrc, geom_t(llint((i * 7919U) % 7U) - 3) * 0.5, &prm);
+        setPrm(i, Meta::ySrc, geom_t(llint((i * 104729U) % 5U) - 2), &prm);
+        setPrm(i, Meta::xRcv, geom_t(llint((i * 1299709U) % 11U) - 5) * 100.0, &prm);
+        setPrm(i, Meta::yRcv, geom_t((i * 15485863U) % 3U) + 0.25, &prm);
+        setPrm(i, Meta::Offset, llint((i * 32452843U) % 13U), &prm);
+        setPrm(i, Meta::il, llint((i * 49979687U) % 4U) - 2, &prm);
+        setPrm(i, Meta::xl, llint((i * 67867967U) % 6U) - 1000, &prm);
+        setPrm(i, Meta::ltn, nt - i, &prm);
+        setPrm(i, Meta::gtn, i, &prm);
+    }
+    Param lprm(prm.r, lnt);
+    for (size_t i = 0; i < lnt; i++)
+        cpyPrm(offset + i, &prm, i, &lprm);
+
+    std::vector<Param> vprm;
+    for (size_t i = 0; i < nt; i++)
+    {
+        vprm.emplace_back(prm.r, 1U);
+        cpyPrm(i, &prm, 0U, &vprm.back());
+    }
+
+    for (int t = int(SortType::SrcRcv); t <= int(SortType::ROffLine); t++)
+    {
+        auto comp = getComp(static_cast<SortType>(t));
+        std::vector<size_t> order(nt);
+        for (size_t i = 0; i < nt; i++)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&vprm, comp] (size_t a, size_t b) -> bool
+            { return comp(vprm[a], vprm[b]); });
+
+        auto list = File::sort(piol, static_cast<SortType>(t), &lprm, false);
+        ASSERT_EQ(lnt, list.size());
+        for (size_t i = 0; i < lnt; i++)
+            ASSERT_EQ(order[offset + i], list[i]) << " type " << t << " i " << i;
+    }
+}
+
+
+TEST_F(OpsTest, ExchangeRounds)
+{
+    ExSeisPIOL * epiol = piol;
+    csize_t rank = epiol->comm->getRank();
+    csize_t numRank = epiol->comm->getNumRank();
+    csize_t w = 3U;
+    auto val = [numRank] (size_t from, size_t to, size_t j) -> size_t { return (from * numRank + to) * 1000U + j; };
+
+    std::vector<size_t> scnt(numRank);
+    std::vector<size_t> dat;
+    for (size_t i = 0; i < numRank; i++)
+    {
+        scnt[i] = 10U * (rank + 1U) + i;
+        for (size_t j = 0; j < scnt[i] * w; j++)
+            dat.push_back(val(rank, i, j));
+    }
+    auto rcnt = exchangeCount(epiol, scnt);
+
+    //A small limit splits the exchange into many rounds
+    auto one = exchange(epiol, scnt, rcnt, w, dat);
+    auto many = exchange(epiol, scnt, rcnt, w, dat, 20U);
+    EXPECT_EQ(one, many);
+
+    size_t k = 0U;
+    for (size_t i = 0; i < numRank; i++)
+        for (size_t j = 0; j < rcnt[i] * w; j++, k++)
+            ASSERT_EQ(val(i, rank, j), many[k]) << i << " " << j;
+    EXPECT_EQ(k, many.size());
+}
+
+TEST_F(OpsTest, RadixSortStable)
+{
+    //Few keys are sorted by comparison, which must keep equal keys in order too
+    for (size_t n : {100U, 1000U})
+    {
+        std::vector<SortKey<1U>> key(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            key[i].k[0] = i % 3U;
+            key[i].gtn = i;
+        }
+        radixSort(key);
+        for (size_t i = 1; i < n; i++)
+            if (key[i].k[0] == key[i-1U].k[0])
+                ASSERT_LT(key[i-1U].gtn, key[i].gtn) << n << " " << i;
+    }
+}
@@ -10,6 +10,7 @@
 #include "sglobal.hh"
 #include "fileops.hh"   //For sort
 #include "share/misc.hh"
+#include "file/ioplan.hh"
 namespace PIOL { namespace FOURD {
 //TODO: Integration candidate
 //TODO: Simple IME optimisation: Contig Read all headers, sort, random write all headers to order, IME shuffle, contig read all headers again
@@ -32,25 +33,19 @@ std::unique_ptr<Coords> getCoords(Piol piol, std::string name)
     size_t max = memlim / (rule->paramMem() + SEGSz::getMDSz());
 
     //Collective I/O requries an equal number of MPI-IO calls on every process in exactly the same sequence as each other.
-    //If not, the code will deadlock. Communication is done to ensure we balance out the correct number of redundant calls
-    size_t biggest = piol->comm->max(lnt);
-    size_t extra = biggest/max - lnt/max + (biggest % max > 0) - (lnt % max > 0);
+    //If not, the code will deadlock. The plan agrees on the number of rounds so every process makes the same calls.
+    File::IOPlan plan(piol.get(), lnt, max);
+    //WARNING: Treat ReadDirect like the internal API for using a non-exposed function
+    plan.add(file.operator->(), SEGSz::getMDSz());
 
     File::Param prm(rule, lnt);
-    for (size_t i = 0; i < lnt; i += max)
-    {
-        size_t rblock = (i + max < lnt ? max : lnt - i);
-
-        //WARNING: Treat ReadDirect like the internal API for using a non-exposed function
-        file->readParam(offset+i, rblock, &prm, i);
-
-        for (size_t j = 0; j < rblock; j++)
-            setPrm(i + j, Meta::gtn, offset + i + j, &prm);
-    }
+    plan.run([&] (size_t i, size_t rblock)
+        {
+            file->readParam(offset+i, rblock, &prm, i);
 
-    //Any extra readParam calls the particular process needs
-    for (size_t i = 0; i < extra; i++)
-        file.readParam(size_t(0), size_t(0), nullptr);
+            for (size_t j = 0; j < rblock; j++)
+                setPrm(i + j, Meta::gtn, offset + i + j, &prm);
+        });
     cmsg(piol.get(), "getCoords sort");
 
     auto trlist = File::sort(piol.get(), &prm, [] (const File::Param & e1, const File::Param & e2) -> bool
@@ -65,17 +60,23 @@ std::unique_ptr<Coords> getCoords(Piol piol, std::string name)
 /////////////////////////////////////////////////////////////////////////////
 
     //This makes a rule about what data we will access. In this particular case it's xsrc, ysrc, xrcv, yrcv.
-    //Unfortunately shared pointers make things ugly in C++.
+    //The layout is fixed so a compile-time rule set is used, which decodes each entry straight into its own column.
     //TODO: use option to make il/xl optional
-    auto crule = std::make_shared<File::Rule>(std::initializer_list<Meta>{Meta::xSrc, Meta::ySrc, Meta::xRcv, Meta::yRcv, Meta::il, Meta::xl});
-    max = memlim / (crule->paramMem() + SEGSz::getMDSz() + 2U*sizeof(size_t));
+    typedef File::StaticRule<Meta::xSrc, Meta::ySrc, Meta::xRcv, Meta::yRcv, Meta::il, Meta::xl> CoordRule;
+    max = memlim / (CoordRule::paramMem() + SEGSz::getMDSz() + 2U*sizeof(size_t));
 
     {
-    File::Param prm2(crule, std::min(lnt, max));
-    for (size_t i = 0; i < lnt; i += max)
+    File::StaticParam<CoordRule> prm2(std::min(lnt, max));
+    const geom_t * xSrc = prm2.get<Meta::xSrc>();
+    const geom_t * ySrc = prm2.get<Meta::ySrc>();
+    const geom_t * xRcv = prm2.get<Meta::xRcv>();
+    const geom_t * yRcv = prm2.get<Meta::yRcv>();
+    const llint * il = prm2.get<Meta::il>();
+    const llint * xl = prm2.get<Meta::xl>();
+    File::IOPlan cplan(piol.get(), lnt, max);
+    cplan.add(file.operator->(), SEGSz::getMDSz());
+    cplan.run([&] (size_t i, size_t rblock)
     {
-        size_t rblock = (i + max < lnt ? max : lnt - i);
-
         auto sortlist = getSortIndex(rblock, trlist.data() + i);
         auto orig = sortlist;
         for (size_t j = 0; j < sortlist.size(); j++)
@@ -85,21 +86,17 @@ std::unique_ptr<Coords> getCoords(Piol piol, std::string name)
 
         for (size_t j = 0; j < rblock; j++)
         {
-            coords->xSrc[i+orig[j]] = File::getPrm<geom_t>(j, Meta::xSrc, &prm2);
-            coords->ySrc[i+orig[j]] = File::getPrm<geom_t>(j, Meta::ySrc, &prm2);
-            coords->xRcv[i+orig[j]] = File::getPrm<geom_t>(j, Meta::xRcv, &prm2);
-            coords->yRcv[i+orig[j]] = File::getPrm<geom_t>(j, Meta::yRcv, &prm2);
-            coords->il[i+orig[j]] = File::getPrm<llint>(j, Meta::il, &prm2);
-            coords->xl[i+orig[j]] = File::getPrm<llint>(j, Meta::xl, &prm2);
+            coords->xSrc[i+orig[j]] = xSrc[j];
+            coords->ySrc[i+orig[j]] = ySrc[j];
+            coords->xRcv[i+orig[j]] = xRcv[j];
+            coords->yRcv[i+orig[j]] = yRcv[j];
+            coords->il[i+orig[j]] = il[j];
+            coords->xl[i+orig[j]] = xl[j];
             coords->tn[i+orig[j]] = trlist[i+orig[j]];
         }
-    }
+    });
     }
 
-    //Any extra readParam calls the particular process needs
-    for (size_t i = 0; i < extra; i++)
-        file.readParam(0U, nullptr, nullptr);
-
     piol->comm->barrier();  //This barrier is necessary so that cmsg doesn't store an old MPI_Wtime().
     cmsg(piol.get(), "Read sets of coordinates from file " + name + " in " + std::to_string(MPI_Wtime()- time) + " seconds");
 
@@ -126,7 +123,6 @@ void outputNonMono(Piol piol, std::string dname, std::string sname, vec<size_t>
     size_t ns = src.readNs();
     size_t lnt = list.size();
     size_t offset = 0;
-    size_t biggest = 0;
     size_t sz = 0;
     {
         auto nts = piol->comm->gather(vec<size_t>{lnt});
@@ -135,7 +131,6 @@ void outputNonMono(Piol piol, std::string dname, std::string sname, vec<size_t>
             if (i == piol->comm->getRank())
                 offset = sz;
             sz += nts[i];
-            biggest = std::max(biggest, nts[i]);
         }
     }
 
@@ -143,7 +138,6 @@ void outputNonMono(Piol piol, std::string dname, std::string sname, vec<size_t>
     size_t memlim = 2U*1024U*1024U*1024U;
     assert(memlim > memused);
     size_t max = (memlim - memused) / (4U*SEGSz::getDOSz(ns) + 4U*rule->extent());
-    size_t extra = biggest/max - lnt/max + (biggest % max > 0) - (lnt % max > 0);
 
     dst.writeText("ExSeisDat 4d-bin file.\n");
     dst.writeNt(sz);
@@ -153,21 +147,17 @@ void outputNonMono(Piol piol, std::string dname, std::string sname, vec<size_t>
     File::Param prm(rule, std::min(lnt, max));
     vec<trace_t> trc(ns * std::min(lnt, max));
 
-    for (size_t i = 0; i < lnt; i += max)
-    {
-        size_t rblock = (i + max < lnt ? max : lnt - i);
-        src.readTraceNonMono(rblock, &list[i], trc.data(), &prm);
-        if (printDsr)
-            for (size_t j = 0; j < rblock; j++)
-                setPrm(j, Meta::dsdr, minrs[i+j], &prm);
-        dst.writeTrace(offset+i, rblock, trc.data(), &prm);
-    }
-
-    for (size_t i = 0; i < extra; i++)
-    {
-        src.readTrace(0, nullptr, nullptr, nullptr);
-        dst.writeTrace(size_t(0), size_t(0), nullptr, nullptr);
-    }
+    File::IOPlan plan(piol.get(), lnt, max);
+    plan.add(src.operator->(), SEGSz::getDOSz(ns));
+    plan.add(dst.operator->(), SEGSz::getDOSz(ns));
+    plan.run([&] (size_t i, size_t rblock)
+        {
+            src.readTraceNonMono(rblock, list.data() + i, trc.data(), &prm);
+            if (printDsr)
+                for (size_t j = 0; j < rblock; j++)
+                    setPrm(j, Meta::dsdr, minrs[i+j], &prm);
+            dst.writeTrace(offset+i, rblock, trc.data(), &prm);
+        });
 
     piol->comm->barrier();
     cmsg(piol.get(), "Output " + sname + " to " + dname + " in " + std::to_string(MPI_Wtime()- time) + " seconds");
@@ -147,6 +147,13 @@ void mpiMakeSEGYCopy(ExSeis piol, Interface * in, Interface * out, size_t repRat
         std::vector<uchar> buf(dec.second);
         in->read(i+dec.first, dec.second, buf.data());
         piol.isErr();
+
+        //Read the next step while this one is written
+        if (i + step < fsz)
+        {
+            auto next = blockDecomp((i + 2U*step < fsz ? step : fsz - i - step), bsz, numRank, rank, i + step);
+            in->prefetch(i + step + next.first, next.second);
+        }
         out->write(i+dec.first, dec.second, buf.data());
         piol.isErr();
         if (i == 0)
@@ -186,6 +193,13 @@ void mpiMakeSEGYCopyNaive(ExSeis piol, Interface * in, Interface * out, size_t r
 
         std::vector<uchar> buf(dec.second);
         in->read(i + dec.first, dec.second, buf.data());
+        if (i + step < fsz)
+        {
+            size_t nblock = (i + 2U*step < fsz ? step : fsz - i - step);
+            auto next = (Block ? decompose(nblock, numRank, piol.getRank())
+                               : blockDecomp(nblock, bsz, numRank, piol.getRank(), i + step));
+            in->prefetch(i + step + next.first, next.second);
+        }
         out->write(i + dec.first, dec.second, buf.data());
         if (i == 0)
         {
@@ -253,7 +267,10 @@ int main(int argc, char ** argv)
 
     size_t numRank = piol.getNumRank();
 
-    MPIIO in(piol, iname, FileMode::Read);
+    //One step is read ahead at a time, the step being written is already a copy.
+    MPIIO::Opt iopt;
+    iopt.ahead = 1U;
+    MPIIO in(piol, iname, iopt, FileMode::Read);
     MPIIO out(piol, oname, FileMode::Write);
     piol.isErr();
 
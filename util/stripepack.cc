@@ -0,0 +1,112 @@
+/*******************************************************************************************//*!
+ *   \file
+ *   \author Cathal O Broin - cathal@ichec.ie - first commit
+ *   \date March 2017
+ *   \brief
+ *   \details Pack a striped file back into a single file, or stripe a single file.
+ *//*******************************************************************************************/
+#include <unistd.h> //getopt
+#include <iostream>
+#include "sglobal.hh"
+#include "cppfileapi.hh"
+#include "data/datampiio.hh"
+#include "data/datastripe.hh"
+using namespace PIOL;
+
+/*! Copy every byte of one file to another. The bytes are split evenly between the processes.
+ *  \param[in] piol The PIOL object
+ *  \param[in] in The input file
+ *  \param[out] out The output file
+ *  \param[in] memlim The most bytes a process holds at a time
+ */
+void copyBytes(ExSeis & piol, Data::Interface * in, Data::Interface * out, size_t memlim)
+{
+    csize_t fsz = in->getFileSz();
+    out->setFileSz(fsz);
+    piol.isErr();
+
+    auto dec = decompose(fsz, piol.getNumRank(), piol.getRank());
+    //Every process makes the same number of calls so collective MPI-IO can be used.
+    size_t rounds = piol.max((dec.second + memlim - 1U) / memlim);
+    std::vector<uchar> buf(std::min(dec.second, memlim));
+    for (size_t i = 0; i < rounds; i++)
+    {
+        csize_t off = std::min(i * memlim, dec.second);
+        csize_t sz = std::min(memlim, dec.second - off);
+        in->read(dec.first + off, sz, buf.data());
+        out->write(dec.first + off, sz, buf.data());
+        piol.isErr();
+    }
+}
+
+/*! Main function for stripepack.
+ *  \param[in] argc The number of input strings.
+ *  \param[in] argv The array of input strings.
+ *  \return zero on success, non-zero on failure
+ *  \details Command line options:
+ *           -i \<inp\> : input file. If it is striped it is packed into a single output file.
+ *           -o \<out\> : output file
+ *           -n \<num\> : stripe the input file over this many parts instead
+ *           -u \<unit\> : the stripe unit in bytes (default 4MiB)
+ *           -m \<mem\> : the most memory in MiB used by each process (default 1024)
+ */
+int main(int argc, char ** argv)
+{
+    std::string iname = "";
+    std::string oname = "";
+    Data::Stripe::Opt sopt;
+    size_t nparts = 0U;
+    size_t memlim = 1024U;
+    std::string opt = "i:o:n:u:m:";  //TODO: uses a GNU extension
+    for (int c = getopt(argc, argv, opt.c_str()); c != -1; c = getopt(argc, argv, opt.c_str()))
+        switch (c)
+        {
+            case 'i' :
+                iname = optarg;
+            break;
+            case 'o' :
+                oname = optarg;
+            break;
+            case 'n' :
+                nparts = std::stoul(optarg);
+            break;
+            case 'u' :
+                sopt.unit = std::stoul(optarg);
+            break;
+            case 'm' :
+                memlim = std::stoul(optarg);
+            break;
+            default :
+                std::cerr << "One of the command line arguments is invalid\n";
+            break;
+        }
+    if (iname == "" || oname == "" || !memlim)
+    {
+        std::cerr << "Usage: stripepack -i <input> -o <output> [-n <parts> -u <unit>] [-m <MiB>]\n";
+        return -1;
+    }
+
+    ExSeis piol;
+    const Data::MPIIO::Opt dopt;
+    std::unique_ptr<Data::Interface> in, out;
+    if (nparts)
+    {
+        sopt.nparts = nparts;
+        in = std::make_unique<Data::MPIIO>(piol, iname, dopt, FileMode::Read);
+        out = std::make_unique<Data::Stripe>(piol, oname, sopt, FileMode::Write);
+    }
+    else
+    {
+        if (!Data::Stripe::isStriped(piol, iname))
+        {
+            std::cerr << "The input file " << iname << " has no stripe manifest\n";
+            return -1;
+        }
+        in = std::make_unique<Data::Stripe>(piol, iname, sopt, FileMode::Read);
+        out = std::make_unique<Data::MPIIO>(piol, oname, dopt, FileMode::Write);
+    }
+    piol.isErr();
+
+    copyBytes(piol, in.get(), out.get(), memlim * 1024U * 1024U);
+    return 0;
+}
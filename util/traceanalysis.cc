@@ -8,6 +8,9 @@
 #include <unistd.h> //getopt
 #include <iostream>
 #include "cppfileapi.hh"
+#include "data/datammap.hh"
+#include "object/objsegy.hh"
+#include "file/filesegy.hh"
 using namespace PIOL;
 
 /*! Main function for traceanalysis.
@@ -37,13 +40,16 @@ int main(int argc, char ** argv)
                 std::cerr<< "One of the command line arguments is invalid\n";
             break;
         }
-    File::ReadDirect file(piol, name);
-
-    File::Param prm(1U);
-    file->readParam(tn, 1U, &prm);
+    //A single trace is read by one process so it is copied out of a mapping of the file.
+    Data::MMap::Opt dopt;
+    dopt.advice = Data::Advice::Random;
+    File::ReadDirect file(piol, name, File::ReadSEGY::Opt(), Obj::SEGY::Opt(), dopt);
 
     if (!piol.getRank())
     {
+        File::Param prm(1U);
+        file->readParam(tn, 1U, &prm);
+
         std::cout << "xSrc " << File::getPrm<geom_t>(0U, Meta::xSrc, &prm) << std::endl;
         std::cout << "ySrc " << File::getPrm<geom_t>(0U, Meta::ySrc, &prm) << std::endl;
         std::cout << "xRcv " << File::getPrm<geom_t>(0U, Meta::xRcv, &prm) << std::endl;